@@ -0,0 +1,127 @@
+#include "Arena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+using namespace std;
+
+static size_t alignOffset(const char* base, size_t offset, size_t alignment)
+{
+    uintptr_t address = (uintptr_t)(base + offset);
+    uintptr_t aligned = (address + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    return offset + (size_t)(aligned - address);
+}
+
+LinearArena::LinearArena(size_t arenaBlockSize)
+    : blockSize(arenaBlockSize), current(-1), offset(0), highWaterBytes(0)
+{
+}
+
+LinearArena::~LinearArena()
+{
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        ::operator delete(blocks[i].data);
+    }
+}
+
+void* LinearArena::allocate(size_t size, size_t alignment)
+{
+    size_t start = 0;
+    if (current >= 0) {
+        start = alignOffset(blocks[current].data, offset, alignment);
+    }
+    if (current < 0 || start + size > blocks[current].size) {
+        if (!nextBlock(size, alignment)) {
+            return nullptr;
+        }
+        start = alignOffset(blocks[current].data, 0, alignment);
+    }
+    offset = start + size;
+    highWaterBytes = max(highWaterBytes, used());
+    return blocks[current].data + start;
+}
+
+// Prelazi na sledeci blok (posle rewind-a moze vec da postoji) ili dodaje novi iza trenutnog
+bool LinearArena::nextBlock(size_t size, size_t alignment)
+{
+    size_t needed = size + alignment;
+    int next = current + 1;
+    if (next < (int)blocks.size() && blocks[next].size >= needed) {
+        current = next;
+        offset = 0;
+        return true;
+    }
+    Block block = { static_cast<char*>(::operator new(max(blockSize, needed), nothrow)), max(blockSize, needed) };
+    if (block.data == nullptr) {
+        return false;
+    }
+    if (next < (int)blocks.size()) {
+        // Blokovi iza trenutnog nisu u upotrebi, pa se premali zamenjuje vecim
+        ::operator delete(blocks[next].data);
+        blocks[next] = block;
+    }
+    else {
+        blocks.push_back(block);
+    }
+    current = next;
+    offset = 0;
+    return true;
+}
+
+LinearArena::Marker LinearArena::mark() const
+{
+    Marker marker = { current, offset };
+    return marker;
+}
+
+void LinearArena::rewind(const Marker& marker)
+{
+    current = marker.block;
+    offset = marker.offset;
+}
+
+void LinearArena::reset()
+{
+    // Vise blokova znaci da je prethodna upotreba prerasla prvi - spajaju se u jedan za sledeci put
+    if (blocks.size() > 1) {
+        size_t total = capacity();
+        for (size_t i = 0; i < blocks.size(); ++i) {
+            ::operator delete(blocks[i].data);
+        }
+        blocks.clear();
+        Block block = { static_cast<char*>(::operator new(total, nothrow)), total };
+        if (block.data != nullptr) {
+            blocks.push_back(block);
+        }
+    }
+    current = blocks.empty() ? -1 : 0;
+    offset = 0;
+}
+
+void LinearArena::release()
+{
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        ::operator delete(blocks[i].data);
+    }
+    blocks.clear();
+    current = -1;
+    offset = 0;
+}
+
+size_t LinearArena::used() const
+{
+    size_t bytes = offset;
+    for (int i = 0; i < current; ++i) {
+        bytes += blocks[i].size;
+    }
+    return bytes;
+}
+
+size_t LinearArena::capacity() const
+{
+    size_t bytes = 0;
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        bytes += blocks[i].size;
+    }
+    return bytes;
+}
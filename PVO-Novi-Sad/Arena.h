@@ -0,0 +1,167 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Linearni alokator za privremene podatke: alokacija samo pomera pokazivac, a sve se oslobadja odjednom
+// (reset) ili do zapamcene tacke (rewind). Destruktori se ne pozivaju - objekti sa destruktorom idu kroz
+// ArenaFunction ili ih vlasnik sam unistava. Kad blok ne moze da primi alokaciju dodaje se novi, a reset()
+// ih spaja u jedan dovoljno veliki, pa posle nekoliko frejmova arena vise ne ide na heap.
+// Nije bezbedna za vise niti: frejm arenu puni igra, a render nit samo cita predat graf.
+class LinearArena
+{
+public:
+    struct Marker {
+        int block;
+        size_t offset;
+    };
+
+    explicit LinearArena(size_t blockSize = 64 * 1024);
+    ~LinearArena();
+
+    LinearArena(const LinearArena&) = delete;
+    LinearArena& operator=(const LinearArena&) = delete;
+
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    // Neinicijalizovan niz (samo za tipove bez konstruktora/destruktora: vec4, float, char...)
+    template<typename T>
+    T* allocateArray(size_t count)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "LinearArena ne poziva destruktore");
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    template<typename T, typename... Args>
+    T* create(Args&&... args)
+    {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    Marker mark() const;
+    void rewind(const Marker& marker);
+    void reset();
+    // Vraca svu memoriju (npr. arena ucitavanja kad se ucitavanje zavrsi); highWater ostaje
+    void release();
+
+    size_t used() const;
+    size_t highWater() const { return highWaterBytes; }
+    size_t capacity() const;
+
+private:
+    struct Block {
+        char* data;
+        size_t size;
+    };
+
+    bool nextBlock(size_t size, size_t alignment);
+
+    std::vector<Block> blocks;
+    size_t blockSize;
+    int current;
+    size_t offset;
+    size_t highWaterBytes;
+};
+
+// Privremena memorija jednog posla (upload, parsiranje): sve sto je alocirano u opsegu se oslobadja na izlazu
+class ArenaScope
+{
+public:
+    explicit ArenaScope(LinearArena& scopeArena) : arena(scopeArena), marker(scopeArena.mark()) {}
+    ~ArenaScope() { arena.rewind(marker); }
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+    template<typename T>
+    T* allocateArray(size_t count) { return arena.allocateArray<T>(count); }
+
+private:
+    LinearArena& arena;
+    LinearArena::Marker marker;
+};
+
+// Niz u areni (instance, ciljne pozicije...) - kopira se po vrednosti u komande frejma
+template<typename T>
+struct ArenaArray {
+    T* data;
+    int count;
+
+    ArenaArray() : data(nullptr), count(0) {}
+    ArenaArray(T* arrayData, int arrayCount) : data(arrayData), count(arrayCount) {}
+    bool empty() const { return count == 0; }
+};
+
+template<typename T>
+ArenaArray<T> copyToArena(LinearArena& arena, const std::vector<T>& values)
+{
+    if (values.empty()) {
+        return ArenaArray<T>();
+    }
+    T* data = arena.allocateArray<T>(values.size());
+    std::copy(values.begin(), values.end(), data);
+    return ArenaArray<T>(data, (int)values.size());
+}
+
+// Pozivna funkcija ciji se objekat (lambda sa zahvacenim vrednostima) cuva u areni umesto na heap-u kao
+// kod std::function. Destruktor objekta se poziva, ali memoriju oslobadja tek reset arene.
+template<typename R>
+class ArenaFunction
+{
+public:
+    ArenaFunction() : object(nullptr), invoker(nullptr), destroyer(nullptr) {}
+
+    template<typename F>
+    ArenaFunction(LinearArena& arena, F&& function)
+    {
+        typedef typename std::decay<F>::type Callable;
+        object = arena.create<Callable>(std::forward<F>(function));
+        invoker = [](void* callable) -> R { return (*static_cast<Callable*>(callable))(); };
+        destroyer = [](void* callable) { static_cast<Callable*>(callable)->~Callable(); };
+    }
+
+    ArenaFunction(ArenaFunction&& other) : object(other.object), invoker(other.invoker), destroyer(other.destroyer)
+    {
+        other.object = nullptr;
+        other.invoker = nullptr;
+        other.destroyer = nullptr;
+    }
+
+    ArenaFunction& operator=(ArenaFunction&& other)
+    {
+        if (this != &other) {
+            reset();
+            std::swap(object, other.object);
+            std::swap(invoker, other.invoker);
+            std::swap(destroyer, other.destroyer);
+        }
+        return *this;
+    }
+
+    ArenaFunction(const ArenaFunction&) = delete;
+    ArenaFunction& operator=(const ArenaFunction&) = delete;
+
+    ~ArenaFunction() { reset(); }
+
+    void reset()
+    {
+        if (destroyer) {
+            destroyer(object);
+        }
+        object = nullptr;
+        invoker = nullptr;
+        destroyer = nullptr;
+    }
+
+    explicit operator bool() const { return invoker != nullptr; }
+    R operator()() const { return invoker(object); }
+
+private:
+    void* object;
+    R (*invoker)(void*);
+    void (*destroyer)(void*);
+};
@@ -0,0 +1,106 @@
+#include "AssetLoader.h"
+
+#include <chrono>
+
+using namespace std;
+
+AssetLoader::AssetLoader(unsigned int threadCount)
+    : pendingCount(0), stopping(false)
+{
+    if (threadCount == 0) {
+        // Jedno jezgro ostavljamo glavnoj niti (igra), a jedno render niti
+        unsigned int cores = thread::hardware_concurrency();
+        threadCount = cores > 2 ? cores - 2 : 1;
+    }
+
+    for (unsigned int i = 0; i < threadCount; ++i) {
+        workers.emplace_back(&AssetLoader::workerLoop, this);
+    }
+}
+
+AssetLoader::~AssetLoader()
+{
+    {
+        // Poslovi koji jos nisu poceli se odbacuju - nema svrhe ucitavati modele pri izlasku
+        lock_guard<mutex> lock(jobMutex);
+        stopping = true;
+        queue<function<void()>>().swap(jobs);
+    }
+    jobCondition.notify_all();
+
+    for (thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void AssetLoader::submit(function<void()> job)
+{
+    pendingCount++;
+    {
+        lock_guard<mutex> lock(jobMutex);
+        jobs.push(move(job));
+    }
+    jobCondition.notify_one();
+}
+
+void AssetLoader::queueUpload(function<void()> upload)
+{
+    pendingCount++;
+    lock_guard<mutex> lock(uploadMutex);
+    uploads.push(move(upload));
+}
+
+void AssetLoader::processUploads(double budgetMs)
+{
+    auto start = chrono::high_resolution_clock::now();
+
+    while (true) {
+        function<void()> upload;
+        {
+            lock_guard<mutex> lock(uploadMutex);
+            if (uploads.empty()) {
+                return;
+            }
+            upload = move(uploads.front());
+            uploads.pop();
+        }
+
+        upload();
+        if (--pendingCount == 0) {
+            // Sve je ucitano - privremena memorija upload-a vise nije potrebna
+            uploadScratch.release();
+        }
+
+        double elapsedMs = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+        if (elapsedMs >= budgetMs) {
+            return;
+        }
+    }
+}
+
+void AssetLoader::finishAll()
+{
+    while (!isIdle()) {
+        processUploads(1000.0);
+        this_thread::yield();
+    }
+}
+
+void AssetLoader::workerLoop()
+{
+    while (true) {
+        function<void()> job;
+        {
+            unique_lock<mutex> lock(jobMutex);
+            jobCondition.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (stopping && jobs.empty()) {
+                return;
+            }
+            job = move(jobs.front());
+            jobs.pop();
+        }
+
+        job();
+        pendingCount--;
+    }
+}
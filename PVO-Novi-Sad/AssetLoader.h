@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "Arena.h"
+
+// Asinhrono ucitavanje resursa.
+// Parsiranje modela (ObjParser, a Assimp kao rezerva) i dekodiranje slika (stb_image) rade se na radnim nitima,
+// dok se GL pozivi redjaju u red i izvrsavaju na render niti (jedina nit sa GL kontekstom).
+class AssetLoader
+{
+public:
+    explicit AssetLoader(unsigned int threadCount = 0);
+    ~AssetLoader();
+
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+
+    // Posao za radnu nit (bez GL poziva!)
+    void submit(std::function<void()> job);
+
+    // Posao za render nit - moze se pozvati sa bilo koje niti
+    void queueUpload(std::function<void()> upload);
+
+    // Poziva se sa render niti jednom po frejmu. Izvrsava upload-e dok ne potrosi budzet (u ms),
+    // a bar jedan upload se uvek izvrsi da ucitavanje ne bi stalo.
+    void processUploads(double budgetMs);
+
+    // Blokira dok svi poslovi i upload-i ne budu zavrseni (upload-i se izvrsavaju na pozivajucoj niti)
+    void finishAll();
+
+    int workerCount() const { return (int)workers.size(); }
+    bool isIdle() const { return pendingCount.load() == 0; }
+    int pending() const { return pendingCount.load(); }
+
+    // Privremena memorija upload-a (samo na render niti, unutar ArenaScope-a jednog upload-a)
+    LinearArena& uploadArena() { return uploadScratch; }
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> jobs;
+    std::queue<std::function<void()>> uploads;
+    std::mutex jobMutex;
+    std::mutex uploadMutex;
+    std::condition_variable jobCondition;
+    std::atomic<int> pendingCount;
+    bool stopping;
+    LinearArena uploadScratch;
+};
@@ -0,0 +1,249 @@
+#include "CloudLayer.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace std;
+using namespace glm;
+
+// Sloj neba iznad mape (u jedinicama sveta)
+static const float SKY_EXTENT = 3.0f;
+static const float SKY_MIN_HEIGHT = 0.6f;
+static const float SKY_MAX_HEIGHT = 0.9f;
+static const int PUFFS_PER_CLOUD = 8;
+
+static int cloudCountFor(CloudLayer::Quality quality)
+{
+    switch (quality) {
+    case CloudLayer::QUALITY_LOW: return 200;
+    case CloudLayer::QUALITY_HIGH: return 800;
+    default: return 400;
+    }
+}
+
+static int resolutionDivisorFor(CloudLayer::Quality quality)
+{
+    switch (quality) {
+    case CloudLayer::QUALITY_LOW: return 4;
+    case CloudLayer::QUALITY_HIGH: return 1;
+    default: return 2;
+    }
+}
+
+CloudLayer::CloudLayer()
+    : particleProgram(0), compositeProgram(0), quality(QUALITY_MEDIUM), width(0), height(0), targetWidth(0), targetHeight(0),
+      depthTexture(0), depthFbo(0), cloudTexture(0), cloudFbo(0), quadVAO(0), quadVBO(0), instanceVBO(0), emptyVAO(0),
+      instancesDirty(true), sortedFrom(0.0f)
+{
+}
+
+void CloudLayer::init(GLuint particleShader, GLuint compositeShader, int framebufferWidth, int framebufferHeight, Quality initialQuality)
+{
+    particleProgram = particleShader;
+    compositeProgram = compositeShader;
+    width = framebufferWidth;
+    height = framebufferHeight;
+    quality = initialQuality;
+
+    // Pravougaonik cestice (dva trougla) + instance
+    const float corners[] = { -1.0f, -1.0f,  1.0f, -1.0f,  1.0f, 1.0f,  -1.0f, -1.0f,  1.0f, 1.0f,  -1.0f, 1.0f };
+    glGenVertexArrays(1, &quadVAO);
+    glGenBuffers(1, &quadVBO);
+    glGenBuffers(1, &instanceVBO);
+    glBindVertexArray(quadVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Particle), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Particle), (void*)sizeof(vec4));
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+
+    // Prolaz preko celog ekrana pravi temena u shaderu (gl_VertexID), ali core profil trazi neki VAO
+    glGenVertexArrays(1, &emptyVAO);
+
+    glGenTextures(1, &depthTexture);
+    glBindTexture(GL_TEXTURE_2D, depthTexture);
+    // Isti format kao podrazumevani framebuffer (GLFW: 24 bita dubine + 8 bita stencil-a), inace blit ne radi
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, width, height, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, &depthFbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, depthFbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    createTargets();
+    generateParticles();
+}
+
+void CloudLayer::setQuality(Quality newQuality)
+{
+    if (newQuality == quality || particleProgram == 0) {
+        return;
+    }
+    quality = newQuality;
+    createTargets();
+    generateParticles();
+}
+
+void CloudLayer::createTargets()
+{
+    if (cloudFbo != 0) {
+        glDeleteFramebuffers(1, &cloudFbo);
+        glDeleteTextures(1, &cloudTexture);
+    }
+
+    int divisor = resolutionDivisorFor(quality);
+    targetWidth = std::max(width / divisor, 1);
+    targetHeight = std::max(height / divisor, 1);
+
+    glGenTextures(1, &cloudTexture);
+    glBindTexture(GL_TEXTURE_2D, cloudTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, targetWidth, targetHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, &cloudFbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, cloudFbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, cloudTexture, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void CloudLayer::generateParticles()
+{
+    // Fiksno seme - isti raspored oblaka pri svakom pokretanju
+    mt19937 random(1234u);
+    uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    int cloudCount = cloudCountFor(quality);
+    particles.clear();
+    particles.reserve(cloudCount * PUFFS_PER_CLOUD);
+    for (int c = 0; c < cloudCount; ++c) {
+        vec3 center((unit(random) * 2.0f - 1.0f) * SKY_EXTENT,
+                    SKY_MIN_HEIGHT + unit(random) * (SKY_MAX_HEIGHT - SKY_MIN_HEIGHT),
+                    (unit(random) * 2.0f - 1.0f) * SKY_EXTENT);
+        float cloudSize = 0.08f + unit(random) * 0.12f;
+        for (int p = 0; p < PUFFS_PER_CLOUD; ++p) {
+            // Oblak je spljosten elipsoid: cestice su sire po X/Z nego po visini
+            vec3 offset((unit(random) * 2.0f - 1.0f) * cloudSize,
+                        (unit(random) * 2.0f - 1.0f) * cloudSize * 0.3f,
+                        (unit(random) * 2.0f - 1.0f) * cloudSize);
+            Particle particle;
+            particle.centerSize = vec4(center + offset, cloudSize * (0.5f + unit(random) * 0.4f));
+            // Gornje cestice su svetlije (mesecina odozgo)
+            float brightness = 0.75f + 0.25f * (offset.y / (cloudSize * 0.3f));
+            particle.shade = vec4(brightness, 0.35f + unit(random) * 0.25f, unit(random) * 100.0f, 0.0f);
+            particles.push_back(particle);
+        }
+    }
+    instancesDirty = true;
+}
+
+void CloudLayer::sortParticles(const vec3& cameraPosition)
+{
+    // Mesanje "preko" trazi redosled od daljih ka blizim; kamera je uglavnom mirna pa se sortira samo kad se pomeri
+    sort(particles.begin(), particles.end(), [&cameraPosition](const Particle& a, const Particle& b) {
+        vec3 da = vec3(a.centerSize) - cameraPosition;
+        vec3 db = vec3(b.centerSize) - cameraPosition;
+        return dot(da, da) > dot(db, db);
+    });
+    sortedFrom = cameraPosition;
+    instancesDirty = true;
+}
+
+void CloudLayer::render(const mat4& view, const mat4& projection, const vec3& cameraPosition, float nearPlane, float farPlane)
+{
+    if (particleProgram == 0 || particles.empty()) {
+        return;
+    }
+
+    if (instancesDirty || cameraPosition != sortedFrom) {
+        sortParticles(cameraPosition);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        glBufferData(GL_ARRAY_BUFFER, particles.size() * sizeof(Particle), particles.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        instancesDirty = false;
+    }
+
+    GLint previousViewport[4];
+    glGetIntegerv(GL_VIEWPORT, previousViewport);
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    GLboolean cullFace = glIsEnabled(GL_CULL_FACE);
+    GLboolean blend = glIsEnabled(GL_BLEND);
+
+    // Kopija dubine scene za meke cestice
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, depthFbo);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+    // Cestice u manji cilj, sa premnozenom alfom (redosled spajanja: "preko")
+    glBindFramebuffer(GL_FRAMEBUFFER, cloudFbo);
+    glViewport(0, 0, targetWidth, targetHeight);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_CULL_FACE);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    glUseProgram(particleProgram);
+    glUniformMatrix4fv(glGetUniformLocation(particleProgram, "uV"), 1, GL_FALSE, value_ptr(view));
+    glUniformMatrix4fv(glGetUniformLocation(particleProgram, "uP"), 1, GL_FALSE, value_ptr(projection));
+    glUniform2f(glGetUniformLocation(particleProgram, "uTargetSize"), (float)targetWidth, (float)targetHeight);
+    glUniform1f(glGetUniformLocation(particleProgram, "uNear"), nearPlane);
+    glUniform1f(glGetUniformLocation(particleProgram, "uFar"), farPlane);
+    glUniform1i(glGetUniformLocation(particleProgram, "uSceneDepth"), 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, depthTexture);
+    glBindVertexArray(quadVAO);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, (GLsizei)particles.size());
+
+    // Spajanje sa scenom u punoj rezoluciji (bilinearno uvecanje)
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+    glUseProgram(compositeProgram);
+    glUniform1i(glGetUniformLocation(compositeProgram, "uClouds"), 0);
+    glBindTexture(GL_TEXTURE_2D, cloudTexture);
+    glBindVertexArray(emptyVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    if (!blend) glDisable(GL_BLEND);
+    if (depthTest) glEnable(GL_DEPTH_TEST);
+    if (cullFace) glEnable(GL_CULL_FACE);
+}
+
+void CloudLayer::release()
+{
+    if (quadVAO != 0) {
+        glDeleteVertexArrays(1, &quadVAO);
+        glDeleteVertexArrays(1, &emptyVAO);
+        glDeleteBuffers(1, &quadVBO);
+        glDeleteBuffers(1, &instanceVBO);
+        glDeleteFramebuffers(1, &depthFbo);
+        glDeleteFramebuffers(1, &cloudFbo);
+        glDeleteTextures(1, &depthTexture);
+        glDeleteTextures(1, &cloudTexture);
+        quadVAO = emptyVAO = quadVBO = instanceVBO = depthFbo = cloudFbo = depthTexture = cloudTexture = 0;
+    }
+    particleProgram = 0;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// Sloj oblaka od instanciranih "mekih" cestica (soft particles) umesto Cloud.obj mreze.
+// Svaki oblak je grupa cestica (puffs) u sloju neba iznad mape. Cestice se crtaju u manji offscreen cilj
+// (kvalitet odredjuje rezoluciju i broj oblaka), pa se rezultat jednim prolazom preko celog ekrana
+// mesa sa scenom - cena popunjavanja je ogranicena velicinom tog cilja, a ne brojem oblaka.
+// Dubina scene se kopira (blit) u teksturu, pa cestice meko nestaju gde seku teren/modele i
+// ne crtaju se preko objekata ispred njih.
+class CloudLayer
+{
+public:
+    enum Quality {
+        QUALITY_LOW,        // cetvrtina rezolucije, 200 oblaka
+        QUALITY_MEDIUM,     // pola rezolucije, 400 oblaka
+        QUALITY_HIGH        // puna rezolucija, 800 oblaka
+    };
+
+    CloudLayer();
+
+    CloudLayer(const CloudLayer&) = delete;
+    CloudLayer& operator=(const CloudLayer&) = delete;
+
+    // Render nit. Velicina je velicina framebuffer-a prozora.
+    void init(GLuint particleProgram, GLuint compositeProgram, int width, int height, Quality quality);
+    void setQuality(Quality quality);
+    Quality getQuality() const { return quality; }
+
+    // Crta oblake preko vec nacrtane scene u podrazumevanom framebuffer-u (posle svih neprovidnih objekata)
+    void render(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& cameraPosition, float nearPlane, float farPlane);
+
+    void release();
+
+    int particleCount() const { return (int)particles.size(); }
+
+private:
+    struct Particle {
+        glm::vec4 centerSize;   // centar (xyz) i poluprecnik (w)
+        glm::vec4 shade;        // svetlina (x), neprovidnost (y), seme za sum (z)
+    };
+
+    void generateParticles();
+    void createTargets();
+    void sortParticles(const glm::vec3& cameraPosition);
+
+    GLuint particleProgram;
+    GLuint compositeProgram;
+    Quality quality;
+    int width;
+    int height;
+    int targetWidth;
+    int targetHeight;
+
+    GLuint depthTexture;
+    GLuint depthFbo;
+    GLuint cloudTexture;
+    GLuint cloudFbo;
+
+    GLuint quadVAO;
+    GLuint quadVBO;
+    GLuint instanceVBO;
+    GLuint emptyVAO;
+    bool instancesDirty;
+
+    glm::vec3 sortedFrom;
+    std::vector<Particle> particles;
+};
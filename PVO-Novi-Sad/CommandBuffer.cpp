@@ -0,0 +1,97 @@
+#include "CommandBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <glm/gtc/type_ptr.hpp>
+
+using namespace std;
+using namespace glm;
+
+UniformValue::UniformValue(const vec2& value)
+    : type(UNIFORM_VEC2), intValue(0)
+{
+    values[0] = value.x;
+    values[1] = value.y;
+}
+
+UniformValue::UniformValue(const vec3& value)
+    : type(UNIFORM_VEC3), intValue(0)
+{
+    values[0] = value.x;
+    values[1] = value.y;
+    values[2] = value.z;
+}
+
+UniformValue::UniformValue(const mat4& value)
+    : type(UNIFORM_MAT4), intValue(0)
+{
+    memcpy(values, value_ptr(value), sizeof(values));
+}
+
+void CommandBuffer::draw(const DrawCommand& command)
+{
+    if (!command.mesh.isValid() || !command.program.isValid() || command.count <= 0) {
+        return;
+    }
+    Command entry = { COMMAND_DRAW, (int)draws.size() };
+    draws.push_back(command);
+    commands.push_back(entry);
+}
+
+void CommandBuffer::setUniform(ProgramHandle program, const char* name, const UniformValue& value)
+{
+    Command entry = { COMMAND_UNIFORM, (int)uniforms.size() };
+    UniformCommand uniform = { program, name, value };
+    uniforms.push_back(uniform);
+    commands.push_back(entry);
+}
+
+void CommandBuffer::clear(const vec4& color, GLbitfield mask)
+{
+    Command entry = { COMMAND_CLEAR, (int)clears.size() };
+    ClearCommand clearCommand = { color, mask };
+    clears.push_back(clearCommand);
+    commands.push_back(entry);
+}
+
+void CommandBuffer::sortDraws()
+{
+    // Stabilno sortiranje svakog niza uzastopnih draw komandi (jednaki kljucevi zadrzavaju redosled snimanja)
+    auto byState = [this](const Command& a, const Command& b) {
+        const DrawCommand& drawA = draws[a.index];
+        const DrawCommand& drawB = draws[b.index];
+        if (drawA.program.id != drawB.program.id) return drawA.program.id < drawB.program.id;
+        if (drawA.texture.id != drawB.texture.id) return drawA.texture.id < drawB.texture.id;
+        // Isto odsecanje jedno do drugog, da Renderer moze da ih spoji u jedan multi-draw
+        if (drawA.cull != drawB.cull) return drawA.cull < drawB.cull;
+        if (drawA.frontFaceCW != drawB.frontFaceCW) return drawB.frontFaceCW;
+        if (drawA.mesh.id != drawB.mesh.id) return drawA.mesh.id < drawB.mesh.id;
+        // Materijal nije stanje (cita se iz podataka crtanja), ali isti materijali jedan do drugog
+        return drawA.material < drawB.material;
+    };
+
+    size_t runStart = 0;
+    while (runStart < commands.size()) {
+        if (commands[runStart].type != COMMAND_DRAW) {
+            ++runStart;
+            continue;
+        }
+        size_t runEnd = runStart;
+        while (runEnd < commands.size() && commands[runEnd].type == COMMAND_DRAW) {
+            ++runEnd;
+        }
+        stable_sort(commands.begin() + runStart, commands.begin() + runEnd, byState);
+        runStart = runEnd;
+    }
+}
+
+void CommandBuffer::reset()
+{
+    // clear() zadrzava kapacitet, pa snimanje u sledecem frejmu ne alocira
+    commands.clear();
+    draws.clear();
+    uniforms.clear();
+    clears.clear();
+    callbacks.clear();
+}
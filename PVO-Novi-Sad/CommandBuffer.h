@@ -0,0 +1,163 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cassert>
+#include <vector>
+
+#include "Arena.h"
+
+// Rucke resursa koje izdaje Renderer (0 = nevazeca). Igra radi samo sa ruckama, a GL imena zna samo Renderer.
+struct MeshHandle {
+    int id;
+    MeshHandle() : id(0) {}
+    explicit MeshHandle(int handleId) : id(handleId) {}
+    bool isValid() const { return id != 0; }
+};
+
+struct TextureHandle {
+    int id;
+    TextureHandle() : id(0) {}
+    explicit TextureHandle(int handleId) : id(handleId) {}
+    bool isValid() const { return id != 0; }
+};
+
+struct ProgramHandle {
+    int id;
+    ProgramHandle() : id(0) {}
+    explicit ProgramHandle(int handleId) : id(handleId) {}
+    bool isValid() const { return id != 0; }
+};
+
+enum CullMode {
+    CULL_BACK,
+    CULL_FRONT,
+    CULL_NONE
+};
+
+// Jedan glDrawArrays/glDrawElementsBaseVertex sa podacima koji se menjaju po objektu
+// (model, boja, providnost, pomeraj i materijal idu u InstanceRing, ili u uniforme ako program nema uDrawData).
+struct DrawCommand {
+    ProgramHandle program;
+    MeshHandle mesh;
+    TextureHandle texture;      // jedinica 0
+    GLenum primitive;
+    GLint first;
+    GLsizei count;
+    GLenum indexType;           // GL_NONE = bez indeksa
+    size_t indexOffset;         // u bajtovima
+    GLint baseVertex;
+    glm::mat4 model;
+    glm::vec3 color;
+    float alpha;                // uAlpha iz base.frag (0 = neprovidno)
+    glm::vec2 translation;      // pomeraj niskoletnih meta (dron.vert)
+    int material;               // indeks u MaterialTable Renderer-a (0 = podrazumevani)
+    CullMode cull;
+    bool frontFaceCW;           // ogledalne matrice modela okrecu redosled temena
+
+    DrawCommand()
+        : primitive(GL_TRIANGLES), first(0), count(0), indexType(GL_NONE), indexOffset(0), baseVertex(0),
+          model(1.0f), color(1.0f), alpha(0.0f), translation(0.0f), material(0), cull(CULL_BACK), frontFaceCW(false)
+    {
+    }
+
+    DrawCommand(ProgramHandle drawProgram, MeshHandle drawMesh, GLenum drawPrimitive, GLint drawFirst, GLsizei drawCount)
+        : program(drawProgram), mesh(drawMesh), primitive(drawPrimitive), first(drawFirst), count(drawCount),
+          indexType(GL_NONE), indexOffset(0), baseVertex(0), model(1.0f), color(1.0f), alpha(0.0f), translation(0.0f),
+          material(0), cull(CULL_BACK), frontFaceCW(false)
+    {
+    }
+};
+
+// Vrednost uniforme (int, float, vec2, vec3 ili mat4) - kopira se, pa komanda ne zavisi od promenljivih igre
+struct UniformValue {
+    enum Type {
+        UNIFORM_INT,
+        UNIFORM_FLOAT,
+        UNIFORM_VEC2,
+        UNIFORM_VEC3,
+        UNIFORM_MAT4
+    };
+
+    Type type;
+    int intValue;
+    float values[16];
+
+    UniformValue(bool value) : type(UNIFORM_INT), intValue(value ? 1 : 0) {}
+    UniformValue(int value) : type(UNIFORM_INT), intValue(value) {}
+    UniformValue(float value) : type(UNIFORM_FLOAT), intValue(0) { values[0] = value; }
+    UniformValue(double value) : type(UNIFORM_FLOAT), intValue(0) { values[0] = (float)value; }
+    UniformValue(const glm::vec2& value);
+    UniformValue(const glm::vec3& value);
+    UniformValue(const glm::mat4& value);
+};
+
+// Snimljen niz komandi jednog prolaza. Snimanje ne poziva GL - izvrsava ga Renderer::execute.
+// Uzastopne draw komande mogu da se sortiraju (program, tekstura, mreza, materijal) da bi bilo manje promena stanja;
+// uniforme, brisanja i callback-ovi su granice preko kojih se ne sortira.
+class CommandBuffer
+{
+public:
+    enum CommandType {
+        COMMAND_DRAW,
+        COMMAND_UNIFORM,
+        COMMAND_CLEAR,
+        COMMAND_CALLBACK
+    };
+
+    struct UniformCommand {
+        ProgramHandle program;
+        const char* name;       // string literal - Renderer kesira lokacije po adresi imena
+        UniformValue value;
+    };
+
+    struct ClearCommand {
+        glm::vec4 color;
+        GLbitfield mask;
+    };
+
+    struct Command {
+        CommandType type;
+        int index;              // u draws/uniforms/clears/callbacks
+    };
+
+    CommandBuffer() : arena(nullptr) {}
+
+    // Arena u kojoj zive callback-ovi (frejm arena grafa) - mora da traje dok se komande ne izvrse
+    void setArena(LinearArena* callbackArena) { arena = callbackArena; }
+
+    void draw(const DrawCommand& command);
+    void setUniform(ProgramHandle program, const char* name, const UniformValue& value);
+    void clear(const glm::vec4& color, GLbitfield mask);
+    // Za module koji sami crtaju (slojevi oblaka, impostori...); posle poziva Renderer zaboravlja kesirano stanje.
+    // Zahvacene vrednosti se kopiraju u arenu, pa snimanje callback-a ne ide na heap.
+    template<typename F>
+    void callback(F&& function)
+    {
+        assert(arena != nullptr);
+        Command entry = { COMMAND_CALLBACK, (int)callbacks.size() };
+        callbacks.emplace_back(*arena, std::forward<F>(function));
+        commands.push_back(entry);
+    }
+
+    void sortDraws();
+    void reset();
+
+    bool empty() const { return commands.empty(); }
+    int drawCount() const { return (int)draws.size(); }
+
+    const std::vector<Command>& getCommands() const { return commands; }
+    const DrawCommand& getDraw(int index) const { return draws[index]; }
+    const UniformCommand& getUniform(int index) const { return uniforms[index]; }
+    const ClearCommand& getClear(int index) const { return clears[index]; }
+    const ArenaFunction<void>& getCallback(int index) const { return callbacks[index]; }
+
+private:
+    std::vector<Command> commands;
+    std::vector<DrawCommand> draws;
+    std::vector<UniformCommand> uniforms;
+    std::vector<ClearCommand> clears;
+    std::vector<ArenaFunction<void> > callbacks;
+    LinearArena* arena;
+};
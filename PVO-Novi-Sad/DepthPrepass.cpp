@@ -0,0 +1,140 @@
+#include "DepthPrepass.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+using namespace std;
+using namespace glm;
+
+// Nivoi toplotne mape: 0, 1, 2, 3, 4 i 5+ upisanih fragmenata po pikselu
+static const int OVERDRAW_LEVELS = 6;
+static const float OVERDRAW_COLORS[OVERDRAW_LEVELS][3] = {
+    { 0.0f, 0.0f, 0.0f },
+    { 0.0f, 0.2f, 0.8f },
+    { 0.0f, 0.8f, 0.2f },
+    { 0.9f, 0.9f, 0.0f },
+    { 1.0f, 0.5f, 0.0f },
+    { 1.0f, 0.0f, 0.0f }
+};
+
+DepthPrepass::DepthPrepass()
+    : depthProgram(0), overdrawProgram(0), emptyVAO(0), queryIndex(0), lastSamples(0),
+      enabled(false), overdrawView(false), prepassDone(false)
+{
+    queries[0] = queries[1] = 0;
+    queryPending[0] = queryPending[1] = false;
+}
+
+void DepthPrepass::init(GLuint depthShader, GLuint overdrawShader)
+{
+    depthProgram = depthShader;
+    overdrawProgram = overdrawShader;
+    glGenVertexArrays(1, &emptyVAO);
+    glGenQueries(2, queries);
+}
+
+bool DepthPrepass::begin(const mat4& view, const mat4& projection)
+{
+    prepassDone = false;
+    if (!enabled || depthProgram == 0) {
+        return false;
+    }
+
+    glUseProgram(depthProgram);
+    glUniformMatrix4fv(glGetUniformLocation(depthProgram, "uV"), 1, GL_FALSE, value_ptr(view));
+    glUniformMatrix4fv(glGetUniformLocation(depthProgram, "uP"), 1, GL_FALSE, value_ptr(projection));
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthMask(GL_TRUE);
+    glDepthFunc(GL_LESS);
+    return true;
+}
+
+void DepthPrepass::end()
+{
+    glBindVertexArray(0);
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    // Glavni prolaz prolazi samo na dubini iz pre-pass-a (ili blize, za objekte koji nisu u njemu)
+    glDepthFunc(GL_LEQUAL);
+    prepassDone = true;
+}
+
+void DepthPrepass::beginShading()
+{
+    // Upit koji se sada ponovo koristi je od pre dva frejma - rezultat se cita samo ako je vec spreman
+    if (queryPending[queryIndex]) {
+        GLuint available = 0;
+        glGetQueryObjectuiv(queries[queryIndex], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            GLuint samples = 0;
+            glGetQueryObjectuiv(queries[queryIndex], GL_QUERY_RESULT, &samples);
+            lastSamples = (int)samples;
+            queryPending[queryIndex] = false;
+        }
+    }
+    if (!queryPending[queryIndex]) {
+        glBeginQuery(GL_SAMPLES_PASSED, queries[queryIndex]);
+    }
+
+    if (overdrawView) {
+        // Svaki fragment koji prodje test dubine uvecava brojac piksela
+        glEnable(GL_STENCIL_TEST);
+        glStencilMask(0xFF);
+        glStencilFunc(GL_ALWAYS, 0, 0xFF);
+        glStencilOp(GL_KEEP, GL_KEEP, GL_INCR);
+    }
+}
+
+void DepthPrepass::endShading()
+{
+    if (!queryPending[queryIndex]) {
+        glEndQuery(GL_SAMPLES_PASSED);
+        queryPending[queryIndex] = true;
+        queryIndex ^= 1;
+    }
+    if (overdrawView) {
+        glDisable(GL_STENCIL_TEST);
+    }
+    if (prepassDone) {
+        glDepthFunc(GL_LESS);
+        prepassDone = false;
+    }
+}
+
+void DepthPrepass::drawOverdraw()
+{
+    if (!overdrawView || overdrawProgram == 0) {
+        return;
+    }
+
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    GLboolean blend = glIsEnabled(GL_BLEND);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+    glEnable(GL_STENCIL_TEST);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+
+    glUseProgram(overdrawProgram);
+    GLint colorLoc = glGetUniformLocation(overdrawProgram, "color");
+    glBindVertexArray(emptyVAO);
+    for (int level = 0; level < OVERDRAW_LEVELS; ++level) {
+        // Poslednji nivo pokriva sve vece vrednosti brojaca
+        glStencilFunc(level == OVERDRAW_LEVELS - 1 ? GL_LEQUAL : GL_EQUAL, level, 0xFF);
+        glUniform3f(colorLoc, OVERDRAW_COLORS[level][0], OVERDRAW_COLORS[level][1], OVERDRAW_COLORS[level][2]);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+    glBindVertexArray(0);
+
+    glDisable(GL_STENCIL_TEST);
+    if (depthTest) glEnable(GL_DEPTH_TEST);
+    if (blend) glEnable(GL_BLEND);
+}
+
+void DepthPrepass::release()
+{
+    if (emptyVAO != 0) {
+        glDeleteVertexArrays(1, &emptyVAO);
+        glDeleteQueries(2, queries);
+        emptyVAO = 0;
+        queries[0] = queries[1] = 0;
+    }
+    depthProgram = overdrawProgram = 0;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+// Opcioni dubinski pre-pass za neprovidne mreze (teren/planina, helikopteri, dron).
+// Prvi prolaz upisuje samo dubinu jeftinim shaderom (depth.vert + prazan fragment shader),
+// pa u glavnom prolazu skupi Phong + reflektor iz base.frag radi samo za fragment koji je zaista vidljiv
+// (poredjenje dubine GL_LEQUAL: mreze iz pre-pass-a prolaze tacno na jednakoj dubini, a mali 2D markeri
+// koji nisu u pre-pass-u se i dalje crtaju normalno).
+// Za merenje ustede broje se fragmenti koji prodju test dubine u glavnom prolazu (occlusion upit), a
+// rezim prikaza preklapanja (overdraw) boji svaki piksel po broju upisanih fragmenata (stencil brojac).
+class DepthPrepass
+{
+public:
+    DepthPrepass();
+
+    DepthPrepass(const DepthPrepass&) = delete;
+    DepthPrepass& operator=(const DepthPrepass&) = delete;
+
+    // Render nit. overdrawProgram je fullscreen.vert + overdraw.frag.
+    void init(GLuint depthProgram, GLuint overdrawProgram);
+
+    void setEnabled(bool value) { enabled = value; }
+    bool isEnabled() const { return enabled; }
+    void setOverdrawView(bool value) { overdrawView = value; }
+    bool isOverdrawView() const { return overdrawView; }
+
+    // Vraca false ako je pre-pass iskljucen (tada se ne crta nista do end())
+    bool begin(const glm::mat4& view, const glm::mat4& projection);
+    // Izmedju begin i end se crta programom depthProgram (uM se postavlja po komandi, uV i uP ovde)
+    void end();
+
+    // Oko glavnog prolaza neprovidnih objekata
+    void beginShading();
+    void endShading();
+
+    // Toplotna mapa preklapanja preko celog ekrana (posle svih prolaza)
+    void drawOverdraw();
+
+    // Fragmenti koji su prosli test dubine u glavnom prolazu (rezultat kasni dva frejma, bez cekanja GPU-a)
+    int shadedFragments() const { return lastSamples; }
+
+    void release();
+
+private:
+    GLuint depthProgram;
+    GLuint overdrawProgram;
+    GLuint emptyVAO;
+    GLuint queries[2];
+    int queryIndex;
+    bool queryPending[2];
+    int lastSamples;
+
+    bool enabled;
+    bool overdrawView;
+    bool prepassDone;
+};
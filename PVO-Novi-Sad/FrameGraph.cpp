@@ -0,0 +1,161 @@
+#include "FrameGraph.h"
+
+#include <iostream>
+
+using namespace std;
+
+FrameGraph::FrameGraph()
+    : activePasses(0), culledPasses(0), compiled(false)
+{
+}
+
+void FrameGraph::reset()
+{
+    for (int i = 0; i < activePasses; ++i) {
+        passes[i].commands.reset();
+        passes[i].reads.clear();
+        passes[i].writes.clear();
+        passes[i].begin.reset();
+        passes[i].end.reset();
+    }
+    // Tek posle unistavanja kuka i callback-ova
+    arena.reset();
+    resources.clear();
+    activePasses = 0;
+    culledPasses = 0;
+    compiled = false;
+}
+
+FrameGraph::Resource FrameGraph::importResource(const char* name)
+{
+    ResourceInfo resource = { name, true };
+    resources.push_back(resource);
+    return (Resource)resources.size() - 1;
+}
+
+FrameGraph::Resource FrameGraph::createResource(const char* name)
+{
+    ResourceInfo resource = { name, false };
+    resources.push_back(resource);
+    return (Resource)resources.size() - 1;
+}
+
+FrameGraph::Pass& FrameGraph::addPass(const char* name, initializer_list<Resource> reads, initializer_list<Resource> writes)
+{
+    if (activePasses == (int)passes.size()) {
+        passes.emplace_back();
+    }
+    Pass& pass = passes[activePasses++];
+    pass.name = name;
+    pass.arena = &arena;
+    pass.commands.setArena(&arena);
+    pass.reads.assign(reads.begin(), reads.end());
+    pass.writes.assign(writes.begin(), writes.end());
+    pass.sortDraws = false;
+    pass.depthTest = true;
+    pass.blend = false;
+    pass.alive = true;
+    return pass;
+}
+
+int FrameGraph::recordedDraws() const
+{
+    int drawCount = 0;
+    for (int i = 0; i < activePasses; ++i) {
+        drawCount += passes[i].commands.drawCount();
+    }
+    return drawCount;
+}
+
+void FrameGraph::compile()
+{
+    // Citanje resursa pre nego sto ga je neko napisao (greska u redosledu prolaza)
+    written.assign(resources.size(), false);
+    for (int i = 0; i < activePasses; ++i) {
+        const Pass& pass = passes[i];
+        for (Resource read : pass.reads) {
+            if (!resources[read].imported && !written[read]) {
+                cout << "FrameGraph: prolaz '" << pass.name << "' cita '" << resources[read].name << "' pre upisa\n";
+            }
+        }
+        for (Resource write : pass.writes) {
+            written[write] = true;
+        }
+    }
+
+    // Unazad: prolaz je ziv ako pise nesto sto je potrebno; tada su potrebni i resursi koje on cita
+    needed.assign(resources.size(), false);
+    for (size_t r = 0; r < resources.size(); ++r) {
+        needed[r] = resources[r].imported;
+    }
+    culledPasses = 0;
+    for (int i = activePasses - 1; i >= 0; --i) {
+        Pass& pass = passes[i];
+        pass.alive = false;
+        for (Resource write : pass.writes) {
+            pass.alive = pass.alive || needed[write];
+        }
+        // Prolaz bez komandi i bez kuka nema sta da uradi
+        if (pass.commands.empty() && !pass.begin && !pass.end) {
+            pass.alive = false;
+        }
+        if (!pass.alive) {
+            culledPasses++;
+            continue;
+        }
+        for (Resource read : pass.reads) {
+            needed[read] = true;
+        }
+        if (pass.sortDraws) {
+            pass.commands.sortDraws();
+        }
+    }
+    compiled = true;
+}
+
+void FrameGraph::execute(Renderer& renderer)
+{
+    if (!compiled) {
+        compile();
+    }
+
+    int drawCount = 0;
+    for (int i = 0; i < activePasses; ++i) {
+        if (passes[i].alive) {
+            drawCount += passes[i].commands.drawCount();
+        }
+    }
+    renderer.beginFrame(drawCount);
+
+    for (int i = 0; i < activePasses; ++i) {
+        Pass& pass = passes[i];
+        if (!pass.alive) {
+            continue;
+        }
+        if (pass.begin && !pass.begin()) {
+            continue;
+        }
+
+        if (!pass.depthTest) {
+            glDisable(GL_DEPTH_TEST);
+        }
+        if (pass.blend) {
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        }
+
+        renderer.execute(pass.commands);
+
+        if (pass.blend) {
+            glDisable(GL_BLEND);
+        }
+        if (!pass.depthTest) {
+            glEnable(GL_DEPTH_TEST);
+        }
+        if (pass.end) {
+            pass.end();
+        }
+    }
+
+    renderer.endFrame();
+}
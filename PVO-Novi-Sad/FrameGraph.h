@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Arena.h"
+#include "CommandBuffer.h"
+#include "Renderer.h"
+
+#include <deque>
+#include <initializer_list>
+#include <vector>
+
+// Graf prolaza jednog frejma. Igra svakog frejma dodaje prolaze redom kojim treba da se izvrse, sa resursima
+// koje citaju i pisu, i snima komande u njihove CommandBuffer-e. compile() odbacuje prolaze ciji rezultat
+// niko ne koristi (zivi su prolazi koji pisu u uvezen resurs - ekran, CPU kopiju - ili u resurs koji cita
+// neki kasniji zivi prolaz) i prijavljuje citanje resursa koji jos niko nije napisao.
+// Kuke begin/end pozivaju module koji postavljaju svoje framebuffer-e (OIT, pre-pass, Hi-Z...);
+// begin moze da vrati false, pa se komande i end tog prolaza preskacu.
+// Kuke, callback-ovi i ostali privremeni podaci frejma (instance, ciljne pozicije) zive u areni grafa,
+// koja se prazni u reset(), pa snimanje frejma u stabilnom stanju ne alocira na heap-u.
+class FrameGraph
+{
+public:
+    typedef int Resource;
+
+    struct Pass {
+        const char* name;       // string literal
+        std::vector<Resource> reads;
+        std::vector<Resource> writes;
+        ArenaFunction<bool> begin;
+        ArenaFunction<void> end;
+        bool sortDraws;         // draw komande smeju da se preurede (neprovidni i OIT prolazi)
+        bool depthTest;
+        bool blend;             // GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA
+        bool alive;
+        CommandBuffer commands;
+        LinearArena* arena;
+
+        template<typename F>
+        void onBegin(F&& function) { begin = ArenaFunction<bool>(*arena, std::forward<F>(function)); }
+        template<typename F>
+        void onEnd(F&& function) { end = ArenaFunction<void>(*arena, std::forward<F>(function)); }
+    };
+
+    FrameGraph();
+
+    FrameGraph(const FrameGraph&) = delete;
+    FrameGraph& operator=(const FrameGraph&) = delete;
+
+    // Brise prolaze i resurse prethodnog frejma (memorija komandi i arene se zadrzava)
+    void reset();
+
+    // Privremeni podaci frejma - vaze dok se graf ne resetuje (i dok ga render nit izvrsava)
+    LinearArena& frameArena() { return arena; }
+
+    // Resurs koji postoji i van frejma (podrazumevani framebuffer, Hi-Z kopija) - prolazi koji ga pisu su uvek zivi
+    Resource importResource(const char* name);
+    // Privremen resurs unutar frejma
+    Resource createResource(const char* name);
+
+    // Referenca ostaje vazeca do reset() (prolazi su u deque-u)
+    Pass& addPass(const char* name, std::initializer_list<Resource> reads, std::initializer_list<Resource> writes);
+
+    void compile();
+    void execute(Renderer& renderer);
+
+    int passCount() const { return activePasses; }
+    // Draw komande snimljene u sve prolaze (i one koje ce compile() odbaciti)
+    int recordedDraws() const;
+    int culledPassCount() const { return culledPasses; }
+
+private:
+    struct ResourceInfo {
+        const char* name;       // string literal
+        bool imported;
+    };
+
+    std::deque<Pass> passes;        // prvih activePasses je u upotrebi, ostali cekaju ponovnu upotrebu
+    std::vector<ResourceInfo> resources;
+    std::vector<bool> written;      // compile() - clanovi da se ne bi alocirali svakog frejma
+    std::vector<bool> needed;
+    LinearArena arena;
+    int activePasses;
+    int culledPasses;
+    bool compiled;
+};
@@ -0,0 +1,95 @@
+#include "Frustum.h"
+
+#include <cmath>
+
+using namespace glm;
+
+Bounds computeBounds(const std::vector<vec3>& points)
+{
+    return computeBounds(points.empty() ? NULL : &points[0].x, (int)points.size(), 3);
+}
+
+Bounds computeBounds(const float* points, int count, int stride)
+{
+    Bounds bounds;
+    bounds.minCorner = bounds.maxCorner = count == 0 ? vec3(0.0f) : vec3(points[0], points[1], points[2]);
+    for (int i = 1; i < count; ++i) {
+        const float* p = points + (size_t)i * stride;
+        vec3 point(p[0], p[1], p[2]);
+        bounds.minCorner = min(bounds.minCorner, point);
+        bounds.maxCorner = max(bounds.maxCorner, point);
+    }
+    bounds.center = (bounds.minCorner + bounds.maxCorner) * 0.5f;
+    bounds.radius = length(bounds.maxCorner - bounds.center);
+    return bounds;
+}
+
+Bounds transformBounds(const Bounds& bounds, const mat4& model)
+{
+    // Arvo: poluprecnik nove AABB je zbir apsolutnih vrednosti kolona matrice pomnozenih poluprecnikom stare
+    vec3 center = vec3(model * vec4(bounds.center, 1.0f));
+    vec3 extent = bounds.maxCorner - bounds.center;
+    vec3 newExtent(0.0f);
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            newExtent[i] += fabs(model[j][i]) * extent[j];
+        }
+    }
+
+    Bounds result;
+    result.minCorner = center - newExtent;
+    result.maxCorner = center + newExtent;
+    result.center = center;
+    result.radius = length(newExtent);
+    return result;
+}
+
+void Frustum::extract(const mat4& viewProjection)
+{
+    // glm je column-major: i-ti red matrice je (m[0][i], m[1][i], m[2][i], m[3][i])
+    vec4 rows[4];
+    for (int i = 0; i < 4; ++i) {
+        rows[i] = vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+    }
+
+    planes[0] = rows[3] + rows[0];  // leva
+    planes[1] = rows[3] - rows[0];  // desna
+    planes[2] = rows[3] + rows[1];  // donja
+    planes[3] = rows[3] - rows[1];  // gornja
+    planes[4] = rows[3] + rows[2];  // prednja
+    planes[5] = rows[3] - rows[2];  // zadnja
+
+    for (int i = 0; i < 6; ++i) {
+        float len = length(vec3(planes[i]));
+        planes[i] /= len;
+    }
+}
+
+bool Frustum::intersectsBox(const vec3& minCorner, const vec3& maxCorner) const
+{
+    for (int i = 0; i < 6; ++i) {
+        // Teme kutije najdalje u smeru normale - ako je i ono iza ravni, cela kutija je van
+        vec3 positive(planes[i].x >= 0.0f ? maxCorner.x : minCorner.x,
+                      planes[i].y >= 0.0f ? maxCorner.y : minCorner.y,
+                      planes[i].z >= 0.0f ? maxCorner.z : minCorner.z);
+        if (dot(vec3(planes[i]), positive) + planes[i].w < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Frustum::intersectsSphere(const vec3& center, float radius) const
+{
+    for (int i = 0; i < 6; ++i) {
+        if (dot(vec3(planes[i]), center) + planes[i].w < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Frustum::intersectsBounds(const Bounds& bounds) const
+{
+    return intersectsSphere(bounds.center, bounds.radius) && intersectsBox(bounds.minCorner, bounds.maxCorner);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// Granice modela: AABB i sfera oko njenog centra
+struct Bounds {
+    glm::vec3 minCorner;
+    glm::vec3 maxCorner;
+    glm::vec3 center;
+    float radius;
+};
+
+Bounds computeBounds(const std::vector<glm::vec3>& points);
+// Pozicije u nizu sa vise podataka po temenu (stride u float-ovima, pozicija na pocetku)
+Bounds computeBounds(const float* points, int count, int stride);
+
+// AABB u prostoru sveta koja obuhvata transformisanu AABB modela
+Bounds transformBounds(const Bounds& bounds, const glm::mat4& model);
+
+struct CullingStats {
+    int tested;
+    int visible;
+    int culled;
+    int occluded;   // prosli piramidu pogleda, ali su iza zaklanjaca (OcclusionCuller)
+};
+
+// Piramida pogleda kamere: 6 ravni izvucenih iz projection * view matrice (Gribb-Hartmann).
+// Normale ravni gledaju ka unutrasnjosti, pa je tacka vidljiva ako je dot(n, p) + d >= 0 za sve ravni.
+struct Frustum {
+    glm::vec4 planes[6];
+
+    void extract(const glm::mat4& viewProjection);
+    bool intersectsBox(const glm::vec3& minCorner, const glm::vec3& maxCorner) const;
+    bool intersectsSphere(const glm::vec3& center, float radius) const;
+
+    // Prvo jeftin test sfere, pa AABB - granice su vec u prostoru sveta
+    bool intersectsBounds(const Bounds& bounds) const;
+};
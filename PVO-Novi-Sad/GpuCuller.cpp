@@ -0,0 +1,324 @@
+#include "GpuCuller.h"
+
+#include "Renderer.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include <glm/gtc/type_ptr.hpp>
+
+using namespace std;
+using namespace glm;
+
+static GLuint linkCullProgram(GLuint program)
+{
+    glLinkProgram(program);
+    GLint success = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        char infoLog[512];
+        glGetProgramInfoLog(program, 512, NULL, infoLog);
+        cout << "GpuCuller: program za odsecanje nije povezan:\n" << infoLog << "\n";
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+GpuCuller::GpuCuller()
+    : computeProgram(0), feedbackProgram(0), cullVAO(0), meshVAO(0), meshVBO(0), instanceBuffer(0), listBuffer(0),
+      commandBuffer(0), capacity(0), lodCount(0), firstVertex(0), drawSet(0), writtenSet(0), pending(false)
+{
+    for (int set = 0; set < 2; ++set) {
+        for (int list = 0; list <= MAX_LODS; ++list) {
+            queries[set][list] = 0;
+        }
+    }
+    for (int list = 0; list <= MAX_LODS; ++list) {
+        counts[list] = 0;
+    }
+}
+
+bool GpuCuller::isComputeSupported()
+{
+    // gpu_cull.comp je #version 430 (SSBO, atomicAdd), a crtanje koristi baseInstance iz indirektne komande
+    return GLEW_VERSION_4_3 != 0;
+}
+
+void GpuCuller::init(GLuint vertexShader, GLuint geometryShader, GLuint computeShader, int maxInstances)
+{
+    if (computeShader != 0) {
+        GLuint program = glCreateProgram();
+        glAttachShader(program, computeShader);
+        computeProgram = linkCullProgram(program);
+        glDeleteShader(computeShader);
+    }
+    else {
+        GLuint program = glCreateProgram();
+        glAttachShader(program, vertexShader);
+        glAttachShader(program, geometryShader);
+        // Izlaz geometry shadera ide u bafer liste (mora pre povezivanja)
+        const char* varyings[] = { "outInstance" };
+        glTransformFeedbackVaryings(program, 1, varyings, GL_INTERLEAVED_ATTRIBS);
+        feedbackProgram = linkCullProgram(program);
+        glDeleteShader(vertexShader);
+        glDeleteShader(geometryShader);
+        glGenQueries(2 * (MAX_LODS + 1), &queries[0][0]);
+    }
+
+    glGenVertexArrays(1, &cullVAO);
+    glGenVertexArrays(1, &meshVAO);
+    createBuffers(std::max(maxInstances, 1));
+}
+
+void GpuCuller::createBuffers(int instances)
+{
+    capacity = instances;
+    int sets = usesCompute() ? 1 : 2;
+
+    glGenBuffers(1, &instanceBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(vec4), NULL, GL_STREAM_DRAW);
+    glGenBuffers(1, &listBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, listBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sets * (MAX_LODS + 1) * capacity * sizeof(vec4), NULL, GL_DYNAMIC_COPY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    if (usesCompute()) {
+        glGenBuffers(1, &commandBuffer);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, (MAX_LODS + 1) * 4 * sizeof(GLuint), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+
+    glBindVertexArray(cullVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(vec4), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    // Sa compute putanjom baseInstance komande bira listu, pa atribut uvek pocinje od nule
+    glBindVertexArray(meshVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, listBuffer);
+    glVertexAttribPointer(INSTANCE_LOCATION, 4, GL_FLOAT, GL_FALSE, sizeof(vec4), (void*)0);
+    glVertexAttribDivisor(INSTANCE_LOCATION, 1);
+    glEnableVertexAttribArray(INSTANCE_LOCATION);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    pending = false;
+}
+
+void GpuCuller::setModel(const Bounds& modelBounds, const vector<MeshLod>& modelLods, int meshFirstVertex)
+{
+    bounds = modelBounds;
+    lodCount = std::min((int)modelLods.size(), (int)MAX_LODS);
+    for (int i = 0; i < lodCount; ++i) {
+        lods[i] = modelLods[i];
+    }
+    firstVertex = meshFirstVertex;
+}
+
+void GpuCuller::setCullUniforms(GLuint program, const Frustum& frustum, const vec3& viewPos, float projectionScale, bool useImpostor)
+{
+    float lodRadius[MAX_LODS] = { 0.0f };
+    int thresholdCount = lodThresholds(lodRadius, MAX_LODS);
+
+    glUniform4fv(glGetUniformLocation(program, "uPlanes"), 6, value_ptr(frustum.planes[0]));
+    glUniform4f(glGetUniformLocation(program, "uBounds"), bounds.center.x, bounds.center.y, bounds.center.z, bounds.radius);
+    glUniform3f(glGetUniformLocation(program, "uViewPos"), viewPos.x, viewPos.y, viewPos.z);
+    glUniform1f(glGetUniformLocation(program, "uProjectionScale"), projectionScale);
+    glUniform1i(glGetUniformLocation(program, "uLodCount"), lodCount);
+    glUniform1i(glGetUniformLocation(program, "uThresholdCount"), thresholdCount);
+    glUniform1fv(glGetUniformLocation(program, "uLodRadius"), MAX_LODS, lodRadius);
+    glUniform1f(glGetUniformLocation(program, "uImpostorRadius"), useImpostor ? impostorThreshold() : 0.0f);
+}
+
+void GpuCuller::cull(const vec4* instances, int count, const Frustum& frustum, const vec3& viewPos, float projectionScale, bool useImpostor)
+{
+    if (!isReady()) {
+        return;
+    }
+    if (count > capacity) {
+        // Retko (novi talas helikoptera) - liste prethodnog frejma se odbacuju
+        glDeleteBuffers(1, &instanceBuffer);
+        glDeleteBuffers(1, &listBuffer);
+        glDeleteBuffers(1, &commandBuffer);
+        instanceBuffer = listBuffer = commandBuffer = 0;
+        createBuffers(std::max(count, capacity * 2));
+    }
+
+    if (count > 0) {
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(vec4), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(vec4), instances);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    if (usesCompute()) {
+        // Komande se svaki frejm vracaju na nula instanci; shader ih broji atomicAdd-om
+        GLuint commands[(MAX_LODS + 1) * 4];
+        for (int list = 0; list <= lodCount; ++list) {
+            bool impostor = list == lodCount;
+            commands[list * 4 + 0] = impostor ? 6 : (GLuint)lods[list].count;
+            commands[list * 4 + 1] = 0;
+            commands[list * 4 + 2] = impostor ? 0 : (GLuint)(firstVertex + lods[list].first);
+            commands[list * 4 + 3] = (GLuint)(list * capacity);
+        }
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, (lodCount + 1) * 4 * sizeof(GLuint), commands);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        if (count == 0) {
+            return;
+        }
+
+        glUseProgram(computeProgram);
+        setCullUniforms(computeProgram, frustum, viewPos, projectionScale, useImpostor);
+        glUniform1i(glGetUniformLocation(computeProgram, "uInstanceCount"), count);
+        glUniform1i(glGetUniformLocation(computeProgram, "uCapacity"), capacity);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, instanceBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, listBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, commandBuffer);
+        glDispatchCompute((count + 63) / 64, 1, 1);
+        // Crtanje cita komande (indirect) i liste (atribut instance)
+        glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+        glUseProgram(0);
+        return;
+    }
+
+    // Transform feedback: crta se skup iz prethodnog frejma, ali tek kad su njegovi upiti gotovi. Ako GPU
+    // jos nije stigao, ostaju skup i brojevi od ranije, a novi cull ponovo pise u skup koji nije procitan.
+    if (pending) {
+        GLuint available = GL_TRUE;
+        for (int list = 0; list <= lodCount && available; ++list) {
+            glGetQueryObjectuiv(queries[writtenSet][list], GL_QUERY_RESULT_AVAILABLE, &available);
+        }
+        if (available) {
+            for (int list = 0; list <= lodCount; ++list) {
+                GLuint written = 0;
+                glGetQueryObjectuiv(queries[writtenSet][list], GL_QUERY_RESULT, &written);
+                counts[list] = (int)written;
+            }
+            drawSet = writtenSet;
+            pending = false;
+        }
+    }
+    else {
+        std::fill(counts, counts + MAX_LODS + 1, 0);
+    }
+    if (count == 0) {
+        return;
+    }
+
+    writtenSet = drawSet ^ 1;
+    glUseProgram(feedbackProgram);
+    setCullUniforms(feedbackProgram, frustum, viewPos, projectionScale, useImpostor);
+    GLint listLocation = glGetUniformLocation(feedbackProgram, "uList");
+    glBindVertexArray(cullVAO);
+    glEnable(GL_RASTERIZER_DISCARD);
+    for (int list = 0; list <= lodCount; ++list) {
+        GLintptr offset = (GLintptr)(writtenSet * (MAX_LODS + 1) + list) * capacity * sizeof(vec4);
+        glUniform1i(listLocation, list);
+        glBindBufferRange(GL_TRANSFORM_FEEDBACK_BUFFER, 0, listBuffer, offset, capacity * sizeof(vec4));
+        glBeginQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN, queries[writtenSet][list]);
+        glBeginTransformFeedback(GL_POINTS);
+        glDrawArrays(GL_POINTS, 0, count);
+        glEndTransformFeedback();
+        glEndQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN);
+    }
+    glDisable(GL_RASTERIZER_DISCARD);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    glBindVertexArray(0);
+    glUseProgram(0);
+    pending = true;
+}
+
+void GpuCuller::bindMeshBuffer(GLuint vertexBuffer)
+{
+    glBindVertexArray(meshVAO);
+    if (vertexBuffer == meshVBO) {
+        return;
+    }
+    // Arena je porasla (novi bafer) ili je ovo prvo crtanje
+    const GLsizei stride = Renderer::ARENA_FLOATS * sizeof(float);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, (void*)(5 * sizeof(float)));
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    meshVBO = vertexBuffer;
+}
+
+void GpuCuller::drawMeshes(GLuint vertexBuffer)
+{
+    if (!isReady() || vertexBuffer == 0) {
+        return;
+    }
+    bindMeshBuffer(vertexBuffer);
+
+    if (usesCompute()) {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        glMultiDrawArraysIndirect(GL_TRIANGLES, (void*)0, lodCount, 0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+    else {
+        // Bez baseInstance (GL 3.3) atribut instance se pomera na pocetak liste
+        glBindBuffer(GL_ARRAY_BUFFER, listBuffer);
+        for (int list = 0; list < lodCount; ++list) {
+            if (counts[list] == 0) {
+                continue;
+            }
+            GLintptr offset = (GLintptr)(drawSet * (MAX_LODS + 1) + list) * capacity * sizeof(vec4);
+            glVertexAttribPointer(INSTANCE_LOCATION, 4, GL_FLOAT, GL_FALSE, sizeof(vec4), (void*)offset);
+            glDrawArraysInstanced(GL_TRIANGLES, firstVertex + lods[list].first, lods[list].count, counts[list]);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    glBindVertexArray(0);
+}
+
+void GpuCuller::drawImpostors(GLuint program, Impostor& impostor)
+{
+    if (!isReady()) {
+        return;
+    }
+    if (usesCompute()) {
+        impostor.drawIndirect(program, listBuffer, commandBuffer, (GLintptr)lodCount * 4 * sizeof(GLuint));
+    }
+    else {
+        GLintptr offset = (GLintptr)(drawSet * (MAX_LODS + 1) + lodCount) * capacity * sizeof(vec4);
+        impostor.draw(program, listBuffer, offset, counts[lodCount]);
+    }
+}
+
+int GpuCuller::visibleCount() const
+{
+    if (usesCompute()) {
+        return -1;
+    }
+    int visible = 0;
+    for (int list = 0; list <= lodCount; ++list) {
+        visible += counts[list];
+    }
+    return visible;
+}
+
+void GpuCuller::release()
+{
+    if (computeProgram != 0) {
+        glDeleteProgram(computeProgram);
+    }
+    if (feedbackProgram != 0) {
+        glDeleteProgram(feedbackProgram);
+        glDeleteQueries(2 * (MAX_LODS + 1), &queries[0][0]);
+    }
+    glDeleteVertexArrays(1, &cullVAO);
+    glDeleteVertexArrays(1, &meshVAO);
+    glDeleteBuffers(1, &instanceBuffer);
+    glDeleteBuffers(1, &listBuffer);
+    glDeleteBuffers(1, &commandBuffer);
+    computeProgram = feedbackProgram = cullVAO = meshVAO = meshVBO = 0;
+    instanceBuffer = listBuffer = commandBuffer = 0;
+    lodCount = 0;
+    pending = false;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "Frustum.h"
+#include "Impostor.h"
+#include "MeshLod.h"
+
+// Odsecanje piramidom pogleda i izbor LOD-a za sve instance jednog modela na GPU-u. Igra predaje samo
+// niz ciljnih pozicija (pomeraj u svetu i razmera po instanci), a GPU za svaku instancu testira sferu
+// granica, bira nivo po velicini na ekranu (ili impostor) i upisuje je u zbijenu listu tog nivoa.
+// Sa compute shaderom (GL 4.3) liste i argumenti za glMultiDrawArraysIndirect nastaju atomicAdd-om u
+// jednom prolazu i CPU ne cita nista nazad. Na GL 3.3 isti test radi gpu_cull.vert, a gpu_cull.geom sa
+// transform feedback-om zbija po jednu listu po prolazu; broj instanci daje upit
+// GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN, pa se, da se ne bi cekalo na GPU, crtaju liste iz
+// prethodnog frejma (dva skupa lista naizmenicno). Upit se cita tek kad je rezultat spreman
+// (GL_QUERY_RESULT_AVAILABLE); dok nije, crta se stariji skup.
+// Razlike u odnosu na CPU putanju: nivo se bira bez histereze i nema Hi-Z testa (OcclusionCuller).
+class GpuCuller
+{
+public:
+    static const int MAX_LODS = 4;
+    static const GLuint INSTANCE_LOCATION = 8;     // inInstance u instanced.vert
+
+    GpuCuller();
+
+    GpuCuller(const GpuCuller&) = delete;
+    GpuCuller& operator=(const GpuCuller&) = delete;
+
+    // GL 4.3 compute + SSBO + multi-draw indirect (inace transform feedback putanja)
+    static bool isComputeSupported();
+
+    // Render nit. Prosledjuju se kompajlirani shaderi jedne putanje (computeShader ili vertexShader +
+    // geometryShader, ostalo 0); GpuCuller ih povezuje i brise.
+    void init(GLuint vertexShader, GLuint geometryShader, GLuint computeShader, int maxInstances);
+    bool usesCompute() const { return computeProgram != 0; }
+
+    // Render nit, kad model stigne. firstVertex je pocetak mreze u baferu temena (arena Renderer-a).
+    void setModel(const Bounds& bounds, const std::vector<MeshLod>& lods, int firstVertex);
+    bool hasModel() const { return lodCount > 0; }
+    // Programi su povezani i model je postavljen
+    bool isReady() const { return (computeProgram != 0 || feedbackProgram != 0) && lodCount > 0; }
+
+    // Render nit. instances (count komada): teme u svetu = pozicija * w + xyz
+    void cull(const glm::vec4* instances, int count, const Frustum& frustum, const glm::vec3& viewPos,
+        float projectionScale, bool useImpostor);
+
+    // Program (instanced.vert) mora biti aktivan sa postavljenim uV, uP, color i uAlpha.
+    // vertexBuffer je u formatu arene (pozicija, UV, normala).
+    void drawMeshes(GLuint vertexBuffer);
+    // Program impostora mora biti aktivan kao za Impostor::draw
+    void drawImpostors(GLuint program, Impostor& impostor);
+
+    // Instance poslednjeg rezultata po listi (samo za transform feedback putanju, inace -1)
+    int visibleCount() const;
+
+    void release();
+
+private:
+    void createBuffers(int instances);
+    void setCullUniforms(GLuint program, const Frustum& frustum, const glm::vec3& viewPos, float projectionScale, bool useImpostor);
+    void bindMeshBuffer(GLuint vertexBuffer);
+
+    GLuint computeProgram;
+    GLuint feedbackProgram;
+    GLuint cullVAO;             // transform feedback: ulazne instance na lokaciji 0
+    GLuint meshVAO;             // arena + inInstance
+    GLuint meshVBO;             // bafer arene na koji je meshVAO usmeren
+    GLuint instanceBuffer;      // ulaz
+    GLuint listBuffer;          // zbijene liste, capacity mesta po listi (dva skupa za transform feedback)
+    GLuint commandBuffer;       // DrawArraysIndirectCommand po listi (compute)
+    GLuint queries[2][MAX_LODS + 1];
+    int capacity;
+
+    Bounds bounds;
+    MeshLod lods[MAX_LODS];
+    int lodCount;
+    int firstVertex;
+
+    // Transform feedback: skup koji se crta, skup upisan u poslednjem cull() i broj instanci po listi
+    int drawSet;
+    int writtenSet;
+    bool pending;
+    int counts[MAX_LODS + 1];
+};
@@ -0,0 +1,104 @@
+#include "HeapCheck.h"
+
+#ifdef PVO_HEAP_CHECK
+
+#include <cstdlib>
+#include <new>
+
+static thread_local size_t allocationCount = 0;
+static thread_local size_t allocatedBytes = 0;
+
+static void* countedAllocate(size_t size)
+{
+    allocationCount++;
+    allocatedBytes += size;
+    return malloc(size == 0 ? 1 : size);
+}
+
+void* operator new(size_t size)
+{
+    void* pointer = countedAllocate(size);
+    if (pointer == nullptr) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAllocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAllocate(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+    free(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept
+{
+    free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+    free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+    free(pointer);
+}
+
+bool HeapCheck::isEnabled()
+{
+    return true;
+}
+
+size_t HeapCheck::threadAllocations()
+{
+    return allocationCount;
+}
+
+size_t HeapCheck::threadAllocatedBytes()
+{
+    return allocatedBytes;
+}
+
+#else
+
+bool HeapCheck::isEnabled()
+{
+    return false;
+}
+
+size_t HeapCheck::threadAllocations()
+{
+    return 0;
+}
+
+size_t HeapCheck::threadAllocatedBytes()
+{
+    return 0;
+}
+
+#endif
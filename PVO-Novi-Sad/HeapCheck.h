@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+
+// Brojanje alokacija opsteg heap-a po niti, za proveru da snimanje frejma u stabilnom stanju ne alocira.
+// Radi samo kad se program prevede sa PVO_HEAP_CHECK (tada HeapCheck.cpp zamenjuje globalni operator new);
+// inace su brojaci uvek 0.
+namespace HeapCheck
+{
+    bool isEnabled();
+
+    // Alokacije i bajtovi pozivajuce niti od pocetka programa
+    size_t threadAllocations();
+    size_t threadAllocatedBytes();
+}
@@ -0,0 +1,213 @@
+#include "Impostor.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+using namespace glm;
+
+// Opseg elevacije pravaca snimanja - kamera moze biti i ispod oblaka
+static const float MIN_PITCH = -60.0f;
+static const float MAX_PITCH = 60.0f;
+
+Impostor::Impostor()
+    : atlas(0), vao(0), quadVBO(0), instanceVBO(0), instanceCapacity(0)
+{
+}
+
+void Impostor::build(GLuint bakeProgram, GLuint modelVAO, int first, int count, const Bounds& modelBounds)
+{
+    bounds = modelBounds;
+    const int width = YAW_COUNT * CELL_SIZE;
+    const int height = PITCH_COUNT * CELL_SIZE;
+
+    glGenTextures(1, &atlas);
+    glBindTexture(GL_TEXTURE_2D, atlas);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // Manje mipmape bi mesale susedne celije
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 4);
+
+    GLuint depth;
+    glGenRenderbuffers(1, &depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+
+    GLint previousFramebuffer, previousProgram, previousViewport[4];
+    GLfloat previousClearColor[4];
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+    glGetIntegerv(GL_VIEWPORT, previousViewport);
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, previousClearColor);
+    GLboolean cullFace = glIsEnabled(GL_CULL_FACE);
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    GLboolean blend = glIsEnabled(GL_BLEND);
+
+    GLuint fbo;
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, atlas, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+
+    glViewport(0, 0, width, height);
+    glClearColor(0.5f, 0.5f, 0.5f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glDisable(GL_CULL_FACE);
+    glDisable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+
+    glUseProgram(bakeProgram);
+    GLint viewProjectionLoc = glGetUniformLocation(bakeProgram, "uViewProjection");
+    glBindVertexArray(modelVAO);
+
+    // Ortogonalna kamera na 2 poluprecnika od centra, isti pravci kao u impostor.vert
+    float radius = bounds.radius;
+    mat4 projection = ortho(-radius, radius, -radius, radius, radius, 3.0f * radius);
+    float pitchStep = radians(MAX_PITCH - MIN_PITCH) / (PITCH_COUNT - 1);
+    for (int pitchCell = 0; pitchCell < PITCH_COUNT; ++pitchCell) {
+        float pitch = radians(MIN_PITCH) + pitchCell * pitchStep;
+        for (int yawCell = 0; yawCell < YAW_COUNT; ++yawCell) {
+            float yaw = yawCell * 2.0f * 3.14159265f / YAW_COUNT;
+            vec3 direction(cos(pitch) * cos(yaw), sin(pitch), cos(pitch) * sin(yaw));
+            mat4 view = lookAt(bounds.center + direction * (2.0f * radius), bounds.center, vec3(0.0f, 1.0f, 0.0f));
+            mat4 viewProjection = projection * view;
+
+            glViewport(yawCell * CELL_SIZE, pitchCell * CELL_SIZE, CELL_SIZE, CELL_SIZE);
+            glUniformMatrix4fv(viewProjectionLoc, 1, GL_FALSE, value_ptr(viewProjection));
+            glDrawArrays(GL_TRIANGLES, first, count);
+        }
+    }
+
+    glBindVertexArray(0);
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteRenderbuffers(1, &depth);
+
+    glBindTexture(GL_TEXTURE_2D, atlas);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+    glClearColor(previousClearColor[0], previousClearColor[1], previousClearColor[2], previousClearColor[3]);
+    glUseProgram(previousProgram);
+    if (cullFace) glEnable(GL_CULL_FACE);
+    if (!depthTest) glDisable(GL_DEPTH_TEST);
+    if (blend) glEnable(GL_BLEND);
+
+    // Pravougaonik (dva trougla) i bafer instanci
+    const float corners[] = { -1.0f, -1.0f,  1.0f, -1.0f,  1.0f, 1.0f,  -1.0f, -1.0f,  1.0f, 1.0f,  -1.0f, 1.0f };
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &quadVBO);
+    glGenBuffers(1, &instanceVBO);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(vec4), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+void Impostor::addInstance(const mat4& model)
+{
+    Bounds worldBounds = transformBounds(bounds, model);
+    instances.push_back(vec4(worldBounds.center, worldBounds.radius));
+}
+
+ArenaArray<vec4> Impostor::takeInstances(LinearArena& arena)
+{
+    // clear() zadrzava kapacitet, pa skupljanje u sledecem frejmu ne alocira
+    ArenaArray<vec4> frameInstances = copyToArena(arena, instances);
+    instances.clear();
+    return frameInstances;
+}
+
+void Impostor::draw(GLuint program, const vec4* frameInstances, int count)
+{
+    if (count <= 0 || !isBuilt()) {
+        return;
+    }
+
+    // Bafer se "siroci" svaki frejm (glBufferData), pa drajver ne ceka da GPU zavrsi prethodni frejm
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    instanceCapacity = std::max(instanceCapacity, (size_t)count);
+    glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(vec4), NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(vec4), frameInstances);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    setupProgram(program);
+    glBindVertexArray(vao);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, count);
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void Impostor::draw(GLuint program, GLuint instanceBuffer, GLintptr offset, int count)
+{
+    if (count <= 0 || !isBuilt()) {
+        return;
+    }
+    setupProgram(program);
+    bindInstances(instanceBuffer, offset);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, count);
+    bindInstances(instanceVBO, 0);
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void Impostor::drawIndirect(GLuint program, GLuint instanceBuffer, GLuint indirectBuffer, GLintptr commandOffset)
+{
+    if (!isBuilt()) {
+        return;
+    }
+    setupProgram(program);
+    bindInstances(instanceBuffer, 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+    glDrawArraysIndirect(GL_TRIANGLES, (void*)commandOffset);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    bindInstances(instanceVBO, 0);
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void Impostor::setupProgram(GLuint program)
+{
+    glUniform1i(glGetUniformLocation(program, "uYawCount"), YAW_COUNT);
+    glUniform1i(glGetUniformLocation(program, "uPitchCount"), PITCH_COUNT);
+    glUniform1f(glGetUniformLocation(program, "uMinPitch"), radians(MIN_PITCH));
+    glUniform1f(glGetUniformLocation(program, "uMaxPitch"), radians(MAX_PITCH));
+    glUniform1i(glGetUniformLocation(program, "uAtlas"), 0);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, atlas);
+}
+
+void Impostor::bindInstances(GLuint buffer, GLintptr offset)
+{
+    // Atribut instance (lokacija 1) cita zadati bafer; VAO ostaje vezan
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(vec4), (void*)offset);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Impostor::release()
+{
+    if (atlas != 0) {
+        glDeleteTextures(1, &atlas);
+        glDeleteBuffers(1, &quadVBO);
+        glDeleteBuffers(1, &instanceVBO);
+        glDeleteVertexArrays(1, &vao);
+        atlas = vao = quadVBO = instanceVBO = 0;
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "Arena.h"
+#include "Frustum.h"
+
+// Impostor: model snimljen iz YAW_COUNT x PITCH_COUNT pravaca u atlas, pa se daleke instance crtaju
+// kao pravougaonici okrenuti ka kameri sa celijom atlasa najblizom pravcu pogleda.
+// Atlas cuva normale i pokrivenost, pa se osvetljenje racuna pri crtanju (impostor.frag).
+// Sve daleke instance jednog modela se crtaju jednim instanciranim pozivom.
+class Impostor
+{
+public:
+    static const int YAW_COUNT = 8;
+    static const int PITCH_COUNT = 5;
+    static const int CELL_SIZE = 128;
+
+    Impostor();
+
+    Impostor(const Impostor&) = delete;
+    Impostor& operator=(const Impostor&) = delete;
+
+    // Render nit. VAO modela mora imati pozicije na lokaciji 0 i normale na lokaciji 2.
+    void build(GLuint bakeProgram, GLuint modelVAO, int first, int count, const Bounds& modelBounds);
+    bool isBuilt() const { return atlas != 0; }
+
+    // Instance se skupljaju tokom frejma na glavnoj niti, a takeInstances ih kopira u arenu frejma
+    // (render nit crta kopiju, pa igra vec moze da skuplja instance sledeceg frejma u isti niz)
+    void addInstance(const glm::mat4& model);
+    int instanceCount() const { return (int)instances.size(); }
+    ArenaArray<glm::vec4> takeInstances(LinearArena& arena);
+
+    // Program mora biti aktivan, sa postavljenim uV, uP, uViewPos, color i uAlpha. Atlas se vezuje na jedinicu 0.
+    void draw(GLuint program, const glm::vec4* frameInstances, int count);
+    // Instance koje je vec upisao GPU (GpuCuller), u istom formatu: od offset-a count instanci,
+    // ili broj i pocetak iz DrawArraysIndirectCommand-a na commandOffset u indirectBuffer-u
+    void draw(GLuint program, GLuint instanceBuffer, GLintptr offset, int count);
+    void drawIndirect(GLuint program, GLuint instanceBuffer, GLuint indirectBuffer, GLintptr commandOffset);
+
+    void release();
+
+private:
+    void setupProgram(GLuint program);
+    void bindInstances(GLuint buffer, GLintptr offset);
+
+    Bounds bounds;
+    GLuint atlas;
+    GLuint vao;
+    GLuint quadVBO;
+    GLuint instanceVBO;
+    size_t instanceCapacity;
+    std::vector<glm::vec4> instances;
+};
@@ -0,0 +1,158 @@
+#include "InstanceRing.h"
+
+#include <cassert>
+#include <iostream>
+
+using namespace std;
+using namespace glm;
+
+InstanceRing::InstanceRing()
+    : buffer(0), texture(0), mapped(NULL), persistent(false), capacity(0), maxDraws(0), frameIndex(0), cursor(0)
+{
+    for (int i = 0; i < FRAME_COUNT; ++i) {
+        fences[i] = 0;
+    }
+}
+
+void InstanceRing::init(int drawsPerFrame)
+{
+    GLint maxTexels = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+    persistent = GLEW_ARB_buffer_storage != 0;
+    maxDraws = maxTexels / TEXELS_PER_DRAW / (persistent ? FRAME_COUNT : 1);
+    capacity = std::min(drawsPerFrame, maxDraws);
+
+    glGenTextures(1, &texture);
+    createBuffer();
+}
+
+void InstanceRing::createBuffer()
+{
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+
+    if (persistent) {
+        GLsizeiptr bytes = (GLsizeiptr)capacity * FRAME_COUNT * sizeof(DrawData);
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_TEXTURE_BUFFER, bytes, NULL, flags);
+        mapped = (DrawData*)glMapBufferRange(GL_TEXTURE_BUFFER, 0, bytes, flags);
+        persistent = mapped != NULL;
+    }
+    if (!persistent) {
+        glBufferData(GL_TEXTURE_BUFFER, (GLsizeiptr)capacity * sizeof(DrawData), NULL, GL_STREAM_DRAW);
+        staging.resize(capacity);
+    }
+
+    glBindTexture(GL_TEXTURE_BUFFER, texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, buffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void InstanceRing::destroyBuffer()
+{
+    for (int i = 0; i < FRAME_COUNT; ++i) {
+        if (fences[i] != 0) {
+            glClientWaitSync(fences[i], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+            glDeleteSync(fences[i]);
+            fences[i] = 0;
+        }
+    }
+    if (buffer != 0) {
+        if (mapped != NULL) {
+            glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+            glUnmapBuffer(GL_TEXTURE_BUFFER);
+            glBindBuffer(GL_TEXTURE_BUFFER, 0);
+            mapped = NULL;
+        }
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+    }
+}
+
+void InstanceRing::beginFrame(int drawCount)
+{
+    if (drawCount > capacity && capacity < maxDraws) {
+        // Retko (npr. teren se prvi put pojavi): bafer nepromenljive velicine mora da se napravi iznova
+        capacity = std::min(std::max(drawCount, capacity * 2), maxDraws);
+        destroyBuffer();
+        createBuffer();
+    }
+    if (drawCount > capacity) {
+        cout << "InstanceRing: frejm ima " << drawCount << " crtanja, a bafer prima " << capacity << " - salje se u delovima\n";
+    }
+
+    frameIndex = (frameIndex + 1) % FRAME_COUNT;
+    cursor = 0;
+
+    // GPU jos cita ovaj deo iz frejma pre FRAME_COUNT frejmova (retko, samo kad je GPU dosta iza)
+    if (persistent && fences[frameIndex] != 0) {
+        glClientWaitSync(fences[frameIndex], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        glDeleteSync(fences[frameIndex]);
+        fences[frameIndex] = 0;
+    }
+}
+
+InstanceRing::DrawData* InstanceRing::allocate(int count, int& firstDraw, int& granted)
+{
+    if (cursor >= capacity && persistent) {
+        // Deo frejma je pun (samo preko maxDraws): GPU mora da zavrsi crtanja koja ga citaju pre ponovnog upisa
+        GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        glDeleteSync(fence);
+        cursor = 0;
+    }
+    granted = std::min(count, capacity - cursor);
+
+    DrawData* data;
+    if (persistent) {
+        firstDraw = frameIndex * capacity + cursor;
+        data = mapped + firstDraw;
+    }
+    else {
+        firstDraw = cursor;
+        data = staging.data() + cursor;
+    }
+    assert(granted > 0 && firstDraw + granted <= drawIndexCount());
+    cursor += granted;
+    return data;
+}
+
+void InstanceRing::commit()
+{
+    if (persistent) {
+        return; // Koherentno mapiranje - upisi su vidljivi GPU-u bez slanja
+    }
+    if (cursor > 0) {
+        glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+        glBufferData(GL_TEXTURE_BUFFER, (GLsizeiptr)capacity * sizeof(DrawData), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, (GLsizeiptr)cursor * sizeof(DrawData), staging.data());
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+    // Novi CommandBuffer pocinje od nule (prethodna crtanja koriste "osiroceni" bafer)
+    cursor = 0;
+}
+
+void InstanceRing::endFrame()
+{
+    if (persistent) {
+        fences[frameIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+}
+
+void InstanceRing::bind(GLuint unit) const
+{
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_BUFFER, texture);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void InstanceRing::release()
+{
+    destroyBuffer();
+    if (texture != 0) {
+        glDeleteTextures(1, &texture);
+        texture = 0;
+    }
+    staging.clear();
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// Podaci po crtanju (model matrica, boja, providnost, pomeraj) za ceo frejm u jednom baferu, koji shaderi
+// citaju kao samplerBuffer uDrawData po indeksu uDrawId - crtanje je memcpy u bafer i jedna uniforma.
+// Sa ARB_buffer_storage bafer je trajno mapiran (persistent + coherent) i podeljen na FRAME_COUNT delova:
+// frejm pise u svoj deo, a fence na kraju frejma govori kad GPU vise ne cita taj deo.
+// Bez njega se podaci skupljaju u RAM-u i salju jednim glBufferData(NULL) + glBufferSubData po
+// CommandBuffer-u (orphaning), pa indeksi krecu od nule za svaki CommandBuffer.
+// Frejm sa vise crtanja nego sto bafer prima (GL_MAX_TEXTURE_BUFFER_SIZE) Renderer salje u delovima.
+class InstanceRing
+{
+public:
+    static const int TEXELS_PER_DRAW = 6;   // 4 kolone matrice, boja + alfa, pomeraj + materijal
+    static const int FRAME_COUNT = 3;
+
+    struct DrawData {
+        glm::mat4 model;
+        glm::vec4 colorAlpha;
+        glm::vec4 translation;      // xy = pomeraj, z = indeks materijala (MaterialTable)
+    };
+
+    InstanceRing();
+
+    InstanceRing(const InstanceRing&) = delete;
+    InstanceRing& operator=(const InstanceRing&) = delete;
+
+    // Render nit
+    void init(int drawsPerFrame);
+    bool isPersistent() const { return persistent; }
+    int drawCapacity() const { return capacity; }
+    // Broj razlicitih indeksa crtanja (svi delovi prstena)
+    int drawIndexCount() const { return persistent ? capacity * FRAME_COUNT : capacity; }
+
+    // drawCount = sva crtanja frejma (bafer se povecava ako ne staju)
+    void beginFrame(int drawCount);
+    // Mesto za najvise count crtanja; granted je koliko ih je stvarno dobijeno (do kraja dela prstena),
+    // a firstDraw je indeks prvog za uDrawId. Ostatak ide u sledecem pozivu, posle commit().
+    DrawData* allocate(int count, int& firstDraw, int& granted);
+    // Bez trajnog mapiranja salje skupljene podatke GPU-u (pre crtanja koja ih koriste)
+    void commit();
+    void endFrame();
+
+    void bind(GLuint unit) const;
+
+    void release();
+
+private:
+    void createBuffer();
+    void destroyBuffer();
+
+    GLuint buffer;
+    GLuint texture;
+    DrawData* mapped;
+    bool persistent;
+    int capacity;           // crtanja po delu prstena
+    int maxDraws;           // GL_MAX_TEXTURE_BUFFER_SIZE / TEXELS_PER_DRAW
+    int frameIndex;
+    int cursor;             // sledece slobodno crtanje u delu frejma
+    GLsync fences[FRAME_COUNT];
+    std::vector<DrawData> staging;
+};
@@ -0,0 +1,116 @@
+#include "MappedFile.h"
+
+#include <cstdio>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+    : bytes(nullptr), length(0), opened(false), mapped(false)
+#ifdef _WIN32
+    , fileHandle(INVALID_HANDLE_VALUE), mappingHandle(NULL)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+// Rezervni put: ceo fajl u bafer sa heap-a
+static const char* readWholeFile(const char* filePath, size_t& length)
+{
+    FILE* file = fopen(filePath, "rb");
+    if (file == NULL) {
+        return nullptr;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* buffer = new char[size > 0 ? size : 1];
+    length = size > 0 ? fread(buffer, 1, (size_t)size, file) : 0;
+    fclose(file);
+    return buffer;
+}
+
+bool MappedFile::open(const char* filePath)
+{
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        const void* view = mapping != NULL ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+        if (view != NULL) {
+            fileHandle = file;
+            mappingHandle = mapping;
+            bytes = static_cast<const char*>(view);
+            length = (size_t)fileSize.QuadPart;
+            mapped = true;
+            opened = true;
+            return true;
+        }
+        if (mapping != NULL) {
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file);
+#else
+    int file = ::open(filePath, O_RDONLY);
+    if (file < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(file, &info) == 0 && info.st_size > 0) {
+        void* view = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        if (view != MAP_FAILED) {
+            madvise(view, (size_t)info.st_size, MADV_SEQUENTIAL);
+            ::close(file);  // mapiranje ostaje vazece i bez deskriptora
+            bytes = static_cast<const char*>(view);
+            length = (size_t)info.st_size;
+            mapped = true;
+            opened = true;
+            return true;
+        }
+    }
+    ::close(file);
+#endif
+    bytes = readWholeFile(filePath, length);
+    opened = bytes != nullptr;
+    return opened;
+}
+
+void MappedFile::close()
+{
+    if (mapped) {
+#ifdef _WIN32
+        UnmapViewOfFile(bytes);
+        CloseHandle(static_cast<HANDLE>(mappingHandle));
+        CloseHandle(static_cast<HANDLE>(fileHandle));
+        fileHandle = INVALID_HANDLE_VALUE;
+        mappingHandle = NULL;
+#else
+        munmap(const_cast<char*>(bytes), length);
+#endif
+    }
+    else {
+        delete[] bytes;
+    }
+    bytes = nullptr;
+    length = 0;
+    opened = false;
+    mapped = false;
+}
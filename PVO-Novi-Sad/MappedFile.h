@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+
+// Fajl mapiran u memoriju samo za citanje (MapViewOfFile na Windows-u, mmap inace). Ako mapiranje
+// ne uspe (npr. prazan fajl), sadrzaj se ucita u obican bafer, pa korisnik uvek dobija data()/size().
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const char* filePath);
+    void close();
+
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+    bool isOpen() const { return opened; }
+
+private:
+    const char* bytes;
+    size_t length;
+    bool opened;
+    bool mapped;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#endif
+};
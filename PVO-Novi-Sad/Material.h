@@ -0,0 +1,34 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <string>
+
+// Materijal iz .mtl fajla (Wavefront); u shaderima je to struktura Material iz uMaterials (MaterialTable)
+struct ModelMaterial {
+    std::string name;
+    glm::vec3 ambient;      // Ka
+    glm::vec3 diffuse;      // Kd
+    glm::vec3 specular;     // Ks
+    glm::vec3 emissive;     // Ke
+    float shininess;        // Ns
+    float opacity;          // d (ili 1 - Tr)
+    std::string diffuseMap; // map_Kd, putanja relativna u odnosu na .mtl
+
+    // Povrsina sa teksturom iz atlasa (nema ih u .mtl, postavlja ih igra, npr. za planinu)
+    float textureScale;     // 0: UV koordinate mreze; > 0: triplanarno, ponavljanja po jedinici sveta
+    float detailScale;      // detalj je ista slika toliko puta gusca (0 bez detalja)
+    float detailStrength;   // 0..1
+    float detailDistance;   // udaljenost na kojoj mipmapa detalja grubi za jedan nivo
+
+    ModelMaterial()
+        : ambient(1.0f), diffuse(0.5f), specular(0.7f), emissive(0.0f), shininess(132.0f), opacity(1.0f),
+          textureScale(0.0f), detailScale(0.0f), detailStrength(0.0f), detailDistance(1.0f) {}
+};
+
+// Opseg temena modela koji se crta jednim materijalom
+struct SubMesh {
+    int first;
+    int count;
+    int material;           // indeks u ModelData::materials
+};
@@ -0,0 +1,71 @@
+#include "MaterialTable.h"
+
+using namespace std;
+using namespace glm;
+
+MaterialTable::MaterialTable()
+    : buffer(0), texture(0), dirty(false)
+{
+}
+
+void MaterialTable::init()
+{
+    // Bafer mora da postoji (prvo vezivanje) pre glTexBuffer; sadrzaj stize u bind()
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_BUFFER, texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, buffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    ModelMaterial defaultMaterial;
+    defaultMaterial.name = "default";
+    add(&defaultMaterial, 1);
+}
+
+int MaterialTable::add(const ModelMaterial* materials, int count)
+{
+    int first = materialCount();
+    for (int i = 0; i < count; ++i) {
+        const ModelMaterial& material = materials[i];
+        texels.push_back(vec4(material.ambient, material.shininess));
+        texels.push_back(vec4(material.diffuse, material.opacity));
+        texels.push_back(vec4(material.specular, -1.0f));
+        texels.push_back(vec4(material.emissive, 0.0f));
+        texels.push_back(vec4(0.0f, 0.0f, 1.0f, 1.0f));
+        texels.push_back(vec4(material.textureScale, material.detailScale, material.detailStrength, material.detailDistance));
+    }
+    dirty = dirty || count > 0;
+    return first;
+}
+
+void MaterialTable::setTexture(int material, int layer, const vec4& rect)
+{
+    size_t base = (size_t)material * TEXELS_PER_MATERIAL;
+    texels[base + 2].w = (float)layer;
+    texels[base + 4] = rect;
+    dirty = true;
+}
+
+void MaterialTable::bind(GLuint unit)
+{
+    if (dirty) {
+        // Retko (kad stigne novi model), pa se cela tabela salje iznova
+        glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+        glBufferData(GL_TEXTURE_BUFFER, (GLsizeiptr)(texels.size() * sizeof(vec4)), texels.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        dirty = false;
+    }
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_BUFFER, texture);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void MaterialTable::release()
+{
+    glDeleteBuffers(1, &buffer);
+    glDeleteTextures(1, &texture);
+    buffer = texture = 0;
+    texels.clear();
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "Material.h"
+
+// Svi materijali scene u jednom texture buffer-u koji shaderi citaju kao samplerBuffer uMaterials po
+// indeksu materijala (iz podataka crtanja InstanceRing-a ili uniforme uMaterialId). Crtanja modela sa vise
+// materijala se zato razlikuju samo po podacima crtanja i idu istim multi-draw pozivom.
+// Materijal 0 je podrazumevani (nekadasnji globalni uMaterial), za sve sto nema .mtl.
+// Tekstura materijala je sloj i pravougaonik u TextureAtlas-u (setTexture), pa se teksturisana geometrija
+// crta bez promene vezane teksture. Samo render nit; tabela samo raste, pa indeksi ostaju vazeci.
+class MaterialTable
+{
+public:
+    // kA + shine, kD + providnost (d), kS + sloj atlasa (-1 bez teksture), kE, UV pravougaonik u sloju,
+    // povrsina (razmera triplanarne projekcije, razmera, jacina i udaljenost detalja)
+    static const int TEXELS_PER_MATERIAL = 6;
+
+    MaterialTable();
+
+    MaterialTable(const MaterialTable&) = delete;
+    MaterialTable& operator=(const MaterialTable&) = delete;
+
+    void init();
+    // Vraca indeks prvog dodatog materijala
+    int add(const ModelMaterial* materials, int count);
+    // rect = (u0, v0, sirina, visina) u sloju atlasa
+    void setTexture(int material, int layer, const glm::vec4& rect);
+    int materialCount() const { return (int)(texels.size() / TEXELS_PER_MATERIAL); }
+
+    // Salje izmene (ako ih ima) i vezuje tabelu na jedinicu
+    void bind(GLuint unit);
+    void release();
+
+private:
+    GLuint buffer;
+    GLuint texture;
+    std::vector<glm::vec4> texels;
+    bool dirty;
+};
@@ -0,0 +1,489 @@
+#include "MeshLod.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <queue>
+#include <unordered_map>
+
+using namespace std;
+using namespace glm;
+
+// Najmanji poluprecnik na ekranu (px) za koji se jos koristi nivo i (nivo 0 je pun model)
+static const float LOD_SCREEN_RADIUS[] = { 120.0f, 60.0f, 25.0f };
+static const int LOD_THRESHOLD_COUNT = sizeof(LOD_SCREEN_RADIUS) / sizeof(LOD_SCREEN_RADIUS[0]);
+static const float LOD_HYSTERESIS = 0.15f;
+
+// Ispod ovog poluprecnika na ekranu (px) model se crta kao impostor
+static const float IMPOSTOR_SCREEN_RADIUS = 12.0f;
+
+// Ivice otvorene mreze dobijaju ravan normalnu na trougao sa ovom tezinom, da bi se granica zadrzala
+static const double BOUNDARY_WEIGHT = 100.0;
+
+// Sazimanje se odbija ako bi se neki trougao okrenuo vise od ovoga (kosinus ugla izmedju normala)
+static const float MIN_NORMAL_DOT = 0.2f;
+
+namespace {
+
+// Simetricna 4x4 matrica kvadratne greske (10 koeficijenata)
+struct Quadric {
+    double a[10];
+
+    Quadric() { memset(a, 0, sizeof(a)); }
+
+    // Ravan nx + d = 0 sa tezinom
+    Quadric(const dvec3& n, double d, double weight)
+    {
+        a[0] = n.x * n.x; a[1] = n.x * n.y; a[2] = n.x * n.z; a[3] = n.x * d;
+        a[4] = n.y * n.y; a[5] = n.y * n.z; a[6] = n.y * d;
+        a[7] = n.z * n.z; a[8] = n.z * d;
+        a[9] = d * d;
+        for (int i = 0; i < 10; ++i) {
+            a[i] *= weight;
+        }
+    }
+
+    Quadric& operator+=(const Quadric& other)
+    {
+        for (int i = 0; i < 10; ++i) {
+            a[i] += other.a[i];
+        }
+        return *this;
+    }
+
+    double evaluate(const vec3& p) const
+    {
+        double x = p.x, y = p.y, z = p.z;
+        return a[0] * x * x + 2.0 * a[1] * x * y + 2.0 * a[2] * x * z + 2.0 * a[3] * x
+            + a[4] * y * y + 2.0 * a[5] * y * z + 2.0 * a[6] * y
+            + a[7] * z * z + 2.0 * a[8] * z
+            + a[9];
+    }
+};
+
+struct Collapse {
+    double cost;
+    int from;
+    int to;
+    int fromVersion;
+    int toVersion;
+
+    bool operator>(const Collapse& other) const { return cost > other.cost; }
+};
+
+// Jedno teme posle spajanja istih temena iz triangle soup-a
+struct Vertex {
+    vec3 position;
+    vec2 textureCoord;
+    vec3 normal;
+};
+
+struct VertexKey {
+    float values[5];
+
+    bool operator==(const VertexKey& other) const { return memcmp(values, other.values, sizeof(values)) == 0; }
+};
+
+struct VertexKeyHash {
+    size_t operator()(const VertexKey& key) const
+    {
+        size_t hash = 2166136261u;
+        const unsigned char* bytes = (const unsigned char*)key.values;
+        for (size_t i = 0; i < sizeof(key.values); ++i) {
+            hash = (hash ^ bytes[i]) * 16777619u;
+        }
+        return hash;
+    }
+};
+
+struct PositionHash {
+    size_t operator()(const vec3& p) const
+    {
+        size_t hash = 2166136261u;
+        const unsigned char* bytes = (const unsigned char*)&p;
+        for (size_t i = 0; i < sizeof(vec3); ++i) {
+            hash = (hash ^ bytes[i]) * 16777619u;
+        }
+        return hash;
+    }
+};
+
+class Simplifier
+{
+public:
+    Simplifier(const float* soup, int soupVertexCount)
+        : flatNormals(false)
+    {
+        weld(soup, soupVertexCount);
+        computeQuadrics();
+        for (int v = 0; v < (int)vertices.size(); ++v) {
+            pushVertexEdges(v);
+        }
+    }
+
+    int triangleCount() const { return liveTriangles; }
+
+    void simplify(int targetTriangles)
+    {
+        while (liveTriangles > targetTriangles && !heap.empty()) {
+            Collapse collapse = heap.top();
+            heap.pop();
+            if (removed[collapse.from] || removed[collapse.to]
+                || versions[collapse.from] != collapse.fromVersion || versions[collapse.to] != collapse.toVersion) {
+                continue;   // zastareo zapis
+            }
+            if (!canCollapse(collapse.from, collapse.to)) {
+                continue;
+            }
+            performCollapse(collapse.from, collapse.to);
+        }
+    }
+
+    // Nadovezuje trenutnu mrezu na out (MESH_VERTEX_FLOATS po temenu)
+    void extract(vector<float>& out) const
+    {
+        for (size_t t = 0; t < triangles.size(); t += 3) {
+            if (triangles[t] < 0) {
+                continue;
+            }
+            // Model sa ostrim ivicama dobija normale novih trouglova
+            const Vertex* corners[3] = { &vertices[triangles[t]], &vertices[triangles[t + 1]], &vertices[triangles[t + 2]] };
+            vec3 faceNormal = normalize(cross(corners[1]->position - corners[0]->position, corners[2]->position - corners[0]->position));
+            for (int k = 0; k < 3; ++k) {
+                const vec3& normal = flatNormals ? faceNormal : corners[k]->normal;
+                float vertex[MESH_VERTEX_FLOATS] = {
+                    corners[k]->position.x, corners[k]->position.y, corners[k]->position.z,
+                    corners[k]->textureCoord.x, corners[k]->textureCoord.y,
+                    normal.x, normal.y, normal.z
+                };
+                out.insert(out.end(), vertex, vertex + MESH_VERTEX_FLOATS);
+            }
+        }
+    }
+
+private:
+    void weld(const float* soup, int soupVertexCount)
+    {
+        unordered_map<VertexKey, int, VertexKeyHash> indexOf;
+        unordered_map<vec3, int, PositionHash> positionUses;
+        triangles.resize(soupVertexCount / 3 * 3);
+        for (size_t i = 0; i < triangles.size(); ++i) {
+            const float* source = soup + i * MESH_VERTEX_FLOATS;
+            Vertex vertex;
+            vertex.position = vec3(source[0], source[1], source[2]);
+            vertex.textureCoord = vec2(source[3], source[4]);
+            vertex.normal = vec3(source[5], source[6], source[7]);
+
+            // Normala nije deo kljuca: modeli sa normalom po trouglu (Cloud.obj) bi inace bili skup nepovezanih trouglova
+            VertexKey key;
+            memcpy(key.values, &vertex.position, sizeof(vec3));
+            memcpy(key.values + 3, &vertex.textureCoord, sizeof(vec2));
+
+            unordered_map<VertexKey, int, VertexKeyHash>::iterator found = indexOf.find(key);
+            if (found == indexOf.end()) {
+                found = indexOf.insert(make_pair(key, (int)vertices.size())).first;
+                vertices.push_back(vertex);
+                positionUses[vertex.position]++;
+            }
+            else {
+                Vertex& existing = vertices[found->second];
+                if (dot(existing.normal, vertex.normal) < 0.99f * length(existing.normal) * length(vertex.normal)) {
+                    flatNormals = true;
+                }
+                existing.normal += vertex.normal;
+            }
+            triangles[i] = found->second;
+        }
+
+        for (size_t v = 0; v < vertices.size(); ++v) {
+            float normalLength = length(vertices[v].normal);
+            if (normalLength > 0.0f) {
+                vertices[v].normal /= normalLength;
+            }
+        }
+
+        liveTriangles = (int)triangles.size() / 3;
+        removed.assign(vertices.size(), false);
+        versions.assign(vertices.size(), 0);
+        quadrics.assign(vertices.size(), Quadric());
+        vertexTriangles.resize(vertices.size());
+
+        // Teme na savu (ista pozicija, razlicit UV/normala) se ne pomera - inace bi se sav otvorio
+        locked.assign(vertices.size(), false);
+        for (size_t v = 0; v < vertices.size(); ++v) {
+            locked[v] = positionUses[vertices[v].position] > 1;
+        }
+
+        for (size_t t = 0; t < triangles.size(); t += 3) {
+            if (triangles[t] == triangles[t + 1] || triangles[t + 1] == triangles[t + 2] || triangles[t] == triangles[t + 2]) {
+                triangles[t] = triangles[t + 1] = triangles[t + 2] = -1;
+                liveTriangles--;
+                continue;
+            }
+            for (int k = 0; k < 3; ++k) {
+                vertexTriangles[triangles[t + k]].push_back((int)t / 3);
+            }
+        }
+    }
+
+    void computeQuadrics()
+    {
+        unordered_map<uint64_t, int> edgeUses;
+        for (size_t t = 0; t < triangles.size(); t += 3) {
+            if (triangles[t] < 0) {
+                continue;
+            }
+            dvec3 p0 = dvec3(vertices[triangles[t]].position);
+            dvec3 p1 = dvec3(vertices[triangles[t + 1]].position);
+            dvec3 p2 = dvec3(vertices[triangles[t + 2]].position);
+            dvec3 n = cross(p1 - p0, p2 - p0);
+            double area = length(n);
+            if (area <= 0.0) {
+                continue;
+            }
+            n /= area;
+            Quadric plane(n, -dot(n, p0), area * 0.5);
+            for (int k = 0; k < 3; ++k) {
+                quadrics[triangles[t + k]] += plane;
+                edgeUses[edgeKey(triangles[t + k], triangles[t + (k + 1) % 3])]++;
+            }
+        }
+
+        // Ivice sa samo jednim trouglom su granica mreze
+        for (size_t t = 0; t < triangles.size(); t += 3) {
+            if (triangles[t] < 0) {
+                continue;
+            }
+            dvec3 p0 = dvec3(vertices[triangles[t]].position);
+            dvec3 n = cross(dvec3(vertices[triangles[t + 1]].position) - p0, dvec3(vertices[triangles[t + 2]].position) - p0);
+            for (int k = 0; k < 3; ++k) {
+                int a = triangles[t + k];
+                int b = triangles[t + (k + 1) % 3];
+                if (edgeUses[edgeKey(a, b)] != 1) {
+                    continue;
+                }
+                dvec3 pa = dvec3(vertices[a].position);
+                dvec3 edge = dvec3(vertices[b].position) - pa;
+                dvec3 side = cross(edge, n);
+                double sideLength = length(side);
+                if (sideLength <= 0.0) {
+                    continue;
+                }
+                side /= sideLength;
+                Quadric boundary(side, -dot(side, pa), BOUNDARY_WEIGHT * dot(edge, edge));
+                quadrics[a] += boundary;
+                quadrics[b] += boundary;
+            }
+        }
+    }
+
+    static uint64_t edgeKey(int a, int b)
+    {
+        if (a > b) {
+            swap(a, b);
+        }
+        return ((uint64_t)a << 32) | (uint32_t)b;
+    }
+
+    double collapseCost(int from, int to) const
+    {
+        Quadric sum = quadrics[from];
+        sum += quadrics[to];
+        return sum.evaluate(vertices[to].position);
+    }
+
+    void pushEdge(int a, int b)
+    {
+        // Sazima se u jeftiniji smer; zakljucano teme se ne pomera
+        bool aMovable = !locked[a];
+        bool bMovable = !locked[b];
+        if (!aMovable && !bMovable) {
+            return;
+        }
+        double costAB = aMovable ? collapseCost(a, b) : HUGE_VAL;
+        double costBA = bMovable ? collapseCost(b, a) : HUGE_VAL;
+        Collapse collapse;
+        if (costAB <= costBA) {
+            collapse.cost = costAB;
+            collapse.from = a;
+            collapse.to = b;
+        }
+        else {
+            collapse.cost = costBA;
+            collapse.from = b;
+            collapse.to = a;
+        }
+        collapse.fromVersion = versions[collapse.from];
+        collapse.toVersion = versions[collapse.to];
+        heap.push(collapse);
+    }
+
+    void pushVertexEdges(int v)
+    {
+        for (size_t i = 0; i < vertexTriangles[v].size(); ++i) {
+            int t = vertexTriangles[v][i] * 3;
+            for (int k = 0; k < 3; ++k) {
+                int other = triangles[t + k];
+                // Svaka ivica jednom po trouglu: samo sledece teme u redosledu
+                if (other == v) {
+                    pushEdge(v, triangles[t + (k + 1) % 3]);
+                }
+            }
+        }
+    }
+
+    bool canCollapse(int from, int to) const
+    {
+        const vec3& target = vertices[to].position;
+        for (size_t i = 0; i < vertexTriangles[from].size(); ++i) {
+            int t = vertexTriangles[from][i] * 3;
+            int a = triangles[t];
+            int b = triangles[t + 1];
+            int c = triangles[t + 2];
+            if (a == to || b == to || c == to) {
+                continue;   // ovaj trougao nestaje
+            }
+            vec3 p[3] = { vertices[a].position, vertices[b].position, vertices[c].position };
+            vec3 before = cross(p[1] - p[0], p[2] - p[0]);
+            for (int k = 0; k < 3; ++k) {
+                if (triangles[t + k] == from) {
+                    p[k] = target;
+                }
+            }
+            vec3 after = cross(p[1] - p[0], p[2] - p[0]);
+            float beforeLength = length(before);
+            float afterLength = length(after);
+            if (afterLength <= 0.0f || beforeLength <= 0.0f || dot(before, after) < MIN_NORMAL_DOT * beforeLength * afterLength) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void performCollapse(int from, int to)
+    {
+        vector<int>& fromTriangles = vertexTriangles[from];
+        for (size_t i = 0; i < fromTriangles.size(); ++i) {
+            int t = fromTriangles[i] * 3;
+            if (triangles[t] == to || triangles[t + 1] == to || triangles[t + 2] == to) {
+                // Trougao nad ivicom nestaje - sklanja se iz lista ostalih temena
+                for (int k = 0; k < 3; ++k) {
+                    int v = triangles[t + k];
+                    if (v != from) {
+                        vector<int>& list = vertexTriangles[v];
+                        list.erase(std::remove(list.begin(), list.end(), t / 3), list.end());
+                    }
+                }
+                triangles[t] = triangles[t + 1] = triangles[t + 2] = -1;
+                liveTriangles--;
+            }
+            else {
+                for (int k = 0; k < 3; ++k) {
+                    if (triangles[t + k] == from) {
+                        triangles[t + k] = to;
+                    }
+                }
+                vertexTriangles[to].push_back(t / 3);
+            }
+        }
+        fromTriangles.clear();
+
+        removed[from] = true;
+        quadrics[to] += quadrics[from];
+        versions[to]++;
+
+        // Cene ivica oko preostalog temena su se promenile
+        for (size_t i = 0; i < vertexTriangles[to].size(); ++i) {
+            int t = vertexTriangles[to][i] * 3;
+            for (int k = 0; k < 3; ++k) {
+                int v = triangles[t + k];
+                if (v != to) {
+                    versions[v]++;
+                }
+            }
+        }
+        for (size_t i = 0; i < vertexTriangles[to].size(); ++i) {
+            int t = vertexTriangles[to][i] * 3;
+            for (int k = 0; k < 3; ++k) {
+                pushEdge(triangles[t + k], triangles[t + (k + 1) % 3]);
+            }
+        }
+    }
+
+    bool flatNormals;
+    vector<Vertex> vertices;
+    vector<int> triangles;          // 3 indeksa po trouglu, -1 za uklonjen trougao
+    vector<vector<int>> vertexTriangles;
+    vector<Quadric> quadrics;
+    vector<bool> removed;
+    vector<bool> locked;
+    vector<int> versions;
+    int liveTriangles;
+    priority_queue<Collapse, vector<Collapse>, greater<Collapse>> heap;
+};
+
+}
+
+vector<MeshLod> appendLodChain(vector<float>& vertices, const float* ratios, int ratioCount)
+{
+    vector<MeshLod> chain;
+    int vertexCount = (int)(vertices.size() / MESH_VERTEX_FLOATS);
+    if (vertexCount < 3) {
+        return chain;
+    }
+
+    // Simplifier pravi svoju kopiju temena, pa se niz sme prosirivati tokom nadovezivanja
+    Simplifier simplifier(vertices.data(), vertexCount);
+    int originalTriangles = vertexCount / 3;
+    for (int i = 0; i < ratioCount; ++i) {
+        int target = std::max((int)(originalTriangles * ratios[i]), 1);
+        simplifier.simplify(target);
+
+        // Ako se mreza vise ne moze uprostiti, nema svrhe praviti isti nivo ponovo
+        if (!chain.empty() && chain.back().count / 3 == simplifier.triangleCount()) {
+            break;
+        }
+        MeshLod lod;
+        lod.first = (int)(vertices.size() / MESH_VERTEX_FLOATS);
+        simplifier.extract(vertices);
+        lod.count = (int)(vertices.size() / MESH_VERTEX_FLOATS) - lod.first;
+        chain.push_back(lod);
+    }
+    return chain;
+}
+
+int selectLod(float screenRadius, int currentLod, int lodCount)
+{
+    int lod = 0;
+    while (lod < LOD_THRESHOLD_COUNT && lod < lodCount - 1) {
+        // Granica je pomerena u korist trenutnog nivoa
+        float threshold = LOD_SCREEN_RADIUS[lod];
+        threshold *= lod < currentLod ? 1.0f + LOD_HYSTERESIS : 1.0f - LOD_HYSTERESIS;
+        if (screenRadius >= threshold) {
+            break;
+        }
+        lod++;
+    }
+    return lod;
+}
+
+bool selectImpostor(float screenRadius, bool currentlyImpostor)
+{
+    float threshold = IMPOSTOR_SCREEN_RADIUS * (currentlyImpostor ? 1.0f + LOD_HYSTERESIS : 1.0f - LOD_HYSTERESIS);
+    return screenRadius < threshold;
+}
+
+int lodThresholds(float* screenRadii, int maxCount)
+{
+    int count = std::min(LOD_THRESHOLD_COUNT, maxCount);
+    for (int i = 0; i < count; ++i) {
+        screenRadii[i] = LOD_SCREEN_RADIUS[i];
+    }
+    return count;
+}
+
+float impostorThreshold()
+{
+    return IMPOSTOR_SCREEN_RADIUS;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// Nivoi detalja (LOD) za modele.
+// Jednostavnije verzije modela prave se pri ucitavanju uproscavanjem mreze po kvadratnoj gresci
+// (Garland-Heckbert QEM): ivica cije sazimanje najmanje menja povrsinu se sazima u jedno od svojih temena.
+// Temena na UV savovima i ivicama otvorene mreze se cuvaju, pa se uproscena mreza ne cepa.
+// Svi nivoi su triangle soup kao i originalni model, pa se nadovezuju u isti VBO i crtaju sa glDrawArrays.
+
+// Teme modela u jednom nizu, isti raspored kao arena Renderer-a: pozicija (3), UV (2), normala (3)
+const int MESH_VERTEX_FLOATS = 8;
+
+// Deo bafera modela sa jednim nivoom detalja
+struct MeshLod {
+    int first;
+    int count;
+};
+
+// Iz triangle soup-a (MESH_VERTEX_FLOATS po temenu) pravi sve jednostavnije verzije i nadovezuje ih iza
+// originala u isti niz (pozivalac moze unapred da rezervise mesto). ratios su udeli originalnog broja
+// trouglova u opadajucem redosledu (npr. 0.5, 0.25, 0.1) - svaki nivo nastavlja uproscavanje prethodnog.
+// Vraca deo niza za svaki nadovezani nivo.
+std::vector<MeshLod> appendLodChain(std::vector<float>& vertices, const float* ratios, int ratioCount);
+
+// Nivo za poluprecnik objekta na ekranu (u pikselima). Prelaz izmedju nivoa ima histerezu,
+// pa objekat na granici ne menja nivo svaki frejm.
+int selectLod(float screenRadius, int currentLod, int lodCount);
+
+// Da li se umesto mreze crta impostor (vidi Impostor.h) - takodje sa histerezom
+bool selectImpostor(float screenRadius, bool currentlyImpostor);
+
+// Granice bez histereze (za izbor nivoa na GPU-u, GpuCuller): upisuje do maxCount granica, vraca njihov broj
+int lodThresholds(float* screenRadii, int maxCount);
+float impostorThreshold();
@@ -0,0 +1,151 @@
+#include "MeshRegistry.h"
+
+#include "AssetLoader.h"
+#include "ModelLoader.h"
+#include "Profiler.h"
+#include "Renderer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <thread>
+
+using namespace std;
+
+MeshRegistry::MeshRegistry()
+    : tablePrinted(false)
+{
+}
+
+MeshRegistry::Id MeshRegistry::add(const char* name, MeshHandle mesh, const glm::vec3& fallbackColor)
+{
+    MeshAsset asset;
+    asset.name = name;
+    asset.mesh = mesh;
+    asset.vertexCount = 0;
+    asset.lodMaterial = 0;
+    asset.fallbackColor = fallbackColor;
+    asset.bounds = computeBounds(NULL, 0, MESH_VERTEX_FLOATS);
+    asset.loadCpuBytes = 0;
+    asset.cpuBytes = 0;
+    asset.gpuBytes = 0;
+    assets.push_back(asset);
+    return (Id)assets.size() - 1;
+}
+
+void MeshRegistry::loadAsync(Id id, AssetLoader& loader, Renderer& renderer, const char* filePath, bool buildLods)
+{
+    string path = filePath;
+    MeshAsset* asset = &assets[id];
+    // Modeli se parsiraju na svim radnim nitima istovremeno, pa svaki deli jezgra sa ostalima
+    int parseThreads = max((int)thread::hardware_concurrency() / loader.workerCount(), 1);
+    loader.submit([&loader, &renderer, path, asset, buildLods, parseThreads] {
+        // Radna nit: temena (i uproscene verzije) jednom upisana u konacni format
+        shared_ptr<ModelData> loaded = make_shared<ModelData>(loadModel(path.c_str(), buildLods, parseThreads));
+        if (!loaded->isLoaded()) {
+            return;
+        }
+
+        // Render nit: niz ide pravo u arenu temena i odmah se oslobadja, pa tek onda mreza postaje
+        // vidljiva igri
+        loader.queueUpload([&renderer, loaded, asset] {
+            renderer.uploadMeshVertices(asset->mesh, loaded->vertices.data(), loaded->vertexCount);
+            asset->loadCpuBytes = loaded->vertices.capacity() * sizeof(float);
+            vector<float>().swap(loaded->vertices);
+
+            // Indeksi materijala modela postaju indeksi u tabeli Renderer-a
+            if (loaded->materials.empty()) {
+                // Isti izgled kao nekadasnja boja crtanja uz podrazumevani materijal (kA 1.0, kD 0.5, kS 0.7)
+                ModelMaterial fallback;
+                fallback.name = asset->name;
+                fallback.ambient = fallback.ambient * asset->fallbackColor;
+                fallback.diffuse = 0.5f * asset->fallbackColor;
+                fallback.specular = 0.7f * asset->fallbackColor;
+                loaded->materials.push_back(fallback);
+                loaded->submeshes.clear();
+            }
+            if (loaded->submeshes.empty()) {
+                SubMesh whole = { 0, loaded->lods[0].count, 0 };
+                loaded->submeshes.push_back(whole);
+            }
+            int firstMaterial = renderer.addMaterials(loaded->materials.data(), (int)loaded->materials.size());
+            int largest = 0;
+            for (SubMesh& submesh : loaded->submeshes) {
+                submesh.material += firstMaterial;
+                if (submesh.count > largest) {
+                    largest = submesh.count;
+                    asset->lodMaterial = submesh.material;
+                }
+            }
+
+            asset->bounds = loaded->bounds;
+            asset->lods = move(loaded->lods);
+            asset->submeshes = move(loaded->submeshes);
+            asset->cpuBytes = asset->lods.capacity() * sizeof(MeshLod) + asset->submeshes.capacity() * sizeof(SubMesh);
+            asset->gpuBytes = (size_t)renderer.meshVertexCount(asset->mesh) * Renderer::ARENA_FLOATS * sizeof(float);
+            asset->vertexCount = loaded->vertexCount;
+        });
+    });
+}
+
+int MeshRegistry::loadedCount() const
+{
+    int count = 0;
+    for (size_t i = 0; i < assets.size(); ++i) {
+        count += assets[i].isLoaded() ? 1 : 0;
+    }
+    return count;
+}
+
+size_t MeshRegistry::totalCpuBytes() const
+{
+    size_t bytes = 0;
+    for (size_t i = 0; i < assets.size(); ++i) {
+        bytes += assets[i].cpuBytes;
+    }
+    return bytes;
+}
+
+size_t MeshRegistry::totalGpuBytes() const
+{
+    size_t bytes = 0;
+    for (size_t i = 0; i < assets.size(); ++i) {
+        bytes += assets[i].gpuBytes;
+    }
+    return bytes;
+}
+
+void MeshRegistry::report(Profiler& profiler)
+{
+    profiler.setCounter("mreze CPU kB", (int)(totalCpuBytes() / 1024));
+    profiler.setCounter("mreze GPU kB", (int)(totalGpuBytes() / 1024));
+
+    if (tablePrinted || assets.empty() || loadedCount() < (int)assets.size()) {
+        return;
+    }
+    tablePrinted = true;
+    printf("Mreze: %-12s %10s %14s %10s %10s\n", "model", "temena", "CPU ucit. kB", "CPU kB", "GPU kB");
+    for (size_t i = 0; i < assets.size(); ++i) {
+        const MeshAsset& asset = assets[i];
+        printf("       %-12s %10d %14.1f %10.1f %10.1f\n", asset.name.c_str(), asset.vertexCount,
+            asset.loadCpuBytes / 1024.0, asset.cpuBytes / 1024.0, asset.gpuBytes / 1024.0);
+    }
+}
+
+void drawMeshAsset(CommandBuffer& commands, const DrawCommand& draw, const MeshAsset& asset, int lodIndex)
+{
+    DrawCommand command = draw;
+    if (lodIndex == 0) {
+        for (const SubMesh& submesh : asset.submeshes) {
+            command.first = submesh.first;
+            command.count = submesh.count;
+            command.material = submesh.material;
+            commands.draw(command);
+        }
+        return;
+    }
+    command.first = asset.lods[lodIndex].first;
+    command.count = asset.lods[lodIndex].count;
+    command.material = asset.lodMaterial;
+    commands.draw(command);
+}
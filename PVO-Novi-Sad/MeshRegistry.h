@@ -0,0 +1,70 @@
+#pragma once
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "CommandBuffer.h"
+#include "Frustum.h"
+#include "Material.h"
+#include "MeshLod.h"
+
+class AssetLoader;
+class Profiler;
+class Renderer;
+
+// Mreza modela kakvu vidi igra: rucka, broj temena, granice i nivoi detalja. Temena postoje na CPU-u samo
+// izmedju parsiranja i upload-a, pa se prati i koliko je memorije mreza zauzimala pri ucitavanju.
+struct MeshAsset {
+    std::string name;
+    MeshHandle mesh;
+    int vertexCount;                // svi nivoi zajedno; 0 dok mreza ne stigne na GPU
+    Bounds bounds;                  // u prostoru modela
+    std::vector<MeshLod> lods;      // lods[0] je pun model, uproscene verzije su nadovezane iza njega
+    std::vector<SubMesh> submeshes; // opsezi lods[0] po materijalu; indeksi su u MaterialTable Renderer-a
+    int lodMaterial;                // uprosceni nivoi, impostori i GPU instance (materijal najveceg opsega)
+    glm::vec3 fallbackColor;        // za model bez materijala (nekadasnja boja crtanja)
+    size_t loadCpuBytes;            // niz temena od parsiranja do upload-a
+    size_t cpuBytes;                // ono sto ostaje na CPU-u (opis nivoa i opsega materijala)
+    size_t gpuBytes;                // opseg u areni temena Renderer-a
+
+    bool isLoaded() const { return vertexCount > 0; }
+};
+
+// Registar mreza modela. Ucitavanje ide kroz AssetLoader (parsiranje na radnoj niti, upload na render
+// niti); posle upload-a se CPU kopija temena odmah oslobadja, a materijali prelaze u MaterialTable.
+// Zapisi se menjaju samo u upload-u, dok igra ceka u sinhronom poslu, pa ih igra cita bez zakljucavanja.
+class MeshRegistry
+{
+public:
+    typedef int Id;
+
+    MeshRegistry();
+
+    MeshRegistry(const MeshRegistry&) = delete;
+    MeshRegistry& operator=(const MeshRegistry&) = delete;
+
+    // Prazna mreza (Renderer::createMesh) koja ce dobiti model; referenca na zapis ostaje vazeca.
+    // Materijali dolaze iz .mtl fajla, a fallbackColor vazi samo ako ih model nema.
+    Id add(const char* name, MeshHandle mesh, const glm::vec3& fallbackColor = glm::vec3(1.0f));
+    void loadAsync(Id id, AssetLoader& loader, Renderer& renderer, const char* filePath, bool buildLods = false);
+
+    const MeshAsset& asset(Id id) const { return assets[id]; }
+    int assetCount() const { return (int)assets.size(); }
+    int loadedCount() const;
+
+    size_t totalCpuBytes() const;
+    size_t totalGpuBytes() const;
+
+    // Ukupna memorija kao brojaci profilera, a kad stignu sve mreze, jednom i tabela po modelu na konzoli
+    void report(Profiler& profiler);
+
+private:
+    std::deque<MeshAsset> assets;
+    bool tablePrinted;
+};
+
+// Crtanje modela: pun model (lodIndex 0) po submesh opsezima, svaki sa svojim materijalom, a uprosceni
+// nivo jednim crtanjem sa lodMaterial. Materijal je u podacima crtanja, pa opsezi iste mreze idu istim
+// multi-draw pozivom. U draw se postavljaju program, mreza, model, providnost i odsecanje.
+void drawMeshAsset(CommandBuffer& commands, const DrawCommand& draw, const MeshAsset& asset, int lodIndex);
@@ -0,0 +1,214 @@
+#include "ModelLoader.h"
+#include "ObjParser.h"
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+using namespace glm;
+
+static const float LOD_RATIOS[] = { 0.5f, 0.25f, 0.1f };
+static const int LOD_RATIO_COUNT = sizeof(LOD_RATIOS) / sizeof(LOD_RATIOS[0]);
+
+static void collectMeshes(const aiNode* node, const aiScene* scene, vector<const aiMesh*>& meshes)
+{
+    for (unsigned int i = 0; i < node->mNumMeshes; ++i) {
+        meshes.push_back(scene->mMeshes[node->mMeshes[i]]);
+    }
+    for (unsigned int i = 0; i < node->mNumChildren; ++i) {
+        collectMeshes(node->mChildren[i], scene, meshes);
+    }
+}
+
+// Temena jedne mreze pravo u konacni format; UV i normale kojih nema ostaju nula
+static float* writeMesh(const aiMesh* mesh, float* out)
+{
+    bool hasTextureCoords = mesh->HasTextureCoords(0);
+    bool hasNormals = mesh->HasNormals();
+    for (unsigned int i = 0; i < mesh->mNumVertices; ++i, out += MESH_VERTEX_FLOATS) {
+        out[0] = mesh->mVertices[i].x;
+        out[1] = mesh->mVertices[i].y;
+        out[2] = mesh->mVertices[i].z;
+        out[3] = hasTextureCoords ? mesh->mTextureCoords[0][i].x : 0.0f;
+        out[4] = hasTextureCoords ? mesh->mTextureCoords[0][i].y : 0.0f;
+        out[5] = hasNormals ? mesh->mNormals[i].x : 0.0f;
+        out[6] = hasNormals ? mesh->mNormals[i].y : 0.0f;
+        out[7] = hasNormals ? mesh->mNormals[i].z : 0.0f;
+    }
+    return out;
+}
+
+static ModelMaterial convertMaterial(const aiMaterial* source)
+{
+    ModelMaterial material;
+    aiString name;
+    aiColor3D color;
+    float value;
+    if (source->Get(AI_MATKEY_NAME, name) == aiReturn_SUCCESS) {
+        material.name = name.C_Str();
+    }
+    if (source->Get(AI_MATKEY_COLOR_AMBIENT, color) == aiReturn_SUCCESS) {
+        material.ambient = vec3(color.r, color.g, color.b);
+    }
+    if (source->Get(AI_MATKEY_COLOR_DIFFUSE, color) == aiReturn_SUCCESS) {
+        material.diffuse = vec3(color.r, color.g, color.b);
+    }
+    if (source->Get(AI_MATKEY_COLOR_SPECULAR, color) == aiReturn_SUCCESS) {
+        material.specular = vec3(color.r, color.g, color.b);
+    }
+    if (source->Get(AI_MATKEY_COLOR_EMISSIVE, color) == aiReturn_SUCCESS) {
+        material.emissive = vec3(color.r, color.g, color.b);
+    }
+    if (source->Get(AI_MATKEY_SHININESS, value) == aiReturn_SUCCESS) {
+        material.shininess = value;
+    }
+    if (source->Get(AI_MATKEY_OPACITY, value) == aiReturn_SUCCESS) {
+        material.opacity = value;
+    }
+    if (source->GetTexture(aiTextureType_DIFFUSE, 0, &name) == aiReturn_SUCCESS) {
+        material.diffuseMap = name.C_Str();
+    }
+    return material;
+}
+
+static bool loadWithAssimp(const char* filePath, ModelData& modelData, float reserveFactor)
+{
+    Assimp::Importer importer;
+    const aiScene* scene = importer.ReadFile(filePath, aiProcess_Triangulate | aiProcess_FlipUVs);
+
+    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
+        cerr << "Error loading model: " << importer.GetErrorString() << endl;
+        return false;
+    }
+
+    // Mreze grupisane po materijalu (stabilno, redosled unutar materijala ostaje), kao iz ObjParser-a
+    vector<const aiMesh*> meshes;
+    collectMeshes(scene->mRootNode, scene, meshes);
+    stable_sort(meshes.begin(), meshes.end(), [](const aiMesh* a, const aiMesh* b) { return a->mMaterialIndex < b->mMaterialIndex; });
+    size_t vertexCount = 0;
+    for (const aiMesh* mesh : meshes) {
+        vertexCount += mesh->mNumVertices;
+    }
+    modelData.vertices.reserve((size_t)(vertexCount * reserveFactor + 3) * MESH_VERTEX_FLOATS);
+    modelData.vertices.resize(vertexCount * MESH_VERTEX_FLOATS);
+
+    float* out = modelData.vertices.data();
+    for (const aiMesh* mesh : meshes) {
+        int first = (int)((out - modelData.vertices.data()) / MESH_VERTEX_FLOATS);
+        out = writeMesh(mesh, out);
+        if (!modelData.submeshes.empty() && modelData.submeshes.back().material == (int)mesh->mMaterialIndex) {
+            modelData.submeshes.back().count += (int)mesh->mNumVertices;
+        }
+        else if (mesh->mNumVertices > 0) {
+            SubMesh submesh = { first, (int)mesh->mNumVertices, (int)mesh->mMaterialIndex };
+            modelData.submeshes.push_back(submesh);
+        }
+    }
+    // Teksture materijala su relativne u odnosu na model, kao u ObjParser-u
+    string directory = filePath;
+    directory = directory.substr(0, directory.find_last_of("/\\") + 1);
+    for (unsigned int i = 0; i < scene->mNumMaterials; ++i) {
+        ModelMaterial material = convertMaterial(scene->mMaterials[i]);
+        if (!material.diffuseMap.empty()) {
+            material.diffuseMap = directory + material.diffuseMap;
+        }
+        modelData.materials.push_back(material);
+    }
+    return vertexCount > 0;
+}   // importer oslobadja scenu pre uproscavanja
+
+static bool isObjFile(const char* filePath)
+{
+    size_t length = strlen(filePath);
+    return length > 4 && (strcmp(filePath + length - 4, ".obj") == 0 || strcmp(filePath + length - 4, ".OBJ") == 0);
+}
+
+ModelData loadModel(const char* filePath, bool buildLods, int parseThreads)
+{
+    // Mesto i za uproscene nivoe (otprilike udeo trouglova punog modela), pa nadovezivanje obicno ne realocira
+    float reserveFactor = 1.0f;
+    for (int i = 0; buildLods && i < LOD_RATIO_COUNT; ++i) {
+        reserveFactor += LOD_RATIOS[i];
+    }
+
+    ModelData modelData;
+    if (!(isObjFile(filePath) && parseObj(filePath, modelData, reserveFactor, parseThreads))) {
+        modelData = ModelData();
+        if (!loadWithAssimp(filePath, modelData, reserveFactor)) {
+            return ModelData();
+        }
+    }
+
+    int vertexCount = (int)(modelData.vertices.size() / MESH_VERTEX_FLOATS);
+    modelData.bounds = computeBounds(modelData.vertices.data(), vertexCount, MESH_VERTEX_FLOATS);
+    MeshLod fullModel = { 0, vertexCount };
+    modelData.lods.push_back(fullModel);
+    if (buildLods) {
+        vector<MeshLod> chain = appendLodChain(modelData.vertices, LOD_RATIOS, LOD_RATIO_COUNT);
+        modelData.lods.insert(modelData.lods.end(), chain.begin(), chain.end());
+    }
+    modelData.vertexCount = (int)(modelData.vertices.size() / MESH_VERTEX_FLOATS);
+    return modelData;
+}
+
+void splitPositionsAndNormals(const ModelData& modelData, vector<vec3>& positions, vector<vec3>& normals)
+{
+    int count = (int)(modelData.vertices.size() / MESH_VERTEX_FLOATS);
+    positions.resize(count);
+    normals.resize(count);
+    for (int i = 0; i < count; ++i) {
+        const float* vertex = &modelData.vertices[(size_t)i * MESH_VERTEX_FLOATS];
+        positions[i] = vec3(vertex[0], vertex[1], vertex[2]);
+        normals[i] = vec3(vertex[5], vertex[6], vertex[7]);
+    }
+}
+
+void benchmarkObjLoading(const char* filePath, int runs)
+{
+    double objMs = 1e30, assimpMs = 1e30;
+    ModelData parsed, imported;
+    for (int run = 0; run < max(runs, 1); ++run) {
+        auto start = chrono::high_resolution_clock::now();
+        ModelData model;
+        bool ok = parseObj(filePath, model);
+        objMs = min(objMs, chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count());
+        if (!ok) {
+            cout << "ObjParser ne moze da procita \"" << filePath << "\"" << endl;
+            return;
+        }
+        parsed = move(model);
+
+        start = chrono::high_resolution_clock::now();
+        model = ModelData();
+        ok = loadWithAssimp(filePath, model, 1.0f);
+        assimpMs = min(assimpMs, chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count());
+        if (!ok) {
+            return;
+        }
+        imported = move(model);
+    }
+
+    size_t parsedCount = parsed.vertices.size() / MESH_VERTEX_FLOATS;
+    size_t importedCount = imported.vertices.size() / MESH_VERTEX_FLOATS;
+    cout << filePath << " (najbolje od " << max(runs, 1) << " ucitavanja)" << endl;
+    cout << "  ObjParser: " << objMs << " ms, " << parsedCount << " temena, " << parsed.materials.size() << " materijala" << endl;
+    cout << "  Assimp:    " << assimpMs << " ms, " << importedCount << " temena" << endl;
+    cout << "  ubrzanje:  " << assimpMs / objMs << "x" << endl;
+    if (parsedCount != importedCount) {
+        cout << "  broj temena se razlikuje!" << endl;
+        return;
+    }
+    // Isti redosled trouglova kad model ima jedan materijal; razlika je samo u zaokruzivanju brojeva
+    float maxDifference = 0.0f;
+    for (size_t i = 0; i < parsed.vertices.size(); ++i) {
+        maxDifference = max(maxDifference, fabs(parsed.vertices[i] - imported.vertices[i]));
+    }
+    cout << "  najveca razlika u temenima: " << maxDifference << endl;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "Frustum.h"
+#include "Material.h"
+#include "MeshLod.h"
+
+// Model ucitan kao triangle soup u konacnom formatu temena (MESH_VERTEX_FLOATS po temenu, kao arena
+// Renderer-a). Ucitavanje prvo prebroji temena, pa ih u jednom prolazu upise u niz tacne velicine;
+// Renderer ga kopira pravo u bafer arene, a MeshRegistry ga posle upload-a oslobadja.
+struct ModelData {
+    std::vector<float> vertices;
+    int vertexCount;                // svi nivoi zajedno
+    Bounds bounds;                  // u prostoru modela, racuna se pri ucitavanju
+    std::vector<MeshLod> lods;      // lods[0] je pun model, uproscene verzije su nadovezane iza njega
+    std::vector<ModelMaterial> materials;
+    std::vector<SubMesh> submeshes; // opsezi punog modela po materijalu
+
+    ModelData() : vertexCount(0) {}
+    bool isLoaded() const { return vertexCount > 0; }
+};
+
+// Radna nit (bez GL poziva). OBJ fajlove cita ObjParser, a Assimp ostaje za ostale formate i za OBJ
+// koji ObjParser odbije. Sa buildLods se uproscene verzije (50%, 25% i 10% trouglova) nadovezuju
+// iza punog modela u isti niz, pa svi nivoi dele bafer i crtaju se sa glDrawArrays od svog pomeraja.
+// parseThreads: niti za ObjParser (0 -> sva jezgra).
+ModelData loadModel(const char* filePath, bool buildLods = false, int parseThreads = 0);
+
+// Pozicije i normale u zasebnim nizovima (za SoftwareRenderer)
+void splitPositionsAndNormals(const ModelData& modelData, std::vector<glm::vec3>& positions, std::vector<glm::vec3>& normals);
+
+// PVO.exe --benchmark-obj: isti fajl kroz ObjParser i kroz Assimp, vremena i poredjenje temena na konzoli
+void benchmarkObjLoading(const char* filePath, int runs);
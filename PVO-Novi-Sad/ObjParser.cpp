@@ -0,0 +1,578 @@
+#include "ObjParser.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+
+using namespace std;
+using namespace glm;
+
+// Manji delovi ne isplate pokretanje niti
+static const size_t MIN_CHUNK_BYTES = 256 * 1024;
+
+// Indeks koji ne postoji (npr. lice bez UV koordinata)
+static const int MISSING_INDEX = INT_MIN;
+// Negativni (relativni) OBJ indeksi se u prvom prolazu pamte kao indeks unutar dela minus ovaj pomak,
+// a u drugom prolazu se dodaje pocetak dela
+static const int RELATIVE_BIAS = 1 << 30;
+static const int MAX_INDEX_DIGITS = 9;
+
+static const double POWERS_OF_TEN[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+struct ObjCorner {
+    int position;
+    int uv;
+    int normal;
+};
+
+struct MaterialSwitch {
+    size_t corner;          // prvo teme (ugao trougla) sa novim materijalom
+    string name;
+};
+
+// Jedan deo fajla i sve sto je iz njega procitano u prvom prolazu
+struct ObjChunk {
+    const char* begin;
+    const char* end;
+    vector<float> positions;        // 3 po temenu
+    vector<float> uvs;              // 2 po temenu
+    vector<float> normals;          // 3 po temenu
+    vector<ObjCorner> corners;      // vec triangulisano, 3 po trouglu
+    vector<MaterialSwitch> switches;
+    string materialLibrary;
+    bool failed;
+
+    // Posle prvog prolaza
+    int positionBase, uvBase, normalBase;
+    vector<int> materialOfSwitch;   // materijal za svaki usemtl; -1 pre prvog usemtl u delu
+    int inheritedMaterial;          // materijal koji vazi na pocetku dela
+};
+
+static inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+static inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+static inline const char* skipSpaces(const char* p, const char* end)
+{
+    while (p < end && isSpace(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+// Decimalni broj bez lokalnih podesavanja i bez kopiranja u string (strtod je tu najsporiji deo).
+// Do 19 znacajnih cifara ide u ceo broj, pa se jednom mnozi ili deli tacnim stepenom desetke.
+static const char* parseFloat(const char* p, const char* end, float& value)
+{
+    p = skipSpaces(p, end);
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any = false;
+    for (; p < end && isDigit(*p); ++p, any = true) {
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+            digits += mantissa != 0 ? 1 : 0;
+        }
+        else {
+            ++exponent;
+        }
+    }
+    if (p < end && *p == '.') {
+        for (++p; p < end && isDigit(*p); ++p, any = true) {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+                digits += mantissa != 0 ? 1 : 0;
+                --exponent;
+            }
+        }
+    }
+    if (!any) {
+        value = 0.0f;
+        return nullptr;
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char* q = p + 1;
+        bool negativeExponent = false;
+        if (q < end && (*q == '-' || *q == '+')) {
+            negativeExponent = *q == '-';
+            ++q;
+        }
+        if (q < end && isDigit(*q)) {
+            int written = 0;
+            for (; q < end && isDigit(*q); ++q) {
+                written = min(written * 10 + (*q - '0'), 1000);
+            }
+            exponent += negativeExponent ? -written : written;
+            p = q;
+        }
+    }
+
+    double result = (double)mantissa;
+    while (exponent > 22) {
+        result *= 1e22;
+        exponent -= 22;
+    }
+    while (exponent < -22) {
+        result /= 1e22;
+        exponent += 22;
+    }
+    result = exponent < 0 ? result / POWERS_OF_TEN[-exponent] : result * POWERS_OF_TEN[exponent];
+    value = (float)(negative ? -result : result);
+    return p;
+}
+
+static const char* parseInt(const char* p, const char* end, int& value)
+{
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+    if (p >= end || !isDigit(*p)) {
+        return nullptr;
+    }
+    // Najvise 9 cifara: ne prelivaju int i ostaju ispod RELATIVE_BIAS; duzi broj -> fajl ide Assimp-u
+    int result = 0, digits = 0;
+    for (; p < end && isDigit(*p); ++p) {
+        if (++digits > MAX_INDEX_DIGITS) {
+            return nullptr;
+        }
+        result = result * 10 + (*p - '0');
+    }
+    value = negative ? -result : result;
+    return p;
+}
+
+// OBJ indeks (od 1, ili negativan od kraja) u indeks za drugi prolaz
+static inline int encodeIndex(int index, int chunkCount)
+{
+    if (index > 0) {
+        return index - 1;
+    }
+    return chunkCount + index - RELATIVE_BIAS;
+}
+
+static inline int resolveIndex(int encoded, int chunkBase)
+{
+    if (encoded == MISSING_INDEX || encoded >= 0) {
+        return encoded;
+    }
+    return chunkBase + encoded + RELATIVE_BIAS;
+}
+
+static inline bool startsWith(const char* p, const char* end, const char* keyword, size_t length)
+{
+    return (size_t)(end - p) > length && memcmp(p, keyword, length) == 0 && isSpace(p[length]);
+}
+
+static string restOfLine(const char* p, const char* end)
+{
+    p = skipSpaces(p, end);
+    while (end > p && (isSpace(end[-1]) || end[-1] == '\r')) {
+        --end;
+    }
+    return string(p, end);
+}
+
+static bool parseFace(const char* p, const char* end, ObjChunk& chunk, vector<ObjCorner>& polygon)
+{
+    int positionCount = (int)chunk.positions.size() / 3;
+    int uvCount = (int)chunk.uvs.size() / 2;
+    int normalCount = (int)chunk.normals.size() / 3;
+
+    polygon.clear();
+    for (p = skipSpaces(p, end); p < end && *p != '\r'; p = skipSpaces(p, end)) {
+        ObjCorner corner = { MISSING_INDEX, MISSING_INDEX, MISSING_INDEX };
+        int index;
+        p = parseInt(p, end, index);
+        if (p == nullptr || index == 0) {
+            return false;
+        }
+        corner.position = encodeIndex(index, positionCount);
+        if (p < end && *p == '/') {
+            ++p;
+            if (p < end && *p != '/') {
+                p = parseInt(p, end, index);
+                if (p == nullptr || index == 0) {
+                    return false;
+                }
+                corner.uv = encodeIndex(index, uvCount);
+            }
+            if (p < end && *p == '/') {
+                p = parseInt(p + 1, end, index);
+                if (p == nullptr || index == 0) {
+                    return false;
+                }
+                corner.normal = encodeIndex(index, normalCount);
+            }
+        }
+        polygon.push_back(corner);
+    }
+    if (polygon.size() < 3) {
+        return false;
+    }
+
+    // Lepeza iz prvog temena (modeli iz Blender-a imaju konveksne poligone)
+    for (size_t i = 1; i + 1 < polygon.size(); ++i) {
+        chunk.corners.push_back(polygon[0]);
+        chunk.corners.push_back(polygon[i]);
+        chunk.corners.push_back(polygon[i + 1]);
+    }
+    return true;
+}
+
+// Prvi prolaz: redovi jednog dela u lokalne nizove
+static void parseChunk(ObjChunk& chunk)
+{
+    vector<ObjCorner> polygon;
+    const char* p = chunk.begin;
+    while (p < chunk.end) {
+        const char* lineEnd = static_cast<const char*>(memchr(p, '\n', chunk.end - p));
+        if (lineEnd == nullptr) {
+            lineEnd = chunk.end;
+        }
+        const char* line = skipSpaces(p, lineEnd);
+        p = lineEnd + 1;
+
+        if (lineEnd - line < 3 || *line == '#') {
+            continue;   // najkraci koristan red je "v 0"
+        }
+        if (line[0] == 'v') {
+            float values[3];
+            int count = 0;
+            const char* q = line + 2;
+            if (isSpace(line[1])) {
+                count = 3;
+            }
+            else if (line[1] == 't' && startsWith(line, lineEnd, "vt", 2)) {
+                count = 2;
+                ++q;
+            }
+            else if (line[1] == 'n' && startsWith(line, lineEnd, "vn", 2)) {
+                count = 3;
+                ++q;
+            }
+            for (int i = 0; i < count && q != nullptr; ++i) {
+                q = parseFloat(q, lineEnd, values[i]);
+            }
+            if (count == 0) {
+                continue;
+            }
+            if (q == nullptr) {
+                chunk.failed = true;
+                return;
+            }
+            vector<float>& target = line[1] == 't' ? chunk.uvs : line[1] == 'n' ? chunk.normals : chunk.positions;
+            target.insert(target.end(), values, values + count);
+        }
+        else if (line[0] == 'f' && isSpace(line[1])) {
+            if (!parseFace(line + 2, lineEnd, chunk, polygon)) {
+                chunk.failed = true;
+                return;
+            }
+        }
+        else if (startsWith(line, lineEnd, "usemtl", 6)) {
+            MaterialSwitch materialSwitch = { chunk.corners.size(), restOfLine(line + 6, lineEnd) };
+            chunk.switches.push_back(materialSwitch);
+        }
+        else if (startsWith(line, lineEnd, "mtllib", 6) && chunk.materialLibrary.empty()) {
+            chunk.materialLibrary = restOfLine(line + 6, lineEnd);
+        }
+        // o, g, s, l i ostalo se preskacu
+    }
+}
+
+template<typename F>
+static void runOnThreads(int count, F job)
+{
+    vector<thread> workers;
+    for (int i = 1; i < count; ++i) {
+        workers.emplace_back(job, i);
+    }
+    job(0);
+    for (thread& worker : workers) {
+        worker.join();
+    }
+}
+
+static string directoryOf(const string& path)
+{
+    size_t slash = path.find_last_of("/\\");
+    return slash == string::npos ? string() : path.substr(0, slash + 1);
+}
+
+static int findOrAddMaterial(vector<ModelMaterial>& materials, const string& name)
+{
+    for (size_t i = 0; i < materials.size(); ++i) {
+        if (materials[i].name == name) {
+            return (int)i;
+        }
+    }
+    // usemtl bez zapisa u .mtl dobija podrazumevani materijal
+    ModelMaterial material;
+    material.name = name;
+    materials.push_back(material);
+    return (int)materials.size() - 1;
+}
+
+bool parseObj(const char* filePath, ModelData& modelData, float reserveFactor, int threadCount)
+{
+    MappedFile file;
+    if (!file.open(filePath) || file.size() == 0) {
+        return false;
+    }
+
+    // Delovi fajla po granicama redova
+    if (threadCount <= 0) {
+        threadCount = max((int)thread::hardware_concurrency(), 1);
+    }
+    int chunkCount = (int)min((size_t)threadCount, max(file.size() / MIN_CHUNK_BYTES, (size_t)1));
+    vector<ObjChunk> chunks(chunkCount);
+    const char* fileEnd = file.data() + file.size();
+    const char* start = file.data();
+    for (int i = 0; i < chunkCount; ++i) {
+        const char* split = i + 1 < chunkCount ? file.data() + file.size() * (i + 1) / chunkCount : fileEnd;
+        split = max(split, start);
+        const char* newline = split < fileEnd ? static_cast<const char*>(memchr(split, '\n', fileEnd - split)) : nullptr;
+        chunks[i].begin = start;
+        chunks[i].end = newline != nullptr ? newline + 1 : fileEnd;
+        chunks[i].failed = false;
+        start = chunks[i].end;
+    }
+
+    runOnThreads(chunkCount, [&chunks](int i) { parseChunk(chunks[i]); });
+
+    // Prefiksne sume: gde pocinju temena svakog dela u zajednickim nizovima
+    size_t positionTotal = 0, uvTotal = 0, normalTotal = 0;
+    string materialLibrary;
+    for (ObjChunk& chunk : chunks) {
+        if (chunk.failed) {
+            return false;
+        }
+        chunk.positionBase = (int)(positionTotal / 3);
+        chunk.uvBase = (int)(uvTotal / 2);
+        chunk.normalBase = (int)(normalTotal / 3);
+        positionTotal += chunk.positions.size();
+        uvTotal += chunk.uvs.size();
+        normalTotal += chunk.normals.size();
+        if (materialLibrary.empty()) {
+            materialLibrary = chunk.materialLibrary;
+        }
+    }
+    vector<float> positions, uvs, normals;
+    positions.reserve(positionTotal);
+    uvs.reserve(uvTotal);
+    normals.reserve(normalTotal);
+    for (ObjChunk& chunk : chunks) {
+        positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+        uvs.insert(uvs.end(), chunk.uvs.begin(), chunk.uvs.end());
+        normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+        vector<float>().swap(chunk.positions);
+        vector<float>().swap(chunk.uvs);
+        vector<float>().swap(chunk.normals);
+    }
+
+    // Materijali: mtllib pored OBJ-a; ako ga nema (Blender cesto upise staro ime), <model>.mtl
+    string directory = directoryOf(filePath);
+    vector<ModelMaterial> materials;
+    if (materialLibrary.empty() || !parseMtl((directory + materialLibrary).c_str(), materials)) {
+        string path = filePath;
+        parseMtl((path.substr(0, path.find_last_of('.')) + ".mtl").c_str(), materials);
+    }
+    for (ModelMaterial& material : materials) {
+        if (!material.diffuseMap.empty()) {
+            material.diffuseMap = directory + material.diffuseMap;
+        }
+    }
+
+    // Materijal svakog usemtl-a i broj uglova po (delu, materijalu); lica pre prvog usemtl-a
+    // dobijaju podrazumevani materijal
+    int current = -1;
+    vector<vector<size_t>> counts(chunkCount);
+    for (ObjChunk& chunk : chunks) {
+        chunk.inheritedMaterial = current;
+        for (const MaterialSwitch& materialSwitch : chunk.switches) {
+            chunk.materialOfSwitch.push_back(findOrAddMaterial(materials, materialSwitch.name));
+        }
+        if (!chunk.materialOfSwitch.empty()) {
+            current = chunk.materialOfSwitch.back();
+        }
+    }
+    for (ObjChunk& chunk : chunks) {
+        size_t beforeSwitch = chunk.switches.empty() ? chunk.corners.size() : chunk.switches[0].corner;
+        if (chunk.inheritedMaterial < 0 && beforeSwitch > 0) {
+            chunk.inheritedMaterial = findOrAddMaterial(materials, "default");
+        }
+    }
+    for (int c = 0; c < chunkCount; ++c) {
+        const ObjChunk& chunk = chunks[c];
+        counts[c].assign(materials.size(), 0);
+        size_t segmentStart = 0;
+        int material = chunk.inheritedMaterial;
+        for (size_t s = 0; s <= chunk.switches.size(); ++s) {
+            size_t segmentEnd = s < chunk.switches.size() ? chunk.switches[s].corner : chunk.corners.size();
+            if (segmentEnd > segmentStart) {
+                counts[c][material] += segmentEnd - segmentStart;
+            }
+            if (s < chunk.switches.size()) {
+                material = chunk.materialOfSwitch[s];
+                segmentStart = segmentEnd;
+            }
+        }
+    }
+
+    // Opsezi materijala u izlaznom nizu; unutar materijala delovi idu redom
+    vector<vector<size_t>> offsets(chunkCount, vector<size_t>(materials.size()));
+    size_t vertexCount = 0;
+    for (size_t m = 0; m < materials.size(); ++m) {
+        SubMesh submesh = { (int)vertexCount, 0, (int)m };
+        for (int c = 0; c < chunkCount; ++c) {
+            offsets[c][m] = vertexCount;
+            vertexCount += counts[c][m];
+        }
+        submesh.count = (int)vertexCount - submesh.first;
+        if (submesh.count > 0) {
+            modelData.submeshes.push_back(submesh);
+        }
+    }
+    if (vertexCount == 0) {
+        modelData.submeshes.clear();
+        return false;
+    }
+
+    modelData.vertices.reserve((size_t)(vertexCount * max(reserveFactor, 1.0f) + 3) * MESH_VERTEX_FLOATS);
+    modelData.vertices.resize(vertexCount * MESH_VERTEX_FLOATS);
+
+    // Drugi prolaz: uglovi pravo u konacni format, svaki deo na svoja mesta
+    atomic<bool> outOfRange(false);
+    float* output = modelData.vertices.data();
+    int positionCount = (int)(positions.size() / 3), uvCount = (int)(uvs.size() / 2), normalCount = (int)(normals.size() / 3);
+    runOnThreads(chunkCount, [&](int c) {
+        const ObjChunk& chunk = chunks[c];
+        vector<size_t> cursor = offsets[c];
+        int material = chunk.inheritedMaterial;
+        size_t nextSwitch = 0;
+        for (size_t i = 0; i < chunk.corners.size(); ++i) {
+            while (nextSwitch < chunk.switches.size() && chunk.switches[nextSwitch].corner == i) {
+                material = chunk.materialOfSwitch[nextSwitch++];
+            }
+            const ObjCorner& corner = chunk.corners[i];
+            int position = resolveIndex(corner.position, chunk.positionBase);
+            int uv = resolveIndex(corner.uv, chunk.uvBase);
+            int normal = resolveIndex(corner.normal, chunk.normalBase);
+            float* out = output + cursor[material]++ * MESH_VERTEX_FLOATS;
+            if (position < 0 || position >= positionCount || uv >= uvCount || normal >= normalCount
+                || (uv < 0 && uv != MISSING_INDEX) || (normal < 0 && normal != MISSING_INDEX)) {
+                outOfRange = true;
+                continue;
+            }
+            out[0] = positions[(size_t)position * 3];
+            out[1] = positions[(size_t)position * 3 + 1];
+            out[2] = positions[(size_t)position * 3 + 2];
+            out[3] = uv != MISSING_INDEX ? uvs[(size_t)uv * 2] : 0.0f;
+            out[4] = uv != MISSING_INDEX ? 1.0f - uvs[(size_t)uv * 2 + 1] : 0.0f;
+            out[5] = normal != MISSING_INDEX ? normals[(size_t)normal * 3] : 0.0f;
+            out[6] = normal != MISSING_INDEX ? normals[(size_t)normal * 3 + 1] : 0.0f;
+            out[7] = normal != MISSING_INDEX ? normals[(size_t)normal * 3 + 2] : 0.0f;
+        }
+    });
+    if (outOfRange) {
+        modelData.vertices.clear();
+        modelData.submeshes.clear();
+        return false;
+    }
+
+    modelData.materials = move(materials);
+    return true;
+}
+
+static vec3 parseColor(const char* p, const char* end)
+{
+    float rgb[3] = { 0.0f, 0.0f, 0.0f };
+    for (int i = 0; i < 3 && p != nullptr; ++i) {
+        p = parseFloat(p, end, rgb[i]);
+        if (p == nullptr && i == 1) {
+            rgb[1] = rgb[2] = rgb[0];   // "Kd 0.5" znaci sivu
+        }
+    }
+    return vec3(rgb[0], rgb[1], rgb[2]);
+}
+
+bool parseMtl(const char* filePath, vector<ModelMaterial>& materials)
+{
+    MappedFile file;
+    if (!file.open(filePath)) {
+        return false;
+    }
+
+    ModelMaterial* material = nullptr;
+    const char* p = file.data();
+    const char* fileEnd = p + file.size();
+    while (p < fileEnd) {
+        const char* lineEnd = static_cast<const char*>(memchr(p, '\n', fileEnd - p));
+        if (lineEnd == nullptr) {
+            lineEnd = fileEnd;
+        }
+        const char* line = skipSpaces(p, lineEnd);
+        p = lineEnd + 1;
+
+        float value;
+        if (startsWith(line, lineEnd, "newmtl", 6)) {
+            materials.push_back(ModelMaterial());
+            material = &materials.back();
+            material->name = restOfLine(line + 6, lineEnd);
+        }
+        else if (material == nullptr) {
+            continue;
+        }
+        else if (startsWith(line, lineEnd, "Ka", 2)) {
+            material->ambient = parseColor(line + 2, lineEnd);
+        }
+        else if (startsWith(line, lineEnd, "Kd", 2)) {
+            material->diffuse = parseColor(line + 2, lineEnd);
+        }
+        else if (startsWith(line, lineEnd, "Ks", 2)) {
+            material->specular = parseColor(line + 2, lineEnd);
+        }
+        else if (startsWith(line, lineEnd, "Ke", 2)) {
+            material->emissive = parseColor(line + 2, lineEnd);
+        }
+        else if (startsWith(line, lineEnd, "Ns", 2) && parseFloat(line + 2, lineEnd, value) != nullptr) {
+            material->shininess = value;
+        }
+        else if (startsWith(line, lineEnd, "d", 1) && parseFloat(line + 1, lineEnd, value) != nullptr) {
+            material->opacity = value;
+        }
+        else if (startsWith(line, lineEnd, "Tr", 2) && parseFloat(line + 2, lineEnd, value) != nullptr) {
+            material->opacity = 1.0f - value;
+        }
+        else if (startsWith(line, lineEnd, "map_Kd", 6)) {
+            // Opcije (-s, -o ...) se ne koriste, ime fajla je poslednja rec
+            string map = restOfLine(line + 6, lineEnd);
+            size_t space = map.find_last_of(" \t");
+            material->diffuseMap = space == string::npos ? map : map.substr(space + 1);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <vector>
+
+#include "Material.h"
+#include "ModelLoader.h"
+
+// Parser za Wavefront OBJ/MTL kakve izvozi Blender, brzi od Assimp-a za nase modele.
+// Fajl se mapira u memoriju i deli na delove po granicama redova; svaka nit parsira svoj deo (v, vt, vn, f,
+// usemtl), a posle prefiksnih suma se lica u drugom paralelnom prolazu upisuju pravo u konacni format temena
+// (MESH_VERTEX_FLOATS, V okrenut kao aiProcess_FlipUVs). Poligoni se trianguliraju lepezom, a trouglovi se
+// grupisu po materijalu u submesh opsege. Materijali se citaju iz mtllib fajla.
+// Vraca false ako fajl ne postoji ili nije ispravan (tada se koristi Assimp).
+// reserveFactor: kapacitet niza u odnosu na pun model (mesto za LOD-ove koji se nadovezuju iza njega).
+// threadCount 0 -> onoliko niti koliko ima jezgara (delovi nisu manji od 256 kB); na radnoj niti AssetLoader-a
+// treba dati njen deo jezgara, jer se vise modela ucitava istovremeno.
+bool parseObj(const char* filePath, ModelData& modelData, float reserveFactor = 1.0f, int threadCount = 0);
+
+// Materijali iz .mtl fajla se dodaju na kraj niza
+bool parseMtl(const char* filePath, std::vector<ModelMaterial>& materials);
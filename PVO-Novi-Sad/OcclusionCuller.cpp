@@ -0,0 +1,192 @@
+#include "OcclusionCuller.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+using namespace glm;
+
+OcclusionCuller::OcclusionCuller()
+    : depthProgram(0), depthRenderbuffer(0), fbo(0), writeIndex(0), viewProjection(1.0f)
+{
+    pbos[0] = pbos[1] = 0;
+    fences[0] = fences[1] = 0;
+    previousViewport[0] = previousViewport[1] = previousViewport[2] = previousViewport[3] = 0;
+}
+
+void OcclusionCuller::init(GLuint depthShader)
+{
+    depthProgram = depthShader;
+
+    glGenRenderbuffers(1, &depthRenderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthRenderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, SIZE, SIZE);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    // Samo dubina, bez boje
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRenderbuffer);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    glGenBuffers(2, pbos);
+    for (int i = 0; i < 2; ++i) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[i]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, SIZE * SIZE * sizeof(float), NULL, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void OcclusionCuller::update()
+{
+    // Prvo starija kopija (slot koji je sledeci za upis), pa novija - novija pobedjuje
+    for (int k = 0; k < 2; ++k) {
+        int slot = writeIndex ^ k;
+        if (fences[slot] == 0) {
+            continue;
+        }
+        GLenum status = glClientWaitSync(fences[slot], 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            continue;
+        }
+        glDeleteSync(fences[slot]);
+        fences[slot] = 0;
+
+        if (levels.empty()) {
+            for (int size = SIZE; size >= 1; size /= 2) {
+                Level level;
+                level.size = size;
+                level.depth.resize(size * size);
+                levels.push_back(level);
+            }
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[slot]);
+        glGetBufferSubData(GL_PIXEL_PACK_BUFFER, 0, SIZE * SIZE * sizeof(float), levels[0].depth.data());
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        viewProjection = pendingViewProjection[slot];
+        buildPyramid();
+    }
+}
+
+void OcclusionCuller::buildPyramid()
+{
+    for (size_t l = 1; l < levels.size(); ++l) {
+        const Level& below = levels[l - 1];
+        Level& level = levels[l];
+        for (int y = 0; y < level.size; ++y) {
+            const float* row0 = &below.depth[(y * 2) * below.size];
+            const float* row1 = row0 + below.size;
+            for (int x = 0; x < level.size; ++x) {
+                level.depth[y * level.size + x] = std::max(std::max(row0[x * 2], row0[x * 2 + 1]), std::max(row1[x * 2], row1[x * 2 + 1]));
+            }
+        }
+    }
+}
+
+bool OcclusionCuller::beginOccluders(const mat4& view, const mat4& projection)
+{
+    if (fbo == 0 || fences[writeIndex] != 0) {
+        return false;
+    }
+
+    glGetIntegerv(GL_VIEWPORT, previousViewport);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, SIZE, SIZE);
+    glDepthMask(GL_TRUE);
+    glClear(GL_DEPTH_BUFFER_BIT);
+
+    glUseProgram(depthProgram);
+    glUniformMatrix4fv(glGetUniformLocation(depthProgram, "uV"), 1, GL_FALSE, value_ptr(view));
+    glUniformMatrix4fv(glGetUniformLocation(depthProgram, "uP"), 1, GL_FALSE, value_ptr(projection));
+    pendingViewProjection[writeIndex] = projection * view;
+    return true;
+}
+
+void OcclusionCuller::endOccluders()
+{
+    glBindVertexArray(0);
+
+    // Kopija ide u PBO, CPU je preuzima tek kad fence javi da je gotova
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[writeIndex]);
+    glReadPixels(0, 0, SIZE, SIZE, GL_DEPTH_COMPONENT, GL_FLOAT, (void*)0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    fences[writeIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    writeIndex ^= 1;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+}
+
+bool OcclusionCuller::isOccluded(const Bounds& worldBounds) const
+{
+    if (levels.empty()) {
+        return false;
+    }
+
+    // Pravougaonik na ekranu i najbliza dubina AABB-a (u prostoru prozora, kao dubinski bafer)
+    vec2 screenMin(1.0f), screenMax(0.0f);
+    float nearestDepth = 1.0f;
+    for (int i = 0; i < 8; ++i) {
+        vec3 corner((i & 1) ? worldBounds.maxCorner.x : worldBounds.minCorner.x,
+                    (i & 2) ? worldBounds.maxCorner.y : worldBounds.minCorner.y,
+                    (i & 4) ? worldBounds.maxCorner.z : worldBounds.minCorner.z);
+        vec4 clip = viewProjection * vec4(corner, 1.0f);
+        if (clip.w <= 0.0001f) {
+            return false; // Objekat je iza ili oko kamere
+        }
+        vec3 ndc = vec3(clip) / clip.w;
+        vec2 screen = vec2(ndc.x, ndc.y) * 0.5f + 0.5f;
+        screenMin = min(screenMin, screen);
+        screenMax = max(screenMax, screen);
+        nearestDepth = std::min(nearestDepth, ndc.z * 0.5f + 0.5f);
+    }
+    if (screenMax.x < 0.0f || screenMax.y < 0.0f || screenMin.x > 1.0f || screenMin.y > 1.0f) {
+        return false; // Van ekrana - to je posao odsecanja piramidom pogleda
+    }
+
+    // Pravougaonik u tekselima osnovnog nivoa, prosiren za jedan teksel (zaklanjaci su crtani u nizoj rezoluciji)
+    int x0 = std::max((int)floor(screenMin.x * SIZE) - 1, 0);
+    int y0 = std::max((int)floor(screenMin.y * SIZE) - 1, 0);
+    int x1 = std::min((int)floor(screenMax.x * SIZE) + 1, SIZE - 1);
+    int y1 = std::min((int)floor(screenMax.y * SIZE) + 1, SIZE - 1);
+
+    // Nivo na kome pravougaonik pokriva najvise 2x2 teksela (pa je dovoljno par citanja)
+    int extent = std::max(x1 - x0, y1 - y0) + 1;
+    int level = 0;
+    while ((1 << level) < extent && level + 1 < (int)levels.size()) {
+        ++level;
+    }
+    const Level& hiZ = levels[level];
+    x0 >>= level; y0 >>= level; x1 >>= level; y1 >>= level;
+
+    float farthestOccluder = 0.0f;
+    for (int y = y0; y <= y1; ++y) {
+        for (int x = x0; x <= x1; ++x) {
+            farthestOccluder = std::max(farthestOccluder, hiZ.depth[y * hiZ.size + x]);
+        }
+    }
+    return nearestDepth > farthestOccluder;
+}
+
+void OcclusionCuller::release()
+{
+    for (int i = 0; i < 2; ++i) {
+        if (fences[i] != 0) {
+            glDeleteSync(fences[i]);
+            fences[i] = 0;
+        }
+    }
+    if (fbo != 0) {
+        glDeleteFramebuffers(1, &fbo);
+        glDeleteRenderbuffers(1, &depthRenderbuffer);
+        glDeleteBuffers(2, pbos);
+        fbo = depthRenderbuffer = 0;
+        pbos[0] = pbos[1] = 0;
+    }
+    levels.clear();
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Frustum.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// Odsecanje zaklonjenih objekata (Hi-Z): veliki zaklanjaci (teren/planina) se svakog frejma crtaju samo u
+// malu dubinsku teksturu (SIZE x SIZE), koja se asinhrono kopira u PBO i cita frejm-dva kasnije (fence, bez
+// cekanja GPU-a). Od nje se na CPU pravi piramida u kojoj svaki teksel cuva najvecu (najdalju) dubinu
+// 2x2 teksela nivoa ispod. Objekat je zaklonjen ako je njegova najbliza tacka dalje od najdalje dubine
+// zaklanjaca preko celog pravougaonika koji zauzima na ekranu - proverava se par teksela na nivou
+// piramide koji odgovara velicini pravougaonika.
+// Rezultat kasni koliko i kopija, sto je ovde bezbedno jer su kamera i zaklanjaci staticni.
+class OcclusionCuller
+{
+public:
+    static const int SIZE = 256;
+
+    OcclusionCuller();
+
+    OcclusionCuller(const OcclusionCuller&) = delete;
+    OcclusionCuller& operator=(const OcclusionCuller&) = delete;
+
+    // Render nit. depthProgram je depth.vert + depth.frag.
+    void init(GLuint depthProgram);
+
+    // Preuzima gotovu kopiju dubine (ako je stigla) i pravi piramidu
+    void update();
+
+    // Crtanje zaklanjaca u malu dubinsku teksturu; vraca false ako je prethodna kopija jos u toku
+    bool beginOccluders(const glm::mat4& view, const glm::mat4& projection);
+    // Zaklanjaci se crtaju programom depthProgram izmedju beginOccluders i endOccluders
+    // Pokrece asinhronu kopiju i vraca podrazumevani framebuffer i viewport
+    void endOccluders();
+
+    // AABB u prostoru sveta; false dok piramida ne postoji ili ako objekat sece ravan kamere
+    bool isOccluded(const Bounds& worldBounds) const;
+
+    bool hasPyramid() const { return !levels.empty(); }
+
+    void release();
+
+private:
+    struct Level {
+        int size;
+        std::vector<float> depth;
+    };
+
+    void buildPyramid();
+
+    GLuint depthProgram;
+    GLuint depthRenderbuffer;
+    GLuint fbo;
+    GLuint pbos[2];
+    GLsync fences[2];
+    glm::mat4 pendingViewProjection[2];
+    int writeIndex;
+    GLint previousViewport[4];
+
+    glm::mat4 viewProjection;
+    std::vector<Level> levels;
+};
@@ -0,0 +1,141 @@
+#include "OitPass.h"
+
+#include <iostream>
+
+using namespace std;
+
+static GLuint createTarget(int width, int height)
+{
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    // Tezine idu do 3e3, pa 8 bita nije dovoljno
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_HALF_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return texture;
+}
+
+OitPass::OitPass()
+    : compositeProgram(0), width(0), height(0), accumTexture(0), revealTexture(0), depthRenderbuffer(0), fbo(0), emptyVAO(0),
+      active(false), depthTest(GL_FALSE), depthMask(GL_TRUE), cullFace(GL_FALSE), blend(GL_FALSE)
+{
+}
+
+void OitPass::init(GLuint compositeShader, int framebufferWidth, int framebufferHeight)
+{
+    compositeProgram = compositeShader;
+    width = framebufferWidth;
+    height = framebufferHeight;
+
+    accumTexture = createTarget(width, height);
+    revealTexture = createTarget(width, height);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // Isti format kao podrazumevani framebuffer (GLFW: 24 bita dubine + 8 bita stencil-a), inace blit ne radi
+    glGenRenderbuffers(1, &depthRenderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthRenderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, accumTexture, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, revealTexture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthRenderbuffer);
+    const GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glDrawBuffers(2, drawBuffers);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        cout << "OIT framebuffer nije kompletan, providni objekti se crtaju bez njega" << endl;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        release();
+        return;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // Prolaz preko celog ekrana pravi temena u shaderu (gl_VertexID), ali core profil trazi neki VAO
+    glGenVertexArrays(1, &emptyVAO);
+}
+
+void OitPass::begin()
+{
+    if (fbo == 0) {
+        // Bez OIT ciljeva providni objekti se obicno mesaju (zavisno od redosleda)
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        return;
+    }
+
+    depthTest = glIsEnabled(GL_DEPTH_TEST);
+    glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMask);
+    cullFace = glIsEnabled(GL_CULL_FACE);
+    blend = glIsEnabled(GL_BLEND);
+
+    // Dubina neprovidne scene
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    const GLfloat clearAccum[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    const GLfloat clearReveal[] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    glClearBufferfv(GL_COLOR, 0, clearAccum);
+    glClearBufferfv(GL_COLOR, 1, clearReveal);
+
+    // Providni objekti se testiraju dubinom ali je ne upisuju (svi slojevi ulaze u zbir)
+    glEnable(GL_DEPTH_TEST);
+    glDepthMask(GL_FALSE);
+    glEnable(GL_BLEND);
+    glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA);
+    active = true;
+}
+
+void OitPass::end()
+{
+    if (!active) {
+        glDisable(GL_BLEND);
+        return;
+    }
+    active = false;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDisable(GL_DEPTH_TEST);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    glUseProgram(compositeProgram);
+    glUniform1i(glGetUniformLocation(compositeProgram, "uAccum"), 0);
+    glUniform1i(glGetUniformLocation(compositeProgram, "uReveal"), 1);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, accumTexture);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, revealTexture);
+    glBindVertexArray(emptyVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glDepthMask(depthMask);
+    if (!blend) glDisable(GL_BLEND);
+    if (depthTest) glEnable(GL_DEPTH_TEST);
+    if (cullFace) glEnable(GL_CULL_FACE); else glDisable(GL_CULL_FACE);
+}
+
+void OitPass::release()
+{
+    if (fbo != 0) {
+        glDeleteFramebuffers(1, &fbo);
+        glDeleteRenderbuffers(1, &depthRenderbuffer);
+        glDeleteTextures(1, &accumTexture);
+        glDeleteTextures(1, &revealTexture);
+        fbo = depthRenderbuffer = accumTexture = revealTexture = 0;
+    }
+    if (emptyVAO != 0) {
+        glDeleteVertexArrays(1, &emptyVAO);
+        emptyVAO = 0;
+    }
+    active = false;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <GL/glew.h>
+
+// Providni objekti bez sortiranja: weighted blended OIT (McGuire i Bavoil).
+// Svi providni objekti se crtaju izmedju begin() i end() bilo kojim redosledom u dva cilja:
+//  - akumulacija (RGBA16F): rgb = suma(boja * alfa * tezina)
+//  - propustljivost (RGBA16F): r = suma(alfa * tezina), a = proizvod(1 - alfa)
+// pa end() jednim prolazom preko celog ekrana deli akumulaciju sumom tezina i mesa sa scenom.
+// Oba cilja koriste isti blend (rgb sabiranje, alfa mnozenje), pa je dovoljan OpenGL 3.3 (bez glBlendFunci).
+// Dubina neprovidne scene se kopira (blit) u FBO, tako da providni objekti iza neprovidnih ne ulaze u zbir.
+// Shaderi providnih objekata pisu u oba izlaza kada je uniforma uOit ukljucena (vidi base.frag).
+class OitPass
+{
+public:
+    OitPass();
+
+    OitPass(const OitPass&) = delete;
+    OitPass& operator=(const OitPass&) = delete;
+
+    // Render nit. Velicina je velicina framebuffer-a prozora.
+    void init(GLuint compositeProgram, int width, int height);
+
+    // Posle svih neprovidnih objekata: preusmerava crtanje u OIT ciljeve
+    void begin();
+    // Spaja providne objekte sa scenom u podrazumevanom framebuffer-u i vraca prethodno stanje
+    void end();
+
+    void release();
+
+    bool isActive() const { return active; }
+
+private:
+    GLuint compositeProgram;
+    int width;
+    int height;
+
+    GLuint accumTexture;
+    GLuint revealTexture;
+    GLuint depthRenderbuffer;
+    GLuint fbo;
+    GLuint emptyVAO;
+
+    bool active;
+    GLboolean depthTest;
+    GLboolean depthMask;
+    GLboolean cullFace;
+    GLboolean blend;
+};
@@ -0,0 +1,64 @@
+#include "Profiler.h"
+
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+
+Profiler::Profiler(double reportInterval)
+    : reportInterval(reportInterval), accumulatedMs(0.0), frameCount(0), averageMs(0.0)
+{
+    frameStart = intervalStart = Clock::now();
+}
+
+void Profiler::beginFrame()
+{
+    frameStart = Clock::now();
+}
+
+bool Profiler::endFrame()
+{
+    Clock::time_point now = Clock::now();
+    accumulatedMs += chrono::duration<double, milli>(now - frameStart).count();
+    frameCount++;
+
+    if (chrono::duration<double>(now - intervalStart).count() < reportInterval) {
+        return false;
+    }
+
+    averageMs = accumulatedMs / frameCount;
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.2f ms (%.0f fps)", averageMs, averageMs > 0.0 ? 1000.0 / averageMs : 0.0);
+    lastReport = buffer;
+    for (size_t i = 0; i < counters.size(); ++i) {
+        snprintf(buffer, sizeof(buffer), " | %s: %d", counters[i].name, counters[i].value);
+        lastReport += buffer;
+    }
+
+    accumulatedMs = 0.0;
+    frameCount = 0;
+    intervalStart = now;
+    return true;
+}
+
+void Profiler::setCounter(const char* name, int value)
+{
+    for (size_t i = 0; i < counters.size(); ++i) {
+        if (counters[i].name == name || strcmp(counters[i].name, name) == 0) {
+            counters[i].value = value;
+            return;
+        }
+    }
+    Counter counter = { name, value };
+    counters.push_back(counter);
+}
+
+int Profiler::counter(const char* name) const
+{
+    for (size_t i = 0; i < counters.size(); ++i) {
+        if (counters[i].name == name || strcmp(counters[i].name, name) == 0) {
+            return counters[i].value;
+        }
+    }
+    return 0;
+}
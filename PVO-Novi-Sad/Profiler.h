@@ -0,0 +1,43 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Merenje vremena frejma i brojaci po frejmu (npr. statistika odsecanja).
+// Brojaci se postavljaju tokom frejma, a jednom u reportInterval sekundi pravi se izvestaj
+// sa prosecnim vremenom frejma i poslednjim vrednostima brojaca (prikazuje se u naslovu prozora).
+class Profiler
+{
+public:
+    explicit Profiler(double reportInterval = 1.0);
+
+    void beginFrame();
+
+    // Vraca true kada je napravljen novi izvestaj
+    bool endFrame();
+
+    // Ime mora da zivi dok i profiler (string literal) - cuva se samo pokazivac, pa nema alokacija po frejmu
+    void setCounter(const char* name, int value);
+    int counter(const char* name) const;
+
+    double averageFrameMs() const { return averageMs; }
+    const std::string& report() const { return lastReport; }
+
+private:
+    struct Counter {
+        const char* name;
+        int value;
+    };
+
+    typedef std::chrono::high_resolution_clock Clock;
+
+    double reportInterval;
+    Clock::time_point frameStart;
+    Clock::time_point intervalStart;
+    double accumulatedMs;
+    int frameCount;
+    double averageMs;
+    std::vector<Counter> counters;
+    std::string lastReport;
+};
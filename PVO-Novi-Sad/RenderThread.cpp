@@ -0,0 +1,128 @@
+#include "RenderThread.h"
+
+#include <chrono>
+
+using namespace std;
+
+RenderThread::RenderThread()
+    : window(NULL), renderer(NULL), recordIndex(0), pendingGraph(nullptr), syncDone(false), stopping(false),
+      running(false), lastRenderMs(0.0)
+{
+}
+
+RenderThread::~RenderThread()
+{
+    stop();
+}
+
+void RenderThread::init(GLFWwindow* renderWindow, Renderer& frameRenderer)
+{
+    window = renderWindow;
+    renderer = &frameRenderer;
+}
+
+void RenderThread::start()
+{
+    if (running) {
+        return;
+    }
+    // Kontekst moze biti aktivan samo na jednoj niti
+    glfwMakeContextCurrent(NULL);
+    stopping = false;
+    running = true;
+    thread = std::thread(&RenderThread::renderLoop, this);
+}
+
+void RenderThread::stop()
+{
+    if (!running) {
+        return;
+    }
+    {
+        unique_lock<mutex> lock(frameMutex);
+        frameCondition.wait(lock, [this]() { return pendingGraph == nullptr; });
+        stopping = true;
+    }
+    frameCondition.notify_all();
+    thread.join();
+    running = false;
+
+    // Sinhroni poslovi posle poslednjeg frejma (npr. upload-i) se izvrsavaju ovde
+    glfwMakeContextCurrent(window);
+    runSyncJobs();
+}
+
+void RenderThread::submit()
+{
+    FrameGraph& graph = graphs[recordIndex];
+    graph.compile();
+
+    if (!running) {
+        runSyncJobs();
+        lastRenderMs = renderFrame(graph);
+        return;
+    }
+
+    unique_lock<mutex> lock(frameMutex);
+    // Render nit jos crta prethodni frejm - graf u koji ce se sledece snimati je upravo taj
+    frameCondition.wait(lock, [this]() { return pendingGraph == nullptr; });
+    pendingGraph = &graph;
+    syncDone = false;
+    frameCondition.notify_all();
+    frameCondition.wait(lock, [this]() { return syncDone; });
+    recordIndex = 1 - recordIndex;
+}
+
+double RenderThread::renderMilliseconds()
+{
+    lock_guard<mutex> lock(frameMutex);
+    return lastRenderMs;
+}
+
+void RenderThread::renderLoop()
+{
+    glfwMakeContextCurrent(window);
+
+    unique_lock<mutex> lock(frameMutex);
+    while (true) {
+        frameCondition.wait(lock, [this]() { return pendingGraph != nullptr || stopping; });
+        if (pendingGraph == nullptr) {
+            break;
+        }
+        FrameGraph& graph = *pendingGraph;
+
+        // Glavna nit ceka u submit(), pa sinhroni poslovi nemaju trku sa igrom
+        lock.unlock();
+        runSyncJobs();
+        lock.lock();
+        syncDone = true;
+        frameCondition.notify_all();
+
+        lock.unlock();
+        double elapsedMs = renderFrame(graph);
+        lock.lock();
+
+        lastRenderMs = elapsedMs;
+        pendingGraph = nullptr;
+        frameCondition.notify_all();
+    }
+
+    glfwMakeContextCurrent(NULL);
+}
+
+void RenderThread::runSyncJobs()
+{
+    for (size_t i = 0; i < syncJobs.size(); ++i) {
+        syncJobs[i]();
+    }
+    syncJobs.clear();
+}
+
+double RenderThread::renderFrame(FrameGraph& graph)
+{
+    auto start = chrono::high_resolution_clock::now();
+    renderer->resetStats();
+    graph.execute(*renderer);
+    glfwSwapBuffers(window);
+    return chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "FrameGraph.h"
+#include "Renderer.h"
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Render nit: izvrsava graf frejma N (svi GL pozivi i glfwSwapBuffers) dok glavna nit obradjuje ulaz,
+// simulira i snima frejm N+1 u drugi graf. Grafovi su dvostruki, pa render nit nikad ne cita graf
+// koji se upravo snima, a snimljen graf se posle predaje vise ne menja.
+// Predaja frejma je jedina tacka sinhronizacije: submit() ceka da render nit zavrsi prethodni frejm,
+// zatim render nit izvrsi sinhrone poslove (upload-i, citanje rezultata sa GPU-a, podesavanja modula)
+// dok glavna nit jos ceka, pa tek onda igra nastavlja. Zato sinhroni poslovi smeju da menjaju stanje
+// koje cita igra, a komande grafa ne smeju da citaju nista sto igra menja posle predaje.
+// Bez start() (jedna nit) submit() sve radi odmah na pozivajucoj niti.
+class RenderThread
+{
+public:
+    RenderThread();
+    ~RenderThread();
+
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+
+    // Poziva se na niti koja trenutno drzi kontekst prozora
+    void init(GLFWwindow* window, Renderer& renderer);
+    // GL kontekst prelazi na render nit
+    void start();
+    // Zavrsava poslednji frejm i vraca kontekst pozivajucoj niti
+    void stop();
+    bool isRunning() const { return running; }
+
+    // Graf u koji igra snima sledeci frejm
+    FrameGraph& recordGraph() { return graphs[recordIndex]; }
+    // GL posao koji mora da bude gotov pre nego sto igra nastavi sa sledecim frejmom.
+    // Zahvacene vrednosti zive u areni grafa koji se snima (poslovi se izvrsavaju pri njegovoj predaji).
+    template<typename F>
+    void sync(F&& job) { syncJobs.emplace_back(recordGraph().frameArena(), std::forward<F>(job)); }
+    // Predaje snimljeni graf render niti; vraca se kad su sinhroni poslovi izvrseni
+    void submit();
+
+    // Trajanje izvrsavanja poslednjeg grafa (sa zamenom bafera), u ms
+    double renderMilliseconds();
+
+private:
+    void renderLoop();
+    void runSyncJobs();
+    double renderFrame(FrameGraph& graph);
+
+    GLFWwindow* window;
+    Renderer* renderer;
+    FrameGraph graphs[2];
+    int recordIndex;
+    std::vector<ArenaFunction<void>> syncJobs;
+
+    std::thread thread;
+    std::mutex frameMutex;
+    std::condition_variable frameCondition;
+    FrameGraph* pendingGraph;   // predat graf; nullptr kad je render nit slobodna
+    bool syncDone;
+    bool stopping;
+    bool running;
+    double lastRenderMs;
+};
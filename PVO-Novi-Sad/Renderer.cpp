@@ -0,0 +1,609 @@
+#include "Renderer.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+using namespace std;
+using namespace glm;
+
+Renderer::Renderer()
+    : arenaVAO(0), arenaVBO(0), arenaVertices(0), arenaCapacity(0), drawIdBuffer(0), drawIdCount(0),
+      indirectBuffer(0), multiDrawIndirect(false), currentProgram(0), currentVAO(0), currentTexture(0),
+      currentTextureTarget(GL_TEXTURE_2D), currentCull(-1), currentFrontFace(-1), drawDataBound(false),
+      drawCallCount(0), stateChangeCount(0), submittedDrawCount(0)
+{
+}
+
+void Renderer::init()
+{
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+    glEnable(GL_CULL_FACE);
+    glCullFace(GL_BACK);
+    glFrontFace(GL_CCW);
+    glDisable(GL_BLEND);
+    drawData.init(1024);
+    materialTable.init();
+
+    // baseInstance u indirektnoj komandi tek od ARB_base_instance (pre toga mora biti 0)
+    multiDrawIndirect = GLEW_ARB_multi_draw_indirect && GLEW_ARB_base_instance;
+    if (multiDrawIndirect) {
+        glGenBuffers(1, &indirectBuffer);
+    }
+    glGenBuffers(1, &drawIdBuffer);
+    reserveDrawIds(drawData.drawIndexCount());
+
+    glGenVertexArrays(1, &arenaVAO);
+    attachDrawId(arenaVAO);
+    invalidateState();
+}
+
+ProgramHandle Renderer::registerProgram(GLuint name)
+{
+    Program program;
+    program.name = name;
+    program.modelLoc = glGetUniformLocation(name, "uM");
+    program.colorLoc = glGetUniformLocation(name, "color");
+    program.alphaLoc = glGetUniformLocation(name, "uAlpha");
+    program.drawIdLoc = glGetUniformLocation(name, "uDrawId");
+
+    GLint drawDataLoc = glGetUniformLocation(name, "uDrawData");
+    GLint materialsLoc = glGetUniformLocation(name, "uMaterials");
+    if (drawDataLoc != -1 || materialsLoc != -1) {
+        glUseProgram(name);
+        glUniform1i(drawDataLoc, DRAW_DATA_UNIT);
+        glUniform1i(materialsLoc, MATERIAL_UNIT);
+        invalidateState();
+    }
+
+    programs.push_back(program);
+    return ProgramHandle((int)programs.size());
+}
+
+TextureHandle Renderer::registerTexture(const GLuint* name, GLenum target)
+{
+    Texture texture = { name, target };
+    textures.push_back(texture);
+    return TextureHandle((int)textures.size());
+}
+
+MeshHandle Renderer::createMesh()
+{
+    Mesh mesh = { NULL, 0, 0, 0 };
+    meshes.push_back(mesh);
+    return MeshHandle((int)meshes.size());
+}
+
+MeshHandle Renderer::createMesh(const void* data, size_t bytes, const VertexAttribute* attributes, int attributeCount, int vertexCount)
+{
+    MeshHandle handle = createMesh();
+    uploadMesh(handle, data, bytes, attributes, attributeCount, vertexCount);
+    return handle;
+}
+
+void Renderer::uploadMesh(MeshHandle handle, const void* data, size_t bytes, const VertexAttribute* attributes, int attributeCount, int vertexCount)
+{
+    // Prepisivanje u format arene; atributi kojih nema (ili su van bafera) ostaju nula, kao kad je niz iskljucen
+    static const int slotOffset[3] = { 0, 3, 5 };
+    static const int slotSize[3] = { 3, 2, 3 };
+    arenaScratch.assign((size_t)vertexCount * ARENA_FLOATS, 0.0f);
+    for (int i = 0; i < attributeCount; ++i) {
+        const VertexAttribute& attribute = attributes[i];
+        if (attribute.index > 2) {
+            continue;
+        }
+        int size = std::min((int)attribute.size, slotSize[attribute.index]);
+        size_t stride = attribute.stride != 0 ? attribute.stride : attribute.size * sizeof(float);
+        for (int v = 0; v < vertexCount; ++v) {
+            size_t offset = attribute.offset + v * stride;
+            if (offset + size * sizeof(float) > bytes) {
+                break;
+            }
+            memcpy(&arenaScratch[(size_t)v * ARENA_FLOATS + slotOffset[attribute.index]], (const char*)data + offset, size * sizeof(float));
+        }
+    }
+
+    uploadMeshVertices(handle, arenaScratch.data(), vertexCount);
+}
+
+void Renderer::uploadMeshVertices(MeshHandle handle, const float* vertices, int vertexCount)
+{
+    Mesh& mesh = meshes[handle.id - 1];
+    mesh.firstVertex = appendToArena(vertices, vertexCount);
+    mesh.vertexCount = vertexCount;
+}
+
+int Renderer::appendToArena(const float* vertices, int vertexCount)
+{
+    const GLsizeiptr stride = ARENA_FLOATS * sizeof(float);
+    invalidateState();
+
+    if (arenaVertices + vertexCount > arenaCapacity) {
+        // Novi veci bafer i kopija na GPU-u; mreze zadrzavaju svoje pomeraje
+        int capacity = std::max(arenaVertices + vertexCount, std::max(arenaCapacity * 2, 65536));
+        GLuint buffer;
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, capacity * stride, NULL, GL_STATIC_DRAW);
+        if (arenaVertices > 0) {
+            glBindBuffer(GL_COPY_READ_BUFFER, arenaVBO);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, arenaVertices * stride);
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        if (arenaVBO != 0) {
+            glDeleteBuffers(1, &arenaVBO);
+        }
+        arenaVBO = buffer;
+        arenaCapacity = capacity;
+        setArenaPointers();
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, arenaVBO);
+    glBufferSubData(GL_ARRAY_BUFFER, arenaVertices * stride, vertexCount * stride, vertices);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    int first = arenaVertices;
+    arenaVertices += vertexCount;
+    return first;
+}
+
+void Renderer::setArenaPointers()
+{
+    // VAO pamti ime bafera, pa se posle zamene VBO-a atributi ponovo usmeravaju
+    const GLsizei stride = ARENA_FLOATS * sizeof(float);
+    glBindVertexArray(arenaVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, arenaVBO);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, (void*)(5 * sizeof(float)));
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+void Renderer::attachDrawId(GLuint vao)
+{
+    // Obicno crtanje je instanca 0 sa baseInstance 0, pa atribut daje 0 i vazi samo uDrawId
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, drawIdBuffer);
+    glVertexAttribPointer(DRAW_ID_LOCATION, 1, GL_FLOAT, GL_FALSE, 0, (void*)0);
+    glVertexAttribDivisor(DRAW_ID_LOCATION, 1);
+    glEnableVertexAttribArray(DRAW_ID_LOCATION);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+    invalidateState();
+}
+
+void Renderer::reserveDrawIds(int count)
+{
+    if (count <= drawIdCount) {
+        return;
+    }
+    // Isto ime bafera, pa VAO-i kojima je atribut vec dodat ne moraju da se menjaju
+    vector<float> ids(count);
+    for (int i = 0; i < count; ++i) {
+        ids[i] = (float)i;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, drawIdBuffer);
+    glBufferData(GL_ARRAY_BUFFER, count * sizeof(float), ids.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    drawIdCount = count;
+}
+
+MeshHandle Renderer::registerMesh(const GLuint* vao)
+{
+    Mesh mesh = { vao, 0, 0, 0 };
+    meshes.push_back(mesh);
+    return MeshHandle((int)meshes.size());
+}
+
+bool Renderer::isMeshReady(MeshHandle handle) const
+{
+    return meshVAO(handle) != 0;
+}
+
+int Renderer::meshVertexCount(MeshHandle handle) const
+{
+    return handle.isValid() ? meshes[handle.id - 1].vertexCount : 0;
+}
+
+GLuint Renderer::meshVAO(MeshHandle handle) const
+{
+    if (!handle.isValid()) {
+        return 0;
+    }
+    const Mesh& mesh = meshes[handle.id - 1];
+    if (mesh.externalVAO != NULL) {
+        return *mesh.externalVAO;
+    }
+    return mesh.vertexCount > 0 ? arenaVAO : 0;
+}
+
+int Renderer::meshFirstVertex(MeshHandle handle) const
+{
+    return handle.isValid() ? meshes[handle.id - 1].firstVertex : 0;
+}
+
+GLuint Renderer::meshVertexBuffer(MeshHandle handle) const
+{
+    if (!handle.isValid() || meshes[handle.id - 1].externalVAO != NULL) {
+        return 0;
+    }
+    return meshes[handle.id - 1].vertexCount > 0 ? arenaVBO : 0;
+}
+
+GLuint Renderer::programId(ProgramHandle handle) const
+{
+    return handle.isValid() ? programs[handle.id - 1].name : 0;
+}
+
+GLint Renderer::uniformLocation(Program& program, const char* name)
+{
+    map<const char*, GLint>::iterator found = program.locations.find(name);
+    if (found != program.locations.end()) {
+        return found->second;
+    }
+    GLint location = glGetUniformLocation(program.name, name);
+    program.locations[name] = location;
+    return location;
+}
+
+void Renderer::applyUniform(GLint location, const UniformValue& value)
+{
+    if (location == -1) {
+        return;
+    }
+    switch (value.type) {
+    case UniformValue::UNIFORM_INT:
+        glUniform1i(location, value.intValue);
+        break;
+    case UniformValue::UNIFORM_FLOAT:
+        glUniform1f(location, value.values[0]);
+        break;
+    case UniformValue::UNIFORM_VEC2:
+        glUniform2f(location, value.values[0], value.values[1]);
+        break;
+    case UniformValue::UNIFORM_VEC3:
+        glUniform3f(location, value.values[0], value.values[1], value.values[2]);
+        break;
+    case UniformValue::UNIFORM_MAT4:
+        glUniformMatrix4fv(location, 1, GL_FALSE, value.values);
+        break;
+    }
+}
+
+void Renderer::setUniform(ProgramHandle handle, const char* name, const UniformValue& value)
+{
+    // Van execute ne zna se koji je program aktivan
+    invalidateState();
+    applyUniformCommand(handle, name, value);
+}
+
+void Renderer::applyUniformCommand(ProgramHandle handle, const char* name, const UniformValue& value)
+{
+    if (!handle.isValid()) {
+        return;
+    }
+    Program& program = programs[handle.id - 1];
+    bindProgram(program.name);
+    applyUniform(uniformLocation(program, name), value);
+}
+
+void Renderer::bindProgram(GLuint program)
+{
+    if (program != currentProgram) {
+        glUseProgram(program);
+        currentProgram = program;
+        stateChangeCount++;
+    }
+}
+
+void Renderer::bindVertexArray(GLuint vao)
+{
+    if (vao != currentVAO) {
+        glBindVertexArray(vao);
+        currentVAO = vao;
+        stateChangeCount++;
+    }
+}
+
+void Renderer::bindTexture(const Texture* texture)
+{
+    GLuint name = texture != NULL ? *texture->name : 0;
+    GLenum target = texture != NULL ? texture->target : GL_TEXTURE_2D;
+    if (name != currentTexture || target != currentTextureTarget) {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(target, name);
+        currentTexture = name;
+        currentTextureTarget = target;
+        stateChangeCount++;
+    }
+}
+
+void Renderer::applyCull(CullMode cull, bool frontFaceCW)
+{
+    if ((int)cull != currentCull) {
+        if (cull == CULL_NONE) {
+            glDisable(GL_CULL_FACE);
+        }
+        else {
+            glEnable(GL_CULL_FACE);
+            glCullFace(cull == CULL_FRONT ? GL_FRONT : GL_BACK);
+        }
+        currentCull = (int)cull;
+        stateChangeCount++;
+    }
+    int frontFace = frontFaceCW ? 1 : 0;
+    if (frontFace != currentFrontFace) {
+        glFrontFace(frontFaceCW ? GL_CW : GL_CCW);
+        currentFrontFace = frontFace;
+        stateChangeCount++;
+    }
+}
+
+bool Renderer::bindDrawState(const DrawCommand& draw)
+{
+    GLuint vao = meshVAO(draw.mesh);
+    if (vao == 0) {
+        return false; // Mreza se jos ucitava
+    }
+    Mesh& mesh = meshes[draw.mesh.id - 1];
+    if (mesh.externalVAO != NULL && mesh.drawIdVAO != vao) {
+        attachDrawId(vao);
+        mesh.drawIdVAO = vao;
+    }
+
+    Program& program = programs[draw.program.id - 1];
+    bindProgram(program.name);
+    bindVertexArray(vao);
+    if (draw.texture.isValid()) {
+        bindTexture(&textures[draw.texture.id - 1]);
+    }
+    applyCull(draw.cull, draw.frontFaceCW);
+    if (program.drawIdLoc != -1 && !drawDataBound) {
+        drawData.bind(DRAW_DATA_UNIT);
+        drawDataBound = true;
+    }
+    return true;
+}
+
+void Renderer::executeDraw(const DrawCommand& draw, int drawId)
+{
+    if (!bindDrawState(draw)) {
+        return;
+    }
+
+    Program& program = programs[draw.program.id - 1];
+    if (program.drawIdLoc != -1) {
+        glUniform1i(program.drawIdLoc, drawId);
+    }
+    else {
+        if (program.modelLoc != -1) {
+            glUniformMatrix4fv(program.modelLoc, 1, GL_FALSE, value_ptr(draw.model));
+        }
+        if (program.colorLoc != -1) {
+            glUniform3f(program.colorLoc, draw.color.x, draw.color.y, draw.color.z);
+        }
+        if (program.alphaLoc != -1) {
+            glUniform1f(program.alphaLoc, draw.alpha);
+        }
+    }
+
+    if (draw.indexType != GL_NONE) {
+        glDrawElementsBaseVertex(draw.primitive, draw.count, draw.indexType, (void*)draw.indexOffset, draw.baseVertex);
+    }
+    else {
+        glDrawArrays(draw.primitive, meshes[draw.mesh.id - 1].firstVertex + draw.first, draw.count);
+    }
+    drawCallCount++;
+    submittedDrawCount++;
+}
+
+bool Renderer::canBatch(const DrawCommand& a, const DrawCommand& b) const
+{
+    // Po crtanju se menja samo indeks crtanja, pa program mora da cita uDrawData
+    return a.program.id == b.program.id && programs[a.program.id - 1].drawIdLoc != -1 &&
+        meshVAO(a.mesh) == meshVAO(b.mesh) && a.texture.id == b.texture.id &&
+        a.cull == b.cull && a.frontFaceCW == b.frontFaceCW &&
+        a.primitive == b.primitive && a.indexType == b.indexType;
+}
+
+size_t Renderer::writeDrawData(const CommandBuffer& commands, const vector<CommandBuffer::Command>& list, size_t begin, int remaining)
+{
+    // Crtanja redom kojim se izvrsavaju, dok ima mesta u prstenu; vraca kraj pokrivenog dela liste
+    int firstDraw = 0;
+    int granted = 0;
+    InstanceRing::DrawData* data = drawData.allocate(remaining, firstDraw, granted);
+    int written = 0;
+    size_t i = begin;
+    for (; i < list.size() && written < granted; ++i) {
+        if (list[i].type != CommandBuffer::COMMAND_DRAW) {
+            continue;
+        }
+        assert(written < granted);
+        const DrawCommand& draw = commands.getDraw(list[i].index);
+        data[written].model = draw.model;
+        data[written].colorAlpha = vec4(draw.color, draw.alpha);
+        data[written].translation = vec4(draw.translation.x, draw.translation.y, (float)draw.material, 0.0f);
+        drawSlots[i] = firstDraw + written;
+        written++;
+    }
+    drawData.commit();
+    return i;
+}
+
+void Renderer::executeBatch(const CommandBuffer& commands, const vector<CommandBuffer::Command>& list, size_t begin, size_t end)
+{
+    const DrawCommand& head = commands.getDraw(list[begin].index);
+    if (!multiDrawIndirect || end - begin == 1) {
+        // Stanje je isto za celu grupu, pa je posle prvog crtanja po crtanju samo uDrawId i glDraw*
+        for (size_t i = begin; i < end; ++i) {
+            executeDraw(commands.getDraw(list[i].index), drawSlots[i]);
+        }
+        return;
+    }
+    if (!bindDrawState(head)) {
+        return;
+    }
+    glUniform1i(programs[head.program.id - 1].drawIdLoc, 0);
+
+    // DrawArraysIndirectCommand { count, instanceCount, first, baseInstance }
+    // DrawElementsIndirectCommand { count, instanceCount, firstIndex, baseVertex, baseInstance }
+    GLuint indexSize = head.indexType == GL_UNSIGNED_INT ? 4 : (head.indexType == GL_UNSIGNED_SHORT ? 2 : 1);
+    indirectScratch.clear();
+    for (size_t i = begin; i < end; ++i) {
+        const DrawCommand& draw = commands.getDraw(list[i].index);
+        indirectScratch.push_back((GLuint)draw.count);
+        indirectScratch.push_back(1);
+        if (head.indexType != GL_NONE) {
+            indirectScratch.push_back((GLuint)(draw.indexOffset / indexSize));
+            indirectScratch.push_back((GLuint)draw.baseVertex);
+        }
+        else {
+            indirectScratch.push_back((GLuint)(meshes[draw.mesh.id - 1].firstVertex + draw.first));
+        }
+        indirectScratch.push_back((GLuint)drawSlots[i]);
+    }
+
+    GLsizei drawCount = (GLsizei)(end - begin);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, indirectScratch.size() * sizeof(GLuint), indirectScratch.data(), GL_STREAM_DRAW);
+    if (head.indexType != GL_NONE) {
+        glMultiDrawElementsIndirect(head.primitive, head.indexType, (void*)0, drawCount, 0);
+    }
+    else {
+        glMultiDrawArraysIndirect(head.primitive, (void*)0, drawCount, 0);
+    }
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    drawCallCount++;
+    submittedDrawCount += drawCount;
+}
+
+int Renderer::addMaterials(const ModelMaterial* materials, int count)
+{
+    return materialTable.add(materials, count);
+}
+
+void Renderer::setMaterialTexture(int material, int layer, const vec4& rect)
+{
+    materialTable.setTexture(material, layer, rect);
+}
+
+void Renderer::beginFrame(int drawCount)
+{
+    // Jedinicu MATERIAL_UNIT ne koristi niko drugi, pa tabela ostaje vezana i za module koji sami crtaju
+    materialTable.bind(MATERIAL_UNIT);
+    drawData.beginFrame(drawCount);
+    reserveDrawIds(drawData.drawIndexCount());
+}
+
+void Renderer::endFrame()
+{
+    drawData.endFrame();
+}
+
+void Renderer::execute(const CommandBuffer& commands)
+{
+    // GL stanje je mozda menjao kod van Renderer-a (moduli, upload-i), pa se kes ne prenosi izmedju poziva
+    invalidateState();
+
+    // Podaci crtanja se upisuju odjednom za ceo bafer, a ako ne staju u prsten, u delovima od najvise
+    // drawCapacity() crtanja; grupa za multi-draw se tada deli na granici dela
+    const vector<CommandBuffer::Command>& list = commands.getCommands();
+    drawSlots.resize(list.size());
+    int remaining = commands.drawCount();
+    size_t written = 0;     // komande [0, written) imaju upisane podatke
+    for (size_t i = 0; i < list.size(); ++i) {
+        const CommandBuffer::Command& command = list[i];
+        switch (command.type) {
+        case CommandBuffer::COMMAND_DRAW: {
+            if (i >= written) {
+                size_t begin = i;
+                written = writeDrawData(commands, list, begin, remaining);
+                for (size_t j = begin; j < written; ++j) {
+                    remaining -= list[j].type == CommandBuffer::COMMAND_DRAW ? 1 : 0;
+                }
+            }
+            // Niz uzastopnih crtanja koja se razlikuju samo po podacima iz uDrawData
+            size_t end = i + 1;
+            while (end < written && list[end].type == CommandBuffer::COMMAND_DRAW &&
+                canBatch(commands.getDraw(command.index), commands.getDraw(list[end].index))) {
+                ++end;
+            }
+            executeBatch(commands, list, i, end);
+            i = end - 1;
+            break;
+        }
+        case CommandBuffer::COMMAND_UNIFORM: {
+            const CommandBuffer::UniformCommand& uniform = commands.getUniform(command.index);
+            applyUniformCommand(uniform.program, uniform.name, uniform.value);
+            break;
+        }
+        case CommandBuffer::COMMAND_CLEAR: {
+            const CommandBuffer::ClearCommand& clear = commands.getClear(command.index);
+            glClearColor(clear.color.x, clear.color.y, clear.color.z, clear.color.w);
+            glClear(clear.mask);
+            break;
+        }
+        case CommandBuffer::COMMAND_CALLBACK:
+            commands.getCallback(command.index)();
+            invalidateState();
+            break;
+        }
+    }
+
+    // Kod posle prolaza ocekuje podrazumevano odsecanje
+    applyCull(CULL_BACK, false);
+}
+
+void Renderer::invalidateState()
+{
+    // Nepoznata vrednost - sledeca komanda ce je sigurno postaviti
+    currentProgram = (GLuint)-1;
+    currentVAO = (GLuint)-1;
+    currentTexture = (GLuint)-1;
+    currentCull = -1;
+    currentFrontFace = -1;
+    drawDataBound = false;
+}
+
+void Renderer::resetStats()
+{
+    drawCallCount = 0;
+    stateChangeCount = 0;
+    submittedDrawCount = 0;
+}
+
+void Renderer::release()
+{
+    if (arenaVAO != 0) {
+        glDeleteVertexArrays(1, &arenaVAO);
+        glDeleteBuffers(1, &arenaVBO);
+        arenaVAO = arenaVBO = 0;
+        arenaVertices = arenaCapacity = 0;
+    }
+    glDeleteBuffers(1, &drawIdBuffer);
+    glDeleteBuffers(1, &indirectBuffer);
+    drawIdBuffer = indirectBuffer = 0;
+    drawIdCount = 0;
+    for (Texture& texture : textures) {
+        if (*texture.name != 0) {
+            glDeleteTextures(1, texture.name);
+        }
+    }
+    for (Program& program : programs) {
+        glDeleteProgram(program.name);
+    }
+    meshes.clear();
+    textures.clear();
+    programs.clear();
+    drawData.release();
+    materialTable.release();
+    invalidateState();
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "CommandBuffer.h"
+#include "InstanceRing.h"
+#include "MaterialTable.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <map>
+#include <vector>
+
+// Atribut temena za createMesh/uploadMesh (uvek GL_FLOAT); index 0 = pozicija, 1 = UV, 2 = normala
+struct VertexAttribute {
+    GLuint index;
+    GLint size;
+    GLsizei stride;
+    size_t offset;
+};
+
+// Jedino mesto koje od komandi pravi GL pozive. Drzi tabele resursa (mreze, teksture, programi) iza rucki,
+// kesira lokacije uniformi i trenutno stanje (program, VAO, tekstura, odsecanje lica), pa se ponovljena
+// stanja ne salju drajveru. Programi sa uDrawData citaju matricu, boju i pomeraj iz InstanceRing-a,
+// pa je po crtanju samo uDrawId; ostalima se uM, color i uAlpha postavljaju uniformama. Indeks materijala
+// crtanja ide u iste podatke, a materijali su u MaterialTable (uMaterials).
+// Sve mreze iz createMesh/uploadMesh su opsezi jedne arene temena (jedan VAO i VBO, pozicija, UV i
+// normala prepleteni), pa se izmedju modela ne menja VAO. Uzastopna crtanja sa istim programom, VAO-om,
+// teksturom i odsecanjem idu jednim glMultiDraw*Indirect pozivom: indeks crtanja stize preko
+// baseInstance u atribut DRAW_ID_LOCATION (delilac 1). Bez ARB_multi_draw_indirect + ARB_base_instance
+// (GL 3.3) ista grupa se crta petljom glDraw* poziva sa uDrawId, bez promena stanja izmedju njih.
+// Vlasnistvo: arena, registrovani programi i teksture se brisu u release();
+// registerMesh je samo pozajmica VAO-a nekog modula (npr. Terrain), koji ga sam brise.
+class Renderer
+{
+public:
+    Renderer();
+
+    Renderer(const Renderer&) = delete;
+    Renderer& operator=(const Renderer&) = delete;
+
+    // Jedinica teksture za uDrawData (0 je tekstura komande, 1 i 2 virtuelna tekstura mape)
+    static const GLuint DRAW_DATA_UNIT = 3;
+    // Jedinica za uMaterials (tabela materijala); drzi se vezana ceo frejm
+    static const GLuint MATERIAL_UNIT = 4;
+    // Atribut sa indeksom crtanja za multi-draw (shader: uDrawId + inDrawId)
+    static const GLuint DRAW_ID_LOCATION = 7;
+    // Teme arene: pozicija (3), UV (2), normala (3)
+    static const int ARENA_FLOATS = 8;
+
+    // Podrazumevano stanje: test dubine, odsecanje zadnjih lica, bez mesanja
+    void init();
+
+    ProgramHandle registerProgram(GLuint program);
+    // Preko pokazivaca, jer TextureAtlas zamenjuje teksturu kad atlas stigne
+    TextureHandle registerTexture(const GLuint* texture, GLenum target = GL_TEXTURE_2D);
+
+    // Prazna mreza (npr. dok se model ucitava) - draw komande nad njom se preskacu dok ne stignu podaci
+    MeshHandle createMesh();
+    MeshHandle createMesh(const void* data, size_t bytes, const VertexAttribute* attributes, int attributeCount, int vertexCount);
+    // Temena se prepisuju u format arene i dodaju na njen kraj (ponovni upload ostavlja stari opseg neiskoriscen)
+    void uploadMesh(MeshHandle mesh, const void* data, size_t bytes, const VertexAttribute* attributes, int attributeCount, int vertexCount);
+    // Temena vec u formatu arene (ARENA_FLOATS po temenu) - kopiraju se pravo u bafer, bez prepisivanja
+    void uploadMeshVertices(MeshHandle mesh, const float* vertices, int vertexCount);
+    // VAO koji pravi i brise modul; cita se pri svakom crtanju (moze biti 0 dok se ne ucita)
+    MeshHandle registerMesh(const GLuint* vao);
+
+    bool isMeshReady(MeshHandle mesh) const;
+    int meshVertexCount(MeshHandle mesh) const;
+    GLuint meshVAO(MeshHandle mesh) const;
+    // Prvo teme mreze u VAO-u (za module koji sami crtaju iz arene, npr. Impostor)
+    int meshFirstVertex(MeshHandle mesh) const;
+    // VBO arene (0 za registerMesh); menja se kad arena poraste
+    GLuint meshVertexBuffer(MeshHandle mesh) const;
+    bool isMultiDrawIndirect() const { return multiDrawIndirect; }
+    GLuint programId(ProgramHandle program) const;
+
+    // Materijali modela (render nit, pri upload-u); vraca indeks prvog za DrawCommand::material
+    int addMaterials(const ModelMaterial* materials, int count);
+    int materialCount() const { return materialTable.materialCount(); }
+    // Sloj i UV pravougaonik teksture materijala u TextureAtlas-u
+    void setMaterialTexture(int material, int layer, const glm::vec4& rect);
+
+    // Odmah (za uniforme koje se postavljaju jednom, pri pokretanju)
+    void setUniform(ProgramHandle program, const char* name, const UniformValue& value);
+
+    // Oko svih execute poziva jednog frejma; drawCount je broj crtanja u svim CommandBuffer-ima frejma
+    void beginFrame(int drawCount);
+    void execute(const CommandBuffer& commands);
+    void endFrame();
+    // Posle GL koda van Renderer-a (callback) kesirano stanje vise ne vazi
+    void invalidateState();
+
+    void resetStats();
+    int drawCalls() const { return drawCallCount; }
+    int stateChanges() const { return stateChangeCount; }
+    // Crtanja iz komandi (drawCalls su GL pozivi, sa multi-draw ih je manje)
+    int submittedDraws() const { return submittedDrawCount; }
+
+    void release();
+
+private:
+    struct Mesh {
+        const GLuint* externalVAO;
+        GLuint drawIdVAO;       // eksterni VAO kome je vec dodat atribut indeksa crtanja
+        int firstVertex;        // u areni
+        int vertexCount;        // 0 = jos se ucitava
+    };
+
+
+    struct Texture {
+        const GLuint* name;
+        GLenum target;
+    };
+
+    struct Program {
+        GLuint name;
+        GLint modelLoc;
+        GLint colorLoc;
+        GLint alphaLoc;
+        GLint drawIdLoc;        // -1 = program ne cita uDrawData
+        std::map<const char*, GLint> locations;     // kes po adresi imena
+    };
+
+    GLint uniformLocation(Program& program, const char* name);
+    void applyUniform(GLint location, const UniformValue& value);
+    void applyUniformCommand(ProgramHandle program, const char* name, const UniformValue& value);
+    void bindProgram(GLuint program);
+    void bindVertexArray(GLuint vao);
+    void bindTexture(const Texture* texture);
+    void applyCull(CullMode cull, bool frontFaceCW);
+    int appendToArena(const float* vertices, int vertexCount);
+    void setArenaPointers();
+    void attachDrawId(GLuint vao);
+    void reserveDrawIds(int count);
+    bool canBatch(const DrawCommand& a, const DrawCommand& b) const;
+    bool bindDrawState(const DrawCommand& draw);
+    void executeDraw(const DrawCommand& draw, int drawId);
+    size_t writeDrawData(const CommandBuffer& commands, const std::vector<CommandBuffer::Command>& list, size_t begin, int remaining);
+    void executeBatch(const CommandBuffer& commands, const std::vector<CommandBuffer::Command>& list, size_t begin, size_t end);
+
+    std::vector<Mesh> meshes;
+    std::vector<Texture> textures;
+    std::vector<Program> programs;
+    InstanceRing drawData;
+    MaterialTable materialTable;
+
+    GLuint arenaVAO;
+    GLuint arenaVBO;
+    int arenaVertices;
+    int arenaCapacity;
+    std::vector<float> arenaScratch;
+
+    GLuint drawIdBuffer;        // 0, 1, 2... - instancirani atribut cita element baseInstance
+    int drawIdCount;
+    GLuint indirectBuffer;
+    std::vector<GLuint> indirectScratch;
+    std::vector<int> drawSlots;         // indeks u InstanceRing-u za svaku komandu crtanja (po mestu u listi)
+    bool multiDrawIndirect;
+
+    GLuint currentProgram;
+    GLuint currentVAO;
+    GLuint currentTexture;
+    GLenum currentTextureTarget;
+    int currentCull;            // -1 = nepoznato
+    int currentFrontFace;       // -1 = nepoznato, 0 = CCW, 1 = CW
+    bool drawDataBound;
+
+    int drawCallCount;
+    int stateChangeCount;
+    int submittedDrawCount;
+};
@@ -0,0 +1,549 @@
+#include "SoftwareRenderer.h"
+
+#include <emmintrin.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+using namespace std;
+using namespace glm;
+
+// ------------------------------------------------------------------------------------------------
+// SSE2 pomocne funkcije (4 piksela odjednom)
+
+struct Vec3x4 {
+    __m128 x, y, z;
+};
+
+static inline __m128 dot3(const Vec3x4& a, const Vec3x4& b)
+{
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a.x, b.x), _mm_mul_ps(a.y, b.y)), _mm_mul_ps(a.z, b.z));
+}
+
+static inline Vec3x4 normalize3(const Vec3x4& v)
+{
+    __m128 invLength = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(_mm_max_ps(dot3(v, v), _mm_set1_ps(1e-20f))));
+    Vec3x4 result = { _mm_mul_ps(v.x, invLength), _mm_mul_ps(v.y, invLength), _mm_mul_ps(v.z, invLength) };
+    return result;
+}
+
+// reflect(-l, n) = 2 * dot(n, l) * n - l
+static inline Vec3x4 reflectNegated(const Vec3x4& l, const Vec3x4& n)
+{
+    __m128 twoDot = _mm_mul_ps(_mm_set1_ps(2.0f), dot3(n, l));
+    Vec3x4 result = { _mm_sub_ps(_mm_mul_ps(twoDot, n.x), l.x), _mm_sub_ps(_mm_mul_ps(twoDot, n.y), l.y), _mm_sub_ps(_mm_mul_ps(twoDot, n.z), l.z) };
+    return result;
+}
+
+static inline __m128 interpolate(__m128 l0, __m128 l1, __m128 l2, float a0, float a1, float a2)
+{
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(l0, _mm_set1_ps(a0)), _mm_mul_ps(l1, _mm_set1_ps(a1))), _mm_mul_ps(l2, _mm_set1_ps(a2)));
+}
+
+static inline __m128 floor4(__m128 x)
+{
+    __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+    return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, x), _mm_set1_ps(1.0f)));
+}
+
+// log2 za x > 0: eksponent + red za atanh ((m - 1) / (m + 1)), greska ~2e-5
+static inline __m128 log2x4(__m128 x)
+{
+    __m128i bits = _mm_castps_si128(x);
+    __m128 exponent = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+    __m128 mantissa = _mm_or_ps(_mm_castsi128_ps(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF))), _mm_set1_ps(1.0f));
+    __m128 t = _mm_div_ps(_mm_sub_ps(mantissa, _mm_set1_ps(1.0f)), _mm_add_ps(mantissa, _mm_set1_ps(1.0f)));
+    __m128 t2 = _mm_mul_ps(t, t);
+    __m128 series = _mm_add_ps(_mm_set1_ps(1.0f / 5.0f), _mm_mul_ps(t2, _mm_set1_ps(1.0f / 7.0f)));
+    series = _mm_add_ps(_mm_set1_ps(1.0f / 3.0f), _mm_mul_ps(t2, series));
+    series = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(t2, series));
+    return _mm_add_ps(exponent, _mm_mul_ps(_mm_mul_ps(t, series), _mm_set1_ps(2.0f / 0.69314718f)));
+}
+
+// 2^x: ceo deo ide direktno u eksponent, razlomljeni deo polinomom (relativna greska ~2e-4)
+static inline __m128 exp2x4(__m128 x)
+{
+    x = _mm_max_ps(_mm_min_ps(x, _mm_set1_ps(126.0f)), _mm_set1_ps(-126.0f));
+    __m128 whole = floor4(x);
+    __m128 f = _mm_sub_ps(x, whole);
+    __m128 poly = _mm_add_ps(_mm_set1_ps(0.224494337f), _mm_mul_ps(f, _mm_set1_ps(0.07944023841f)));
+    poly = _mm_add_ps(_mm_set1_ps(0.6960656421f), _mm_mul_ps(f, poly));
+    poly = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(f, poly));
+    __m128i scale = _mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(whole), _mm_set1_epi32(127)), 23);
+    return _mm_mul_ps(poly, _mm_castsi128_ps(scale));
+}
+
+// pow(max(x, 0), shine) kao u shaderu (pow(0, y) = 0)
+static inline __m128 specularPow(__m128 x, float shine)
+{
+    __m128 positive = _mm_cmpgt_ps(x, _mm_setzero_ps());
+    __m128 result = exp2x4(_mm_mul_ps(log2x4(_mm_max_ps(x, _mm_set1_ps(1e-30f))), _mm_set1_ps(shine)));
+    return _mm_and_ps(result, positive);
+}
+
+static inline uint32_t packColor(float r, float g, float b)
+{
+    r = std::min(std::max(r, 0.0f), 1.0f);
+    g = std::min(std::max(g, 0.0f), 1.0f);
+    b = std::min(std::max(b, 0.0f), 1.0f);
+    return (uint32_t)(r * 255.0f + 0.5f) | ((uint32_t)(g * 255.0f + 0.5f) << 8) | ((uint32_t)(b * 255.0f + 0.5f) << 16) | 0xFF000000u;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+SoftwareRenderer::SoftwareRenderer(int frameWidth, int frameHeight, int threadsToUse)
+    : width(frameWidth), height(frameHeight), threadCount(threadsToUse), triangleCount(0),
+      viewProjection(1.0f), viewPosition(0.0f)
+{
+    if (threadCount <= 0) {
+        threadCount = std::max((int)thread::hardware_concurrency(), 1);
+    }
+
+    // Baferi su prosireni na cele plocice, pa grupe od 4 piksela nikad ne izlaze iz njih
+    tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+    stride = tilesX * TILE_SIZE;
+    colorBuffer.assign(stride * tilesY * TILE_SIZE, 0xFF000000u);
+    depthBuffer.assign(stride * tilesY * TILE_SIZE, 1.0f);
+    threadBins.resize(threadCount);
+
+    Material defaultMaterial = { vec3(0.2f), vec3(0.5f), vec3(0.7f), 132.0f };
+    material = defaultMaterial;
+    Light noLight = { vec3(0.0f), vec3(0.0f, 1.0f, 0.0f), 1.0f, vec3(0.0f), vec3(0.0f), vec3(0.0f) };
+    reflector = noLight;
+}
+
+void SoftwareRenderer::setCamera(const mat4& view, const mat4& projection, const vec3& cameraPosition)
+{
+    viewProjection = projection * view;
+    viewPosition = cameraPosition;
+}
+
+SoftwareRenderer::Material SoftwareRenderer::fromModelMaterial(const ModelMaterial& material)
+{
+    Material result = { material.ambient, material.diffuse, material.specular, material.shininess, material.emissive, material.opacity };
+    return result;
+}
+
+void SoftwareRenderer::setMaterial(const Material& newMaterial)
+{
+    material = newMaterial;
+}
+
+void SoftwareRenderer::setReflector(const Light& newReflector)
+{
+    reflector = newReflector;
+    reflector.dir = normalize(reflector.dir);
+}
+
+void SoftwareRenderer::clear(const vec3& color)
+{
+    std::fill(colorBuffer.begin(), colorBuffer.end(), packColor(color.x, color.y, color.z));
+    std::fill(depthBuffer.begin(), depthBuffer.end(), 1.0f);
+}
+
+void SoftwareRenderer::drawBase(const vec3* positions, const vec3* normals, int first, int count, const mat4& model,
+                                const Material& baseMaterial, const vec3& color, float opacity, bool cullBackFaces)
+{
+    if (count < 3) {
+        return;
+    }
+    DrawCommand command;
+    command.shading = SHADING_BASE;
+    command.positions = positions;
+    command.normals = normals;
+    command.textureCoords = NULL;
+    command.first = first;
+    command.count = count - count % 3;
+    command.model = model;
+    command.normalMatrix = mat3(transpose(inverse(model)));
+    command.color = color;
+    command.opacity = opacity * baseMaterial.opacity;
+    command.cullBackFaces = cullBackFaces;
+    command.texture = NULL;
+    command.material = baseMaterial;
+    command.reflector = reflector;
+    commands.push_back(command);
+}
+
+void SoftwareRenderer::drawTextured(const vec3* positions, const vec3* normals, const vec2* textureCoords, int first, int count,
+                                    const mat4& model, const SoftwareTexture* texture, bool cullBackFaces)
+{
+    if (count < 3 || texture == NULL || texture->rgba.empty()) {
+        return;
+    }
+    DrawCommand command;
+    command.shading = SHADING_TEXTURE;
+    command.positions = positions;
+    command.normals = normals;
+    command.textureCoords = textureCoords;
+    command.first = first;
+    command.count = count - count % 3;
+    command.model = model;
+    command.normalMatrix = mat3(transpose(inverse(model)));
+    command.color = vec3(1.0f);
+    command.opacity = 1.0f;
+    command.cullBackFaces = cullBackFaces;
+    command.texture = texture;
+    command.material = material;
+    command.reflector = reflector;
+    commands.push_back(command);
+}
+
+void SoftwareRenderer::finish()
+{
+    if (commands.empty()) {
+        triangleCount = 0;
+        return;
+    }
+
+    // Neprovidni pozivi idu pre providnih, a providni zadrzavaju svoj redosled
+    stable_partition(commands.begin(), commands.end(), [](const DrawCommand& command) { return command.opacity >= 1.0f; });
+
+    commandTriangleStart.resize(commands.size() + 1);
+    commandTriangleStart[0] = 0;
+    for (size_t i = 0; i < commands.size(); ++i) {
+        commandTriangleStart[i + 1] = commandTriangleStart[i] + commands[i].count / 3;
+    }
+    triangleCount = commandTriangleStart.back();
+
+    for (ThreadBins& bins : threadBins) {
+        bins.triangles.clear();
+        bins.tiles.resize(tilesX * tilesY);
+        for (vector<int>& tile : bins.tiles) {
+            tile.clear();
+        }
+    }
+
+    // 1. i 2. korak: svaka nit priprema uzastopan deo trouglova i razvrstava ga po plocicama.
+    // Plocica kasnije obilazi niti redom, pa je redosled crtanja ocuvan.
+    vector<thread> workers;
+    for (int t = 1; t < threadCount; ++t) {
+        workers.emplace_back(&SoftwareRenderer::setupTriangles, this, t,
+                             (int)((long long)triangleCount * t / threadCount), (int)((long long)triangleCount * (t + 1) / threadCount));
+    }
+    setupTriangles(0, 0, (int)((long long)triangleCount / threadCount));
+    for (thread& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+
+    // 3. korak: niti uzimaju plocice dok ih ima (plocice se ne preklapaju, pa nema zakljucavanja)
+    atomic<int> nextTile(0);
+    int tileCount = tilesX * tilesY;
+    auto rasterizeTiles = [this, &nextTile, tileCount]() {
+        for (int tile = nextTile++; tile < tileCount; tile = nextTile++) {
+            rasterizeTile(tile);
+        }
+    };
+    for (int t = 1; t < threadCount; ++t) {
+        workers.emplace_back(rasterizeTiles);
+    }
+    rasterizeTiles();
+    for (thread& worker : workers) {
+        worker.join();
+    }
+
+    commands.clear();
+}
+
+void SoftwareRenderer::setupTriangles(int thread, int firstTriangle, int lastTriangle)
+{
+    ThreadBins& bins = threadBins[thread];
+    if (firstTriangle >= lastTriangle) {
+        return;
+    }
+
+    int command = (int)(upper_bound(commandTriangleStart.begin(), commandTriangleStart.end(), firstTriangle) - commandTriangleStart.begin()) - 1;
+    for (int triangle = firstTriangle; triangle < lastTriangle; ++triangle) {
+        while (triangle >= commandTriangleStart[command + 1]) {
+            ++command;
+        }
+        const DrawCommand& draw = commands[command];
+        int firstVertex = draw.first + (triangle - commandTriangleStart[command]) * 3;
+
+        ClipVertex vertices[3];
+        int insideNear = 0;
+        for (int k = 0; k < 3; ++k) {
+            ClipVertex& vertex = vertices[k];
+            vertex.world = vec3(draw.model * vec4(draw.positions[firstVertex + k], 1.0f));
+            vertex.clip = viewProjection * vec4(vertex.world, 1.0f);
+            vertex.normal = draw.normals != NULL ? draw.normalMatrix * draw.normals[firstVertex + k] : vec3(0.0f, 1.0f, 0.0f);
+            vertex.uv = draw.textureCoords != NULL ? draw.textureCoords[firstVertex + k] : vec2(0.0f);
+            if (vertex.clip.z >= -vertex.clip.w) {
+                insideNear++;
+            }
+        }
+
+        // Ceo trougao van iste bocne ravni
+        bool outside = false;
+        for (int axis = 0; axis < 2 && !outside; ++axis) {
+            outside = (vertices[0].clip[axis] > vertices[0].clip.w && vertices[1].clip[axis] > vertices[1].clip.w && vertices[2].clip[axis] > vertices[2].clip.w)
+                   || (vertices[0].clip[axis] < -vertices[0].clip.w && vertices[1].clip[axis] < -vertices[1].clip.w && vertices[2].clip[axis] < -vertices[2].clip.w);
+        }
+        if (outside || insideNear == 0) {
+            continue;
+        }
+        if (insideNear == 3) {
+            setupTriangle(bins, command, vertices);
+            continue;
+        }
+
+        // Odsecanje prednjom ravni (z = -w): Sutherland-Hodgman daje 3 ili 4 temena
+        ClipVertex polygon[4];
+        int polygonSize = 0;
+        for (int k = 0; k < 3; ++k) {
+            const ClipVertex& a = vertices[k];
+            const ClipVertex& b = vertices[(k + 1) % 3];
+            float da = a.clip.z + a.clip.w;
+            float db = b.clip.z + b.clip.w;
+            if (da >= 0.0f) {
+                polygon[polygonSize++] = a;
+            }
+            if ((da >= 0.0f) != (db >= 0.0f)) {
+                float t = da / (da - db);
+                ClipVertex& cut = polygon[polygonSize++];
+                cut.clip = a.clip + (b.clip - a.clip) * t;
+                cut.world = a.world + (b.world - a.world) * t;
+                cut.normal = a.normal + (b.normal - a.normal) * t;
+                cut.uv = a.uv + (b.uv - a.uv) * t;
+            }
+        }
+        for (int k = 1; k + 1 < polygonSize; ++k) {
+            ClipVertex fan[3] = { polygon[0], polygon[k], polygon[k + 1] };
+            setupTriangle(bins, command, fan);
+        }
+    }
+}
+
+void SoftwareRenderer::setupTriangle(ThreadBins& bins, int command, const ClipVertex* vertices)
+{
+    SetupTriangle triangle;
+    float screenX[3], screenY[3];
+    for (int k = 0; k < 3; ++k) {
+        float invW = 1.0f / vertices[k].clip.w;
+        screenX[k] = (vertices[k].clip.x * invW * 0.5f + 0.5f) * width;
+        screenY[k] = (vertices[k].clip.y * invW * 0.5f + 0.5f) * height;
+        triangle.depth[k] = vertices[k].clip.z * invW * 0.5f + 0.5f;
+        triangle.invW[k] = invW;
+        triangle.worldOverW[k] = vertices[k].world * invW;
+        triangle.normalOverW[k] = vertices[k].normal * invW;
+        triangle.uvOverW[k] = vertices[k].uv * invW;
+    }
+
+    // Pozitivna povrsina = suprotno od kazaljke na satu (y ide nagore) = prednja strana kao u GL-u
+    float area = (screenX[1] - screenX[0]) * (screenY[2] - screenY[0]) - (screenY[1] - screenY[0]) * (screenX[2] - screenX[0]);
+    if (area == 0.0f || (commands[command].cullBackFaces && area < 0.0f)) {
+        return;
+    }
+
+    triangle.minX = std::max((int)floor(std::min(std::min(screenX[0], screenX[1]), screenX[2])), 0);
+    triangle.minY = std::max((int)floor(std::min(std::min(screenY[0], screenY[1]), screenY[2])), 0);
+    triangle.maxX = std::min((int)ceil(std::max(std::max(screenX[0], screenX[1]), screenX[2])), width - 1);
+    triangle.maxY = std::min((int)ceil(std::max(std::max(screenY[0], screenY[1]), screenY[2])), height - 1);
+    if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) {
+        return;
+    }
+
+    // Ivica naspram temena k; vrednost u centru piksela (x + 0.5, y + 0.5)
+    float invArea = 1.0f / area;
+    for (int k = 0; k < 3; ++k) {
+        int a = (k + 1) % 3;
+        int b = (k + 2) % 3;
+        float edgeA = -(screenY[b] - screenY[a]) * invArea;
+        float edgeB = (screenX[b] - screenX[a]) * invArea;
+        float edgeC = -(edgeA * screenX[a] + edgeB * screenY[a]);
+        triangle.edgeA[k] = edgeA;
+        triangle.edgeB[k] = edgeB;
+        triangle.edgeC[k] = edgeC + 0.5f * (edgeA + edgeB);
+        bool topLeft = edgeA > 0.0f || (edgeA == 0.0f && edgeB < 0.0f);
+        triangle.bias[k] = topLeft ? 0.0f : FLT_MIN;
+    }
+    triangle.command = command;
+
+    int index = (int)bins.triangles.size();
+    bins.triangles.push_back(triangle);
+    for (int tileY = triangle.minY / TILE_SIZE; tileY <= triangle.maxY / TILE_SIZE; ++tileY) {
+        for (int tileX = triangle.minX / TILE_SIZE; tileX <= triangle.maxX / TILE_SIZE; ++tileX) {
+            bins.tiles[tileY * tilesX + tileX].push_back(index);
+        }
+    }
+}
+
+void SoftwareRenderer::rasterizeTile(int tile)
+{
+    int tileX0 = (tile % tilesX) * TILE_SIZE;
+    int tileY0 = (tile / tilesX) * TILE_SIZE;
+    int tileX1 = std::min(tileX0 + TILE_SIZE, width) - 1;
+    int tileY1 = std::min(tileY0 + TILE_SIZE, height) - 1;
+
+    for (const ThreadBins& bins : threadBins) {
+        for (int index : bins.tiles[tile]) {
+            rasterizeTriangle(bins.triangles[index], tileX0, tileY0, tileX1, tileY1);
+        }
+    }
+}
+
+void SoftwareRenderer::rasterizeTriangle(const SetupTriangle& triangle, int tileX0, int tileY0, int tileX1, int tileY1)
+{
+    const DrawCommand& draw = commands[triangle.command];
+    const Material& mat = draw.material;
+    const Light& light = draw.reflector;
+    bool translucent = draw.opacity < 1.0f;
+
+    int x0 = std::max(triangle.minX, tileX0) & ~3;
+    int x1 = std::min(triangle.maxX, tileX1);
+    int y0 = std::max(triangle.minY, tileY0);
+    int y1 = std::min(triangle.maxY, tileY1);
+
+    const __m128 laneOffsets = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+    __m128 edgeA[3], edgeB[3], edgeC[3], bias[3];
+    for (int k = 0; k < 3; ++k) {
+        edgeA[k] = _mm_set1_ps(triangle.edgeA[k]);
+        edgeB[k] = _mm_set1_ps(triangle.edgeB[k]);
+        edgeC[k] = _mm_set1_ps(triangle.edgeC[k]);
+        bias[k] = _mm_set1_ps(triangle.bias[k]);
+    }
+
+    for (int y = y0; y <= y1; ++y) {
+        __m128 py = _mm_set1_ps((float)y);
+        for (int x = x0; x <= x1; x += 4) {
+            __m128 px = _mm_add_ps(_mm_set1_ps((float)x), laneOffsets);
+            __m128 l[3];
+            __m128 covered = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (int k = 0; k < 3; ++k) {
+                l[k] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(edgeA[k], px), _mm_mul_ps(edgeB[k], py)), edgeC[k]);
+                covered = _mm_and_ps(covered, _mm_cmpge_ps(l[k], bias[k]));
+            }
+            if (_mm_movemask_ps(covered) == 0) {
+                continue;
+            }
+
+            // Test dubine (GL_LESS)
+            float* depthRow = &depthBuffer[y * stride + x];
+            __m128 depth = interpolate(l[0], l[1], l[2], triangle.depth[0], triangle.depth[1], triangle.depth[2]);
+            __m128 storedDepth = _mm_loadu_ps(depthRow);
+            covered = _mm_and_ps(covered, _mm_cmplt_ps(depth, storedDepth));
+            int mask = _mm_movemask_ps(covered);
+            if (mask == 0) {
+                continue;
+            }
+            if (!translucent) {
+                _mm_storeu_ps(depthRow, _mm_or_ps(_mm_and_ps(covered, depth), _mm_andnot_ps(covered, storedDepth)));
+            }
+
+            // Perspektivno ispravna interpolacija (atribut / w, pa deljenje interpoliranim 1 / w)
+            __m128 w = _mm_div_ps(_mm_set1_ps(1.0f), interpolate(l[0], l[1], l[2], triangle.invW[0], triangle.invW[1], triangle.invW[2]));
+            Vec3x4 position = {
+                _mm_mul_ps(interpolate(l[0], l[1], l[2], triangle.worldOverW[0].x, triangle.worldOverW[1].x, triangle.worldOverW[2].x), w),
+                _mm_mul_ps(interpolate(l[0], l[1], l[2], triangle.worldOverW[0].y, triangle.worldOverW[1].y, triangle.worldOverW[2].y), w),
+                _mm_mul_ps(interpolate(l[0], l[1], l[2], triangle.worldOverW[0].z, triangle.worldOverW[1].z, triangle.worldOverW[2].z), w)
+            };
+            Vec3x4 normal = {
+                interpolate(l[0], l[1], l[2], triangle.normalOverW[0].x, triangle.normalOverW[1].x, triangle.normalOverW[2].x),
+                interpolate(l[0], l[1], l[2], triangle.normalOverW[0].y, triangle.normalOverW[1].y, triangle.normalOverW[2].y),
+                interpolate(l[0], l[1], l[2], triangle.normalOverW[0].z, triangle.normalOverW[1].z, triangle.normalOverW[2].z)
+            };
+            normal = normalize3(normal);
+
+            // Mesecina: normalize(0, 1.8, 0) u base.frag i normalize(0, 1.2, 0) u texture.frag su isti pravac (0, 1, 0)
+            Vec3x4 viewDirection = { _mm_sub_ps(_mm_set1_ps(viewPosition.x), position.x), _mm_sub_ps(_mm_set1_ps(viewPosition.y), position.y), _mm_sub_ps(_mm_set1_ps(viewPosition.z), position.z) };
+            viewDirection = normalize3(viewDirection);
+            Vec3x4 moon = { _mm_setzero_ps(), _mm_set1_ps(1.0f), _mm_setzero_ps() };
+            __m128 nD = _mm_max_ps(normal.y, _mm_setzero_ps());
+            __m128 s = specularPow(dot3(viewDirection, reflectNegated(moon, normal)), mat.shine);
+            __m128 diffuse = _mm_mul_ps(_mm_set1_ps(0.5f), nD);
+            __m128 specular = _mm_mul_ps(_mm_set1_ps(0.2f), s);
+            // Ambijent 0.1 * kA, kao resA u shaderima
+            __m128 red = _mm_add_ps(_mm_set1_ps(0.1f * mat.kA.x), _mm_add_ps(_mm_mul_ps(diffuse, _mm_set1_ps(mat.kD.x)), _mm_mul_ps(specular, _mm_set1_ps(mat.kS.x))));
+            __m128 green = _mm_add_ps(_mm_set1_ps(0.1f * mat.kA.y), _mm_add_ps(_mm_mul_ps(diffuse, _mm_set1_ps(mat.kD.y)), _mm_mul_ps(specular, _mm_set1_ps(mat.kS.y))));
+            __m128 blue = _mm_add_ps(_mm_set1_ps(0.1f * mat.kA.z), _mm_add_ps(_mm_mul_ps(diffuse, _mm_set1_ps(mat.kD.z)), _mm_mul_ps(specular, _mm_set1_ps(mat.kS.z))));
+
+            if (draw.shading == SHADING_BASE) {
+                // Reflektor (uzak snop, pa se racuna samo ako ga neki piksel grupe vidi)
+                Vec3x4 lightDirection = { _mm_sub_ps(_mm_set1_ps(light.pos.x), position.x), _mm_sub_ps(_mm_set1_ps(light.pos.y), position.y), _mm_sub_ps(_mm_set1_ps(light.pos.z), position.z) };
+                lightDirection = normalize3(lightDirection);
+                Vec3x4 spotDirection = { _mm_set1_ps(light.dir.x), _mm_set1_ps(light.dir.y), _mm_set1_ps(light.dir.z) };
+                __m128 spotCosine = _mm_sub_ps(_mm_setzero_ps(), dot3(lightDirection, spotDirection));
+                __m128 inSpot = _mm_and_ps(_mm_cmpge_ps(spotCosine, _mm_set1_ps(light.cutoff)), covered);
+                if (_mm_movemask_ps(inSpot) != 0) {
+                    __m128 spot = _mm_and_ps(inSpot, _mm_set1_ps(1.0f));
+                    __m128 nDReflector = _mm_mul_ps(spot, _mm_max_ps(dot3(normal, lightDirection), _mm_setzero_ps()));
+                    __m128 sReflector = _mm_mul_ps(spot, specularPow(dot3(viewDirection, reflectNegated(lightDirection, normal)), mat.shine));
+                    red = _mm_add_ps(red, _mm_add_ps(_mm_mul_ps(nDReflector, _mm_set1_ps(light.kD.x * mat.kD.x)), _mm_mul_ps(sReflector, _mm_set1_ps(light.kS.x * mat.kS.x))));
+                    green = _mm_add_ps(green, _mm_add_ps(_mm_mul_ps(nDReflector, _mm_set1_ps(light.kD.y * mat.kD.y)), _mm_mul_ps(sReflector, _mm_set1_ps(light.kS.y * mat.kS.y))));
+                    blue = _mm_add_ps(blue, _mm_add_ps(_mm_mul_ps(nDReflector, _mm_set1_ps(light.kD.z * mat.kD.z)), _mm_mul_ps(sReflector, _mm_set1_ps(light.kS.z * mat.kS.z))));
+                }
+                // Samosvetljenje (kE) se dodaje posle boje crtanja, kao u base.frag
+                red = _mm_add_ps(_mm_mul_ps(red, _mm_set1_ps(draw.color.x)), _mm_set1_ps(mat.kE.x));
+                green = _mm_add_ps(_mm_mul_ps(green, _mm_set1_ps(draw.color.y)), _mm_set1_ps(mat.kE.y));
+                blue = _mm_add_ps(_mm_mul_ps(blue, _mm_set1_ps(draw.color.z)), _mm_set1_ps(mat.kE.z));
+            }
+
+            float r[4], g[4], b[4];
+            _mm_storeu_ps(r, red);
+            _mm_storeu_ps(g, green);
+            _mm_storeu_ps(b, blue);
+
+            if (draw.shading == SHADING_TEXTURE) {
+                // Najblizi teksel, GL_REPEAT (kao mapTexture)
+                float u[4], v[4];
+                _mm_storeu_ps(u, _mm_mul_ps(interpolate(l[0], l[1], l[2], triangle.uvOverW[0].x, triangle.uvOverW[1].x, triangle.uvOverW[2].x), w));
+                _mm_storeu_ps(v, _mm_mul_ps(interpolate(l[0], l[1], l[2], triangle.uvOverW[0].y, triangle.uvOverW[1].y, triangle.uvOverW[2].y), w));
+                const SoftwareTexture& texture = *draw.texture;
+                for (int lane = 0; lane < 4; ++lane) {
+                    if (!(mask & (1 << lane))) {
+                        continue;
+                    }
+                    int texelX = std::min((int)((u[lane] - floor(u[lane])) * texture.width), texture.width - 1);
+                    int texelY = std::min((int)((v[lane] - floor(v[lane])) * texture.height), texture.height - 1);
+                    const unsigned char* texel = &texture.rgba[(texelY * texture.width + texelX) * 4];
+                    r[lane] *= texel[0] / 255.0f;
+                    g[lane] *= texel[1] / 255.0f;
+                    b[lane] *= texel[2] / 255.0f;
+                }
+            }
+
+            uint32_t* colorRow = &colorBuffer[y * stride + x];
+            for (int lane = 0; lane < 4; ++lane) {
+                if (!(mask & (1 << lane))) {
+                    continue;
+                }
+                if (translucent) {
+                    // GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA
+                    uint32_t previous = colorRow[lane];
+                    float keep = 1.0f - draw.opacity;
+                    r[lane] = r[lane] * draw.opacity + (previous & 0xFF) / 255.0f * keep;
+                    g[lane] = g[lane] * draw.opacity + ((previous >> 8) & 0xFF) / 255.0f * keep;
+                    b[lane] = b[lane] * draw.opacity + ((previous >> 16) & 0xFF) / 255.0f * keep;
+                }
+                colorRow[lane] = packColor(r[lane], g[lane], b[lane]);
+            }
+        }
+    }
+}
+
+bool SoftwareRenderer::writePPM(const char* path) const
+{
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        return false;
+    }
+    fprintf(file, "P6\n%d %d\n255\n", width, height);
+    vector<unsigned char> row(width * 3);
+    for (int y = height - 1; y >= 0; --y) {
+        for (int x = 0; x < width; ++x) {
+            uint32_t pixel = colorBuffer[y * stride + x];
+            row[x * 3 + 0] = (unsigned char)(pixel & 0xFF);
+            row[x * 3 + 1] = (unsigned char)((pixel >> 8) & 0xFF);
+            row[x * 3 + 2] = (unsigned char)((pixel >> 16) & 0xFF);
+        }
+        fwrite(row.data(), 1, row.size(), file);
+    }
+    fclose(file);
+    return true;
+}
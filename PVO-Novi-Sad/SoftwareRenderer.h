@@ -0,0 +1,153 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include "Material.h"
+
+// Tekstura za softverski renderer: RGBA8, redovi kako ih stbi_load vraca (kao glTexImage2D bez okretanja)
+struct SoftwareTexture {
+    int width;
+    int height;
+    std::vector<unsigned char> rgba;
+};
+
+// CPU renderer za masine bez GPU-a i prozora (snimci ekrana i merenje vremena frejma).
+// Pozivi odgovaraju glDrawArrays(GL_TRIANGLES, ...) sa base.vert/base.frag odnosno texture.vert/texture.frag,
+// a crtanje se izvrsava tek u finish():
+//  1. priprema trouglova (transformacija, odsecanje prednjom ravni, ivicne funkcije) - niti dele trouglove
+//  2. trouglovi se rasporedjuju po plocicama ekrana (TILE_SIZE x TILE_SIZE) u redosledu crtanja
+//  3. niti uzimaju plocice i rasterizuju ih po 4 piksela odjednom (SSE2), sa istim Phong osvetljenjem kao shaderi
+// Neprovidni pozivi se crtaju pre providnih (providni: test dubine bez upisa, mesanje SRC_ALPHA redom poziva).
+class SoftwareRenderer
+{
+public:
+    static const int TILE_SIZE = 64;
+
+    struct Material {
+        glm::vec3 kA;
+        glm::vec3 kD;
+        glm::vec3 kS;
+        float shine;
+        glm::vec3 kE;
+        float opacity;
+    };
+
+    // Isti zapis kao u MaterialTable (bez teksture iz atlasa)
+    static Material fromModelMaterial(const ModelMaterial& material);
+
+    struct Light {
+        glm::vec3 pos;
+        glm::vec3 dir;
+        float cutoff;
+        glm::vec3 kA;
+        glm::vec3 kD;
+        glm::vec3 kS;
+    };
+
+    // threadCount 0 = broj jezgara
+    SoftwareRenderer(int width, int height, int threadCount = 0);
+
+    SoftwareRenderer(const SoftwareRenderer&) = delete;
+    SoftwareRenderer& operator=(const SoftwareRenderer&) = delete;
+
+    void setCamera(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPosition);
+    // Materijal za drawTextured (texture.frag koristi kA, kD, kS i shine)
+    void setMaterial(const Material& material);
+    void setReflector(const Light& reflector);
+
+    void clear(const glm::vec3& color);
+
+    // Nizovi moraju da zive do finish(). Jedan poziv po opsegu materijala (kao drawMeshAsset);
+    // opacity = 1 - uAlpha iz base.frag, mnozi se providnoscu materijala.
+    void drawBase(const glm::vec3* positions, const glm::vec3* normals, int first, int count, const glm::mat4& model,
+                  const Material& material, const glm::vec3& color, float opacity, bool cullBackFaces);
+    void drawTextured(const glm::vec3* positions, const glm::vec3* normals, const glm::vec2* textureCoords, int first, int count,
+                      const glm::mat4& model, const SoftwareTexture* texture, bool cullBackFaces);
+
+    void finish();
+
+    // Slika u PPM (P6) formatu, prvi red je gornji red ekrana
+    bool writePPM(const char* path) const;
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    int threads() const { return threadCount; }
+    int lastTriangleCount() const { return triangleCount; }
+
+private:
+    enum Shading {
+        SHADING_BASE,       // base.frag
+        SHADING_TEXTURE     // texture.frag
+    };
+
+    struct DrawCommand {
+        Shading shading;
+        const glm::vec3* positions;
+        const glm::vec3* normals;
+        const glm::vec2* textureCoords;
+        int first;
+        int count;
+        glm::mat4 model;
+        glm::mat3 normalMatrix;
+        glm::vec3 color;
+        float opacity;
+        bool cullBackFaces;
+        const SoftwareTexture* texture;
+        Material material;
+        Light reflector;
+    };
+
+    struct ClipVertex {
+        glm::vec4 clip;
+        glm::vec3 world;
+        glm::vec3 normal;
+        glm::vec2 uv;
+    };
+
+    // Ivicne funkcije su podeljene povrsinom, pa su direktno baricentricne koordinate (l0 je tezina temena 0)
+    struct SetupTriangle {
+        float edgeA[3];
+        float edgeB[3];
+        float edgeC[3];
+        float bias[3];      // 0 za gornju/levu ivicu, inace najmanji pozitivan broj (pravilo gore-levo)
+        float depth[3];
+        float invW[3];
+        glm::vec3 worldOverW[3];
+        glm::vec3 normalOverW[3];
+        glm::vec2 uvOverW[3];
+        int minX, minY, maxX, maxY;
+        int command;
+    };
+
+    struct ThreadBins {
+        std::vector<SetupTriangle> triangles;
+        std::vector<std::vector<int> > tiles;   // indeksi u triangles, po plocicama
+    };
+
+    void setupTriangles(int thread, int firstTriangle, int lastTriangle);
+    void setupTriangle(ThreadBins& bins, int command, const ClipVertex* vertices);
+    void rasterizeTile(int tile);
+    void rasterizeTriangle(const SetupTriangle& triangle, int tileX0, int tileY0, int tileX1, int tileY1);
+
+    int width;
+    int height;
+    int stride;
+    int tilesX;
+    int tilesY;
+    int threadCount;
+    int triangleCount;
+
+    glm::mat4 viewProjection;
+    glm::vec3 viewPosition;
+    Material material;
+    Light reflector;
+
+    std::vector<uint32_t> colorBuffer;
+    std::vector<float> depthBuffer;
+    std::vector<DrawCommand> commands;
+    std::vector<int> commandTriangleStart;  // prefiks suma broja trouglova po pozivu
+    std::vector<ThreadBins> threadBins;
+};
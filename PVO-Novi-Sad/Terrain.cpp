@@ -0,0 +1,353 @@
+#include "Terrain.h"
+#include "AssetLoader.h"
+#include "Frustum.h"
+#include "stb_image.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace std;
+using namespace glm;
+
+// Najveca mreza temena (1025 x 1025) - veca mapa visina se smanjuje
+static const int MAX_CHUNKS_PER_SIDE = 32;
+
+Terrain::Terrain()
+    : loaded(false), gridSize(0), chunksPerSide(0), lodCount(0), pixelError(2.0f), visibleCount(0), triangleCount(0),
+      vao(0), vbo(0), ibo(0), indexType(GL_UNSIGNED_INT), indexSize(4)
+{
+}
+
+bool Terrain::readHeightmap(const char* path, vector<uint16_t>& heights, int& width, int& height)
+{
+    int channels;
+    stbi_us* pixels = stbi_load_16(path, &width, &height, &channels, 1);
+    if (pixels == NULL) {
+        return false;
+    }
+    heights.assign(pixels, pixels + (size_t)width * height);
+    stbi_image_free(pixels);
+    return true;
+}
+
+void Terrain::buildIndices(int gridSize, int lod, int coarserSides, vector<uint32_t>& indices)
+{
+    const int q = CHUNK_QUADS;
+    const int step = 1 << lod;
+    const int coarseStep = step * 2;
+
+    // Teme na ivici prema grubljem susedu se pomera na prethodno teme susedovog koraka,
+    // pa trouglovi koji ga koriste postaju lepeza do iste ivice koju crta sused
+    auto vertexIndex = [&](int c, int r) -> uint32_t {
+        if ((r == 0 && (coarserSides & SIDE_NEAR)) || (r == q && (coarserSides & SIDE_FAR))) {
+            c = c / coarseStep * coarseStep;
+        }
+        if ((c == 0 && (coarserSides & SIDE_LEFT)) || (c == q && (coarserSides & SIDE_RIGHT))) {
+            r = r / coarseStep * coarseStep;
+        }
+        return (uint32_t)(r * gridSize + c);
+    };
+
+    auto addTriangle = [&](uint32_t a, uint32_t b, uint32_t c) {
+        if (a == b || b == c || a == c) {
+            return;
+        }
+        indices.push_back(a);
+        indices.push_back(b);
+        indices.push_back(c);
+    };
+
+    for (int r = 0; r < q; r += step) {
+        for (int c = 0; c < q; c += step) {
+            uint32_t a = vertexIndex(c, r);
+            uint32_t b = vertexIndex(c + step, r);
+            uint32_t d = vertexIndex(c, r + step);
+            uint32_t e = vertexIndex(c + step, r + step);
+            // CCW gledano odozgo (+Y)
+            addTriangle(a, d, b);
+            addTriangle(b, d, e);
+        }
+    }
+}
+
+void Terrain::build(const vector<uint16_t>& heights, int width, int height, float worldSize, float heightScale, float baseHeight, BuildData& data)
+{
+    int chunks = std::min((std::min(width, height) - 1) / CHUNK_QUADS, MAX_CHUNKS_PER_SIDE);
+    chunks = std::max(chunks, 1);
+    const int g = chunks * CHUNK_QUADS + 1;
+    data.gridSize = g;
+
+    // Mapa visina -> mreza g x g (bilinearno), visine u 0..1
+    vector<float> grid((size_t)g * g);
+    for (int r = 0; r < g; ++r) {
+        float y = (float)r * (height - 1) / (g - 1);
+        int y0 = std::min((int)y, height - 2);
+        float fy = y - y0;
+        for (int c = 0; c < g; ++c) {
+            float x = (float)c * (width - 1) / (g - 1);
+            int x0 = std::min((int)x, width - 2);
+            float fx = x - x0;
+            const uint16_t* row0 = &heights[(size_t)y0 * width];
+            const uint16_t* row1 = row0 + width;
+            float top = row0[x0] + (row0[x0 + 1] - row0[x0]) * fx;
+            float bottom = row1[x0] + (row1[x0 + 1] - row1[x0]) * fx;
+            grid[(size_t)r * g + c] = (top + (bottom - top) * fy) / 65535.0f;
+        }
+    }
+
+    auto heightAt = [&](int c, int r) {
+        c = std::max(0, std::min(c, g - 1));
+        r = std::max(0, std::min(r, g - 1));
+        return baseHeight + grid[(size_t)r * g + c] * heightScale;
+    };
+
+    const float spacing = worldSize / (g - 1);
+    const float origin = -worldSize * 0.5f;
+    data.vertices.resize((size_t)g * g * 8);
+    float* v = data.vertices.data();
+    for (int r = 0; r < g; ++r) {
+        for (int c = 0; c < g; ++c) {
+            vec3 normal = normalize(vec3(heightAt(c - 1, r) - heightAt(c + 1, r), 2.0f * spacing, heightAt(c, r - 1) - heightAt(c, r + 1)));
+            *v++ = origin + c * spacing;
+            *v++ = heightAt(c, r);
+            *v++ = origin + r * spacing;
+            *v++ = (float)c / (g - 1);
+            *v++ = (float)r / (g - 1);
+            *v++ = normal.x;
+            *v++ = normal.y;
+            *v++ = normal.z;
+        }
+    }
+
+    // Delovi: granice za odsecanje i greska svakog nivoa u odnosu na punu rezoluciju
+    data.chunks.resize((size_t)chunks * chunks);
+    for (int cr = 0; cr < chunks; ++cr) {
+        for (int cc = 0; cc < chunks; ++cc) {
+            Chunk& chunk = data.chunks[(size_t)cr * chunks + cc];
+            int c0 = cc * CHUNK_QUADS;
+            int r0 = cr * CHUNK_QUADS;
+            chunk.baseVertex = r0 * g + c0;
+            chunk.lod = 0;
+            chunk.coarserSides = 0;
+            chunk.visible = false;
+
+            float minHeight = heightAt(c0, r0);
+            float maxHeight = minHeight;
+            for (int r = 0; r <= CHUNK_QUADS; ++r) {
+                for (int c = 0; c <= CHUNK_QUADS; ++c) {
+                    float h = heightAt(c0 + c, r0 + r);
+                    minHeight = std::min(minHeight, h);
+                    maxHeight = std::max(maxHeight, h);
+                }
+            }
+            chunk.minCorner = vec3(origin + c0 * spacing, minHeight, origin + r0 * spacing);
+            chunk.maxCorner = vec3(origin + (c0 + CHUNK_QUADS) * spacing, maxHeight, origin + (r0 + CHUNK_QUADS) * spacing);
+
+            chunk.error[0] = 0.0f;
+            for (int lod = 1; lod < MAX_LODS; ++lod) {
+                int step = 1 << lod;
+                float error = chunk.error[lod - 1];
+                for (int r = 0; r <= CHUNK_QUADS; ++r) {
+                    int rc = std::min(r / step * step, CHUNK_QUADS - step);
+                    float fy = (float)(r - rc) / step;
+                    for (int c = 0; c <= CHUNK_QUADS; ++c) {
+                        int ccell = std::min(c / step * step, CHUNK_QUADS - step);
+                        float fx = (float)(c - ccell) / step;
+                        float h00 = heightAt(c0 + ccell, r0 + rc);
+                        float h10 = heightAt(c0 + ccell + step, r0 + rc);
+                        float h01 = heightAt(c0 + ccell, r0 + rc + step);
+                        float h11 = heightAt(c0 + ccell + step, r0 + rc + step);
+                        float top = h00 + (h10 - h00) * fx;
+                        float bottom = h01 + (h11 - h01) * fx;
+                        error = std::max(error, fabs(heightAt(c0 + c, r0 + r) - (top + (bottom - top) * fy)));
+                    }
+                }
+                chunk.error[lod] = error;
+            }
+        }
+    }
+
+    // Liste indeksa: za svaki nivo 16 varijanti ivica
+    data.ranges.resize(MAX_LODS * 16);
+    for (int lod = 0; lod < MAX_LODS; ++lod) {
+        for (int sides = 0; sides < 16; ++sides) {
+            IndexRange& range = data.ranges[lod * 16 + sides];
+            range.offset = data.indices.size();
+            // Najgrublji nivo nema grubljeg suseda
+            buildIndices(g, lod, lod == MAX_LODS - 1 ? 0 : sides, data.indices);
+            range.count = (GLsizei)(data.indices.size() - range.offset);
+        }
+    }
+}
+
+void Terrain::loadAsync(AssetLoader& loader, const char* heightmapPath, float worldSize, float heightScale, float baseHeight)
+{
+    string path = heightmapPath;
+    AssetLoader* assetLoader = &loader;
+    loader.submit([this, assetLoader, path, worldSize, heightScale, baseHeight] {
+        vector<uint16_t> heights;
+        int width, height;
+        if (!readHeightmap(path.c_str(), heights, width, height)) {
+            return;
+        }
+        if (width < CHUNK_QUADS + 1 || height < CHUNK_QUADS + 1) {
+            cout << "Mapa visina je premala: " << path << endl;
+            return;
+        }
+
+        shared_ptr<BuildData> data = make_shared<BuildData>();
+        build(heights, width, height, worldSize, heightScale, baseHeight, *data);
+        assetLoader->queueUpload([this, assetLoader, data] {
+            upload(*data, assetLoader->uploadArena());
+        });
+    });
+}
+
+void Terrain::upload(BuildData& data, LinearArena& scratch)
+{
+    gridSize = data.gridSize;
+    chunksPerSide = (gridSize - 1) / CHUNK_QUADS;
+    lodCount = MAX_LODS;
+
+    // Indeksi su relativni u odnosu na ugao dela, pa najcesce staju u 16 bita
+    uint32_t maxIndex = (uint32_t)(CHUNK_QUADS * gridSize + CHUNK_QUADS);
+    indexType = maxIndex <= 0xFFFF ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    indexSize = maxIndex <= 0xFFFF ? sizeof(uint16_t) : sizeof(uint32_t);
+
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glGenBuffers(1, &ibo);
+
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, data.vertices.size() * sizeof(float), data.vertices.data(), GL_STATIC_DRAW);
+
+    unsigned int stride = 8 * sizeof(float);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, (void*)(5 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+    if (indexType == GL_UNSIGNED_SHORT) {
+        // Suzeni indeksi samo za vreme upload-a, u areni ucitavanja
+        ArenaScope scope(scratch);
+        uint16_t* shortIndices = scope.allocateArray<uint16_t>(data.indices.size());
+        std::copy(data.indices.begin(), data.indices.end(), shortIndices);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.indices.size() * sizeof(uint16_t), shortIndices, GL_STATIC_DRAW);
+    }
+    else {
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.indices.size() * sizeof(uint32_t), data.indices.data(), GL_STATIC_DRAW);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    ranges = move(data.ranges);
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        ranges[i].offset *= indexSize;
+    }
+    chunks = move(data.chunks);
+    loaded = true;
+}
+
+void Terrain::update(const Frustum& frustum, const vec3& cameraPosition, float projectionScale)
+{
+    if (!loaded) {
+        return;
+    }
+
+    // Najgrublji nivo cija je greska na ekranu ispod praga. Racuna se i za nevidljive delove jer od njih
+    // zavisi spajanje ivica vidljivih suseda.
+    visibleCount = 0;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        Chunk& chunk = chunks[i];
+        chunk.visible = frustum.intersectsBox(chunk.minCorner, chunk.maxCorner);
+        visibleCount += chunk.visible ? 1 : 0;
+
+        vec3 closest = glm::clamp(cameraPosition, chunk.minCorner, chunk.maxCorner);
+        float distance = std::max(length(cameraPosition - closest), 0.0001f);
+        chunk.lod = 0;
+        for (int lod = lodCount - 1; lod > 0; --lod) {
+            if (chunk.error[lod] * projectionScale / distance <= pixelError) {
+                chunk.lod = lod;
+                break;
+            }
+        }
+    }
+
+    // Susedi se razlikuju najvise za jedan nivo - spustanje se siri dok se ne ustali
+    const int n = chunksPerSide;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int r = 0; r < n; ++r) {
+            for (int c = 0; c < n; ++c) {
+                Chunk& chunk = chunks[(size_t)r * n + c];
+                int finest = chunk.lod;
+                if (c > 0) finest = std::min(finest, chunks[(size_t)r * n + c - 1].lod + 1);
+                if (c < n - 1) finest = std::min(finest, chunks[(size_t)r * n + c + 1].lod + 1);
+                if (r > 0) finest = std::min(finest, chunks[(size_t)(r - 1) * n + c].lod + 1);
+                if (r < n - 1) finest = std::min(finest, chunks[(size_t)(r + 1) * n + c].lod + 1);
+                if (finest != chunk.lod) {
+                    chunk.lod = finest;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    triangleCount = 0;
+    for (int r = 0; r < n; ++r) {
+        for (int c = 0; c < n; ++c) {
+            Chunk& chunk = chunks[(size_t)r * n + c];
+            int sides = 0;
+            if (c > 0 && chunks[(size_t)r * n + c - 1].lod > chunk.lod) sides |= SIDE_LEFT;
+            if (c < n - 1 && chunks[(size_t)r * n + c + 1].lod > chunk.lod) sides |= SIDE_RIGHT;
+            if (r > 0 && chunks[(size_t)(r - 1) * n + c].lod > chunk.lod) sides |= SIDE_NEAR;
+            if (r < n - 1 && chunks[(size_t)(r + 1) * n + c].lod > chunk.lod) sides |= SIDE_FAR;
+            chunk.coarserSides = sides;
+            if (chunk.visible) {
+                triangleCount += ranges[chunk.lod * 16 + sides].count / 3;
+            }
+        }
+    }
+}
+
+void Terrain::submit(CommandBuffer& commands, const DrawCommand& chunkDraw) const
+{
+    if (!loaded) {
+        return;
+    }
+
+    DrawCommand draw = chunkDraw;
+    draw.primitive = GL_TRIANGLES;
+    draw.indexType = indexType;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        const Chunk& chunk = chunks[i];
+        if (!chunk.visible) {
+            continue;
+        }
+        const IndexRange& range = ranges[chunk.lod * 16 + chunk.coarserSides];
+        draw.count = range.count;
+        draw.indexOffset = range.offset;
+        draw.baseVertex = chunk.baseVertex;
+        commands.draw(draw);
+    }
+}
+
+void Terrain::release()
+{
+    if (vao != 0) {
+        glDeleteVertexArrays(1, &vao);
+        glDeleteBuffers(1, &vbo);
+        glDeleteBuffers(1, &ibo);
+        vao = vbo = ibo = 0;
+    }
+    loaded = false;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "Arena.h"
+#include "CommandBuffer.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+class AssetLoader;
+struct Frustum;
+
+// Teren iz 16-bitne mape visina sa geomipmapping LOD-om.
+// Mreza temena je podeljena na kvadratne delove (chunk) od CHUNK_QUADS x CHUNK_QUADS polja. Svi delovi dele
+// jedan VBO sa celom mrezom i jedan IBO sa listama indeksa za svaki nivo detalja (LOD) - indeksi su relativni
+// u odnosu na ugao dela, pa se crta sa glDrawElementsBaseVertex.
+// LOD se bira po gresci u pikselima na ekranu, a susedni delovi se razlikuju najvise za jedan nivo.
+// Na ivici prema grubljem susedu neparna temena se "spajaju" sa parnim, pa ivica tacno prati
+// susedov trougao i nema pukotina. Za svaki nivo postoji 16 varijanti indeksa (jedan bit po strani).
+//
+// Mapa visina: .png sa 16 bita po kanalu (stbi_load_16).
+// Teren pokriva [-worldSize/2, worldSize/2] po X i Z, kao ravan mape, pa mu odgovara ista tekstura.
+class Terrain
+{
+public:
+    static const int CHUNK_QUADS = 32;
+    static const int MAX_LODS = 5;      // korak 1, 2, 4, 8, 16 temena
+
+    Terrain();
+
+    Terrain(const Terrain&) = delete;
+    Terrain& operator=(const Terrain&) = delete;
+
+    // Mapa visina se cita i mreza gradi na radnoj niti, a baferi se prave na render niti
+    void loadAsync(AssetLoader& loader, const char* heightmapPath, float worldSize, float heightScale, float baseHeight);
+    bool isLoaded() const { return loaded; }
+
+    // Render nit, jednom po frejmu. Piramida pogleda i kamera su u prostoru terena (vidi Frustum::extract
+    // sa projection * view * model). projectionScale = visina prozora / (2 * tan(fov / 2)).
+    void update(const Frustum& frustum, const glm::vec3& cameraPosition, float projectionScale);
+
+    // Snima po jednu indeksiranu draw komandu za svaki vidljiv deo. chunkDraw daje program, teksturu,
+    // matricu modela i stanje; mreza mora biti registrovana preko vertexArray() (Renderer::registerMesh).
+    void submit(CommandBuffer& commands, const DrawCommand& chunkDraw) const;
+    // VAO nastaje tek kad se teren ucita, pa Renderer cita ime preko pokazivaca
+    const GLuint* vertexArray() const { return &vao; }
+
+    void release();
+
+    // Dozvoljena greska u pikselima pre prelaska na grublji nivo
+    void setPixelError(float pixels) { pixelError = pixels; }
+
+    int visibleChunks() const { return visibleCount; }
+    int culledChunks() const { return (int)chunks.size() - visibleCount; }
+    int drawnTriangles() const { return triangleCount; }
+
+private:
+    enum Side {
+        SIDE_LEFT = 1,      // -X
+        SIDE_RIGHT = 2,     // +X
+        SIDE_NEAR = 4,      // -Z
+        SIDE_FAR = 8        // +Z
+    };
+
+    struct Chunk {
+        glm::vec3 minCorner;
+        glm::vec3 maxCorner;
+        float error[MAX_LODS];  // najveca greska visine za svaki nivo (u jedinicama sveta)
+        int baseVertex;
+        int lod;
+        int coarserSides;       // Side maska suseda sa grubljim nivoom
+        bool visible;
+    };
+
+    struct IndexRange {
+        size_t offset;          // u indeksima dok se gradi, u bajtovima posle upload-a
+        GLsizei count;
+    };
+
+    // Rezultat rada radne niti
+    struct BuildData {
+        int gridSize;
+        std::vector<float> vertices;        // pozicija, UV, normala - isti raspored kao ravan mape
+        std::vector<uint32_t> indices;
+        std::vector<IndexRange> ranges;
+        std::vector<Chunk> chunks;
+    };
+
+    static bool readHeightmap(const char* path, std::vector<uint16_t>& heights, int& width, int& height);
+    static void build(const std::vector<uint16_t>& heights, int width, int height, float worldSize, float heightScale, float baseHeight, BuildData& data);
+    static void buildIndices(int gridSize, int lod, int coarserSides, std::vector<uint32_t>& indices);
+    void upload(BuildData& data, LinearArena& scratch);
+
+    bool loaded;
+    int gridSize;
+    int chunksPerSide;
+    int lodCount;
+    float pixelError;
+    int visibleCount;
+    int triangleCount;
+
+    GLuint vao;
+    GLuint vbo;
+    GLuint ibo;
+    GLenum indexType;
+    size_t indexSize;
+
+    std::vector<Chunk> chunks;
+    std::vector<IndexRange> ranges;     // [lod * 16 + strane sa grubljim susedom]
+};
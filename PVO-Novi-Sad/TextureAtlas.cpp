@@ -0,0 +1,367 @@
+#include "TextureAtlas.h"
+#include "AssetLoader.h"
+#include "Renderer.h"
+#include "TextureCompression.h"
+#include "TextureStreamer.h"
+#include "stb_image.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+using namespace std;
+using namespace glm;
+
+static const size_t LAYER_BYTES = (size_t)TextureAtlas::LAYER_SIZE * TextureAtlas::LAYER_SIZE * 4;
+
+static string getLayerPath(const string& directory, int layer)
+{
+    return directory + "/layer" + to_string(layer) + ".dds";
+}
+
+static void setAtlasParameters()
+{
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // Manje mipmape bi mesale susedne slike
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, TextureAtlas::LEVEL_COUNT - 1);
+}
+
+// Vezuje novi niz sa skladistem za sve nivoe; sa ARB_texture_storage je nepromenljivo (glTexStorage3D)
+static GLuint createArray(GLenum format, int layers)
+{
+    GLuint array;
+    glGenTextures(1, &array);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, array);
+    if (GLEW_ARB_texture_storage) {
+        glTexStorage3D(GL_TEXTURE_2D_ARRAY, TextureAtlas::LEVEL_COUNT, format, TextureAtlas::LAYER_SIZE, TextureAtlas::LAYER_SIZE, layers);
+        return array;
+    }
+
+    bool compressed = format != GL_RGBA8;
+    int size = TextureAtlas::LAYER_SIZE;
+    for (int level = 0; level < TextureAtlas::LEVEL_COUNT; ++level) {
+        if (compressed) {
+            GLsizei levelSize = (GLsizei)(getBlockLevelSize(BlockFormat::BC3, size, size) * layers);
+            glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, format, size, size, layers, 0, levelSize, NULL);
+        }
+        else {
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, level, format, size, size, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        }
+        size /= 2;
+    }
+    return array;
+}
+
+TextureAtlas::TextureAtlas(AssetLoader& loader, Renderer& renderer, TextureStreamer& streamer)
+    : loader(loader), renderer(renderer), streamer(streamer), textureName(0), layers(0),
+      pendingTexture(0), pendingLayers(0), pendingFailed(false)
+{
+    // Tamno sivo kao nekadasnji placeholder mape; alfa 0 je prazan placeholder imena (name_surname.frag)
+    const unsigned char placeholder[4] = { 40, 40, 40, 0 };
+    glGenTextures(1, &textureName);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, textureName);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, 1, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void TextureAtlas::add(const char* imagePath, int material)
+{
+    Entry entry = { imagePath, material };
+    entries.push_back(entry);
+    renderer.setMaterialTexture(material, 0, vec4(0.0f, 0.0f, 1.0f, 1.0f));
+}
+
+void TextureAtlas::build(const char* cookedDirectory)
+{
+    // Podrska za format se proverava na render niti (GLEW)
+    bool compress = isBlockFormatSupported(BlockFormat::BC3);
+    vector<Entry> atlasEntries = entries;
+    string directory = cookedDirectory;
+
+    loader.submit([this, atlasEntries, compress, directory] {
+        // Kuvani slojevi su BC3, pa se bez podrske za BC3 atlas uvek slaze ovde (RGBA8)
+        shared_ptr<BuildData> data = make_shared<BuildData>();
+        if (compress && readLayout(directory, atlasEntries, *data)) {
+            loader.queueUpload([this, data, directory] { streamLayers(data, directory); });
+            return;
+        }
+        if (compress) {
+            cout << "Atlas tekstura nije napravljen sa --cook, slaze se pri ucitavanju" << endl;
+        }
+        packAndUpload(atlasEntries, compress);
+    });
+}
+
+void TextureAtlas::packAndUpload(const vector<Entry>& atlasEntries, bool compress)
+{
+    shared_ptr<BuildData> data = make_shared<BuildData>();
+    pack(atlasEntries, compress, *data);
+    if (data->layers == 0) {
+        return;
+    }
+    loader.queueUpload([this, data] { upload(*data); });
+}
+
+void TextureAtlas::pack(const vector<Entry>& entries, bool compress, BuildData& data)
+{
+    const int maxSide = LAYER_SIZE - 2 * PADDING;
+
+    struct Image {
+        vector<unsigned char> rgba;
+        int width;
+        int height;
+    };
+    vector<Image> images(entries.size());
+    data.entryLayers.assign(entries.size(), -1);
+    data.entryRects.assign(entries.size(), vec4(0.0f, 0.0f, 1.0f, 1.0f));
+
+    vector<int> order;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        int channels;
+        Image& image = images[i];
+        unsigned char* pixels = stbi_load(entries[i].path.c_str(), &image.width, &image.height, &channels, 4);
+        if (pixels == NULL) {
+            cout << "Textura nije ucitana! Putanja texture: " << entries[i].path << endl;
+            continue;
+        }
+        image.rgba.assign(pixels, pixels + (size_t)image.width * image.height * 4);
+        stbi_image_free(pixels);
+
+        // Slika veca od sloja se smanjuje dok ne stane
+        vector<unsigned char> smaller;
+        while (image.width > maxSide || image.height > maxSide) {
+            downsampleImage(image.rgba.data(), image.width, image.height, smaller, image.width, image.height);
+            image.rgba.swap(smaller);
+        }
+        order.push_back((int)i);
+    }
+
+    // Police: slike se redjaju po visini, svaka polica je visoka kao njena prva (najvisa) slika
+    sort(order.begin(), order.end(), [&images](int a, int b) { return images[a].height > images[b].height; });
+    int layer = -1, shelfX = LAYER_SIZE, shelfY = 0, shelfHeight = 0;
+    vector<ivec2> origins(entries.size());
+    for (int index : order) {
+        int width = images[index].width + 2 * PADDING;
+        int height = images[index].height + 2 * PADDING;
+        if (shelfX + width > LAYER_SIZE) {
+            shelfY += shelfHeight;
+            shelfX = 0;
+            shelfHeight = height;
+        }
+        if (layer < 0 || shelfY + height > LAYER_SIZE) {
+            layer++;
+            shelfY = 0;
+            shelfHeight = height;
+        }
+        data.entryLayers[index] = layer;
+        origins[index] = ivec2(shelfX + PADDING, shelfY + PADDING);
+        data.entryRects[index] = vec4(origins[index].x, origins[index].y, images[index].width, images[index].height) / (float)LAYER_SIZE;
+        shelfX += width;
+    }
+    data.layers = layer + 1;
+    data.compressed = compress;
+    if (data.layers == 0) {
+        return;
+    }
+
+    // Nivo 0: svaka slika sa ivicom ponovljenih piksela oko sebe
+    vector<unsigned char> level(LAYER_BYTES * data.layers, 0);
+    for (int index : order) {
+        const Image& image = images[index];
+        unsigned char* layerPixels = level.data() + LAYER_BYTES * data.entryLayers[index];
+        for (int y = -PADDING; y < image.height + PADDING; ++y) {
+            int sourceY = std::min(std::max(y, 0), image.height - 1);
+            for (int x = -PADDING; x < image.width + PADDING; ++x) {
+                int sourceX = std::min(std::max(x, 0), image.width - 1);
+                const unsigned char* source = &image.rgba[((size_t)sourceY * image.width + sourceX) * 4];
+                unsigned char* target = layerPixels + ((size_t)(origins[index].y + y) * LAYER_SIZE + origins[index].x + x) * 4;
+                copy(source, source + 4, target);
+            }
+        }
+    }
+    vector<Image>().swap(images);
+
+    // Mipmape sloj po sloj (box filter kao u cooker-u), pa BC3 blokovi ako ih GPU podrzava
+    vector<unsigned char> layerLevel, nextLevel;
+    int size = LAYER_SIZE;
+    data.levels.resize(LEVEL_COUNT);
+    for (int levelIndex = 0; levelIndex < LEVEL_COUNT; ++levelIndex) {
+        size_t levelBytes = (size_t)size * size * 4;
+        size_t blockBytes = getBlockLevelSize(BlockFormat::BC3, size, size);
+        vector<unsigned char>& out = data.levels[levelIndex];
+        out.resize((compress ? blockBytes : levelBytes) * data.layers);
+        for (int l = 0; l < data.layers; ++l) {
+            const unsigned char* pixels = level.data() + levelBytes * l;
+            if (compress) {
+                compressLevel(pixels, size, size, BlockFormat::BC3, out.data() + blockBytes * l);
+            }
+            else {
+                copy(pixels, pixels + levelBytes, out.begin() + levelBytes * l);
+            }
+        }
+        if (levelIndex + 1 == LEVEL_COUNT) {
+            break;
+        }
+
+        int nextSize = size;
+        nextLevel.clear();
+        for (int l = 0; l < data.layers; ++l) {
+            downsampleImage(level.data() + levelBytes * l, size, size, layerLevel, nextSize, nextSize);
+            nextLevel.insert(nextLevel.end(), layerLevel.begin(), layerLevel.end());
+        }
+        level.swap(nextLevel);
+        size = nextSize;
+    }
+}
+
+void TextureAtlas::upload(BuildData& data)
+{
+    GLenum format = data.compressed ? getBlockFormatGL(BlockFormat::BC3) : GL_RGBA8;
+    GLuint atlas = createArray(format, data.layers);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    int size = LAYER_SIZE;
+    for (int level = 0; level < LEVEL_COUNT; ++level) {
+        const vector<unsigned char>& pixels = data.levels[level];
+        if (data.compressed) {
+            glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, 0, size, size, data.layers, format, (GLsizei)pixels.size(), pixels.data());
+        }
+        else {
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, 0, size, size, data.layers, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        }
+        size /= 2;
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    setAtlasParameters();
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    finish(data, atlas, data.compressed ? "BC3" : "RGBA8");
+}
+
+void TextureAtlas::streamLayers(shared_ptr<BuildData> data, const string& directory)
+{
+    // Skladiste za sve slojeve (sadrzaj nedefinisan), a TextureStreamer puni sloj po sloj
+    pendingTexture = createArray(getBlockFormatGL(BlockFormat::BC3), data->layers);
+    setAtlasParameters();
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    pendingLayers = data->layers;
+    pendingFailed = false;
+    for (int layer = 0; layer < data->layers; ++layer) {
+        streamer.requestLayer(getLayerPath(directory, layer).c_str(), pendingTexture, layer, [this, data](bool uploaded) {
+            pendingFailed = pendingFailed || !uploaded;
+            if (--pendingLayers > 0) {
+                return;
+            }
+
+            GLuint atlas = pendingTexture;
+            pendingTexture = 0;
+            if (pendingFailed) {
+                // Nedostaje ili ne valja neki sloj -> atlas se ipak slaze iz slika
+                glDeleteTextures(1, &atlas);
+                vector<Entry> atlasEntries = entries;
+                loader.submit([this, atlasEntries] { packAndUpload(atlasEntries, true); });
+                return;
+            }
+            finish(*data, atlas, "BC3, --cook");
+        });
+    }
+}
+
+void TextureAtlas::finish(const BuildData& data, GLuint atlas, const char* source)
+{
+    glDeleteTextures(1, &textureName);
+    textureName = atlas;
+    layers = data.layers;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        renderer.setMaterialTexture(entries[i].material, data.entryLayers[i], data.entryRects[i]);
+    }
+    cout << "Atlas tekstura: " << entries.size() << " slika u " << layers << " sloja, " << source << endl;
+}
+
+bool TextureAtlas::readLayout(const string& directory, const vector<Entry>& entries, BuildData& data)
+{
+    ifstream layout(directory + "/atlas.txt");
+    int layerSize, levelCount;
+    if (!layout.is_open() || !(layout >> data.layers >> layerSize >> levelCount) || data.layers <= 0
+        || layerSize != LAYER_SIZE || levelCount != LEVEL_COUNT) {
+        return false;
+    }
+
+    // Red po slici: sloj, pravougaonik i putanja; lista mora biti ista kao u add pozivima
+    data.compressed = true;
+    data.entryLayers.resize(entries.size());
+    data.entryRects.resize(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        vec4& rect = data.entryRects[i];
+        string path;
+        if (!(layout >> data.entryLayers[i] >> rect.x >> rect.y >> rect.z >> rect.w >> path) || path != entries[i].path
+            || data.entryLayers[i] < -1 || data.entryLayers[i] >= data.layers) {
+            return false;
+        }
+    }
+    string extra;
+    return !(layout >> extra);
+}
+
+bool TextureAtlas::cook(const vector<string>& imagePaths, const char* directory)
+{
+    vector<Entry> cookEntries;
+    for (const string& path : imagePaths) {
+        Entry entry = { path, -1 };
+        cookEntries.push_back(entry);
+    }
+
+    BuildData data;
+    pack(cookEntries, true, data);
+    if (find(data.entryLayers.begin(), data.entryLayers.end(), -1) != data.entryLayers.end()) {
+        cout << "Atlas tekstura nije napravljen" << endl;
+        return false;
+    }
+
+#ifdef _WIN32
+    _mkdir(directory);
+#else
+    mkdir(directory, 0755);
+#endif
+
+    // Svaki sloj u svoj .dds: njegovi nivoi jedan za drugim, kao u loadDDS
+    for (int layer = 0; layer < data.layers; ++layer) {
+        vector<unsigned char> blocks;
+        for (const vector<unsigned char>& level : data.levels) {
+            size_t layerBytes = level.size() / data.layers;
+            blocks.insert(blocks.end(), level.begin() + layerBytes * layer, level.begin() + layerBytes * (layer + 1));
+        }
+        string path = getLayerPath(directory, layer);
+        if (!writeDDS(path.c_str(), BlockFormat::BC3, LAYER_SIZE, LAYER_SIZE, LEVEL_COUNT, blocks.data(), blocks.size())) {
+            return false;
+        }
+    }
+
+    ofstream layout(string(directory) + "/atlas.txt");
+    layout << data.layers << " " << LAYER_SIZE << " " << LEVEL_COUNT << endl;
+    layout << setprecision(9);
+    for (size_t i = 0; i < imagePaths.size(); ++i) {
+        const vec4& rect = data.entryRects[i];
+        layout << data.entryLayers[i] << " " << rect.x << " " << rect.y << " " << rect.z << " " << rect.w << " " << imagePaths[i] << endl;
+    }
+    if (!layout.good()) {
+        cout << "Greska pri upisu fajla \"" << directory << "/atlas.txt\"!" << endl;
+        return false;
+    }
+
+    cout << "Atlas tekstura: " << imagePaths.size() << " slika -> " << directory << " (" << data.layers << " sloja, BC3, "
+         << LEVEL_COUNT << " nivoa)" << endl;
+    return true;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class AssetLoader;
+class Renderer;
+class TextureStreamer;
+
+// Atlas tekstura scene u jednom GL_TEXTURE_2D_ARRAY objektu.
+// Male slike se slazu u slojeve od LAYER_SIZE x LAYER_SIZE po policama (shelf packing, prvo najvise), a sloj
+// i UV pravougaonik svake slike se upisuju u zapis njenog materijala u MaterialTable. Sva teksturisana
+// geometrija zato koristi istu vezanu teksturu na jedinici 0, a shader bira sliku po materijalu crtanja.
+// Oko svake slike je PADDING ponovljenih ivicnih piksela, pa susedne slike ne cure jedna u drugu ni na
+// najmanjem nivou mipmape (PADDING >> (LEVEL_COUNT - 1) = 1 piksel). Ponavljanje (repeat) radi shader
+// preko fract() unutar pravougaonika, jer wrap parametri vaze za ceo sloj.
+// Slojeve jednom slaze cooker (PVO.exe --cook -> cook): BC3 .dds po sloju i atlas.txt sa slojem i
+// pravougaonikom svake slike. Igra tada samo strimuje gotove slojeve kroz TextureStreamer (PBO).
+// Bez kuvanih slojeva za istu listu slika (ili bez BC3 na GPU-u) dekodiranje, slaganje, mipmape i
+// kompresija rade se pri ucitavanju, na radnoj niti.
+// Redovi slike se NE okrecu - shaderi koriste t = 1 - t, kao i ranije.
+class TextureAtlas
+{
+public:
+    static const int LAYER_SIZE = 1024;
+    static const int PADDING = 16;
+    static const int LEVEL_COUNT = 5;
+
+    // Render nit: pravi 1x1 placeholder koji vazi dok se atlas ne sagradi
+    TextureAtlas(AssetLoader& loader, Renderer& renderer, TextureStreamer& streamer);
+
+    TextureAtlas(const TextureAtlas&) = delete;
+    TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+    // Slika za materijal (indeks iz Renderer::addMaterials); do build-a materijal vidi placeholder
+    void add(const char* imagePath, int material);
+    // Jednom, posle svih add poziva; cookedDirectory je direktorijum iz cook. Kad atlas stigne, placeholder
+    // se brise, a texture() dobija novi objekat.
+    void build(const char* cookedDirectory);
+
+    // Cooker: slike (u redosledu add poziva u igri) -> layer<N>.dds i atlas.txt u directory
+    static bool cook(const std::vector<std::string>& imagePaths, const char* directory);
+
+    // Za Renderer::registerTexture(atlas.texture(), GL_TEXTURE_2D_ARRAY); Renderer ga brise u release()
+    const GLuint* texture() const { return &textureName; }
+    int layerCount() const { return layers; }
+
+private:
+    struct Entry {
+        std::string path;
+        int material;
+    };
+
+    // Rezultat rada radne niti
+    struct BuildData {
+        int layers;
+        bool compressed;
+        std::vector<std::vector<unsigned char>> levels;    // svi slojevi jednog nivoa, jedan za drugim
+        std::vector<int> entryLayers;                       // -1 ako slika nije ucitana
+        std::vector<glm::vec4> entryRects;
+    };
+
+    static void pack(const std::vector<Entry>& entries, bool compress, BuildData& data);
+    static bool readLayout(const std::string& directory, const std::vector<Entry>& entries, BuildData& data);
+    void packAndUpload(const std::vector<Entry>& atlasEntries, bool compress);
+    void upload(BuildData& data);
+    void streamLayers(std::shared_ptr<BuildData> data, const std::string& directory);
+    void finish(const BuildData& data, GLuint atlas, const char* source);
+
+    AssetLoader& loader;
+    Renderer& renderer;
+    TextureStreamer& streamer;
+    GLuint textureName;
+    int layers;
+    GLuint pendingTexture;      // niz koji se puni kuvanim slojevima
+    int pendingLayers;
+    bool pendingFailed;
+    std::vector<Entry> entries;
+};
@@ -0,0 +1,354 @@
+#include "TextureCompression.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+
+// DDS konstante (vidi DirectX dokumentaciju za DDS_HEADER i DDS_HEADER_DXT10)
+static const uint32_t DDS_MAGIC = 0x20534444;          // "DDS "
+static const uint32_t DDS_FOURCC_DXT1 = 0x31545844;    // "DXT1"
+static const uint32_t DDS_FOURCC_DXT5 = 0x35545844;    // "DXT5"
+static const uint32_t DDS_FOURCC_DX10 = 0x30315844;    // "DX10"
+static const uint32_t DDPF_FOURCC = 0x4;
+static const uint32_t DDSD_CAPS = 0x1, DDSD_HEIGHT = 0x2, DDSD_WIDTH = 0x4, DDSD_PIXELFORMAT = 0x1000;
+static const uint32_t DDSD_MIPMAPCOUNT = 0x20000, DDSD_LINEARSIZE = 0x80000;
+static const uint32_t DDSCAPS_COMPLEX = 0x8, DDSCAPS_TEXTURE = 0x1000, DDSCAPS_MIPMAP = 0x400000;
+static const uint32_t DXGI_FORMAT_BC1_UNORM = 71;
+static const uint32_t DXGI_FORMAT_BC3_UNORM = 77;
+static const uint32_t DXGI_FORMAT_BC7_UNORM = 98;
+
+struct DDSPixelFormat {
+    uint32_t size;
+    uint32_t flags;
+    uint32_t fourCC;
+    uint32_t rgbBitCount;
+    uint32_t rBitMask, gBitMask, bBitMask, aBitMask;
+};
+
+struct DDSHeader {
+    uint32_t size;
+    uint32_t flags;
+    uint32_t height;
+    uint32_t width;
+    uint32_t pitchOrLinearSize;
+    uint32_t depth;
+    uint32_t mipMapCount;
+    uint32_t reserved1[11];
+    DDSPixelFormat pixelFormat;
+    uint32_t caps, caps2, caps3, caps4;
+    uint32_t reserved2;
+};
+
+struct DDSHeaderDX10 {
+    uint32_t dxgiFormat;
+    uint32_t resourceDimension;
+    uint32_t miscFlag;
+    uint32_t arraySize;
+    uint32_t miscFlags2;
+};
+
+GLenum getBlockFormatGL(BlockFormat format)
+{
+    switch (format) {
+    case BlockFormat::BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    case BlockFormat::BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    default: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+    }
+}
+
+bool isBlockFormatSupported(BlockFormat format)
+{
+    if (format == BlockFormat::BC7) {
+        return GLEW_ARB_texture_compression_bptc || GLEW_VERSION_4_2;
+    }
+    return GLEW_EXT_texture_compression_s3tc != 0;
+}
+
+size_t getBlockLevelSize(BlockFormat format, int width, int height)
+{
+    size_t blockBytes = format == BlockFormat::BC1 ? 8 : 16;
+    size_t blocksX = width > 0 ? (width + 3) / 4 : 1;
+    size_t blocksY = height > 0 ? (height + 3) / 4 : 1;
+    return blocksX * blocksY * blockBytes;
+}
+
+bool loadDDS(const char* filePath, CompressedImage& image)
+{
+    ifstream file(filePath, ios::binary | ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+    size_t fileSize = (size_t)file.tellg();
+    file.seekg(0);
+
+    uint32_t magic = 0;
+    DDSHeader header;
+    if (fileSize < sizeof(magic) + sizeof(header)) {
+        return false;
+    }
+    file.read((char*)&magic, sizeof(magic));
+    file.read((char*)&header, sizeof(header));
+    if (magic != DDS_MAGIC || header.size != sizeof(DDSHeader) || !(header.pixelFormat.flags & DDPF_FOURCC)) {
+        cout << "DDS fajl nije podrzan: " << filePath << endl;
+        return false;
+    }
+
+    size_t headerSize = sizeof(magic) + sizeof(header);
+    if (header.pixelFormat.fourCC == DDS_FOURCC_DXT1) {
+        image.format = BlockFormat::BC1;
+    }
+    else if (header.pixelFormat.fourCC == DDS_FOURCC_DXT5) {
+        image.format = BlockFormat::BC3;
+    }
+    else if (header.pixelFormat.fourCC == DDS_FOURCC_DX10) {
+        DDSHeaderDX10 dx10;
+        if (fileSize < headerSize + sizeof(dx10)) {
+            return false;
+        }
+        file.read((char*)&dx10, sizeof(dx10));
+        headerSize += sizeof(dx10);
+
+        if (dx10.dxgiFormat == DXGI_FORMAT_BC1_UNORM) image.format = BlockFormat::BC1;
+        else if (dx10.dxgiFormat == DXGI_FORMAT_BC3_UNORM) image.format = BlockFormat::BC3;
+        else if (dx10.dxgiFormat == DXGI_FORMAT_BC7_UNORM) image.format = BlockFormat::BC7;
+        else {
+            cout << "DDS format nije podrzan: " << filePath << endl;
+            return false;
+        }
+    }
+    else {
+        cout << "DDS format nije podrzan: " << filePath << endl;
+        return false;
+    }
+
+    image.width = (int)header.width;
+    image.height = (int)header.height;
+    int levels = (header.flags & DDSD_MIPMAPCOUNT) && header.mipMapCount > 0 ? (int)header.mipMapCount : 1;
+
+    image.levelOffsets.clear();
+    image.levelSizes.clear();
+    size_t total = 0;
+    int levelWidth = image.width, levelHeight = image.height;
+    for (int level = 0; level < levels; ++level) {
+        size_t levelSize = getBlockLevelSize(image.format, levelWidth, levelHeight);
+        image.levelOffsets.push_back(total);
+        image.levelSizes.push_back(levelSize);
+        total += levelSize;
+        levelWidth = levelWidth > 1 ? levelWidth / 2 : 1;
+        levelHeight = levelHeight > 1 ? levelHeight / 2 : 1;
+    }
+
+    if (fileSize - headerSize < total) {
+        cout << "DDS fajl je ostecen: " << filePath << endl;
+        return false;
+    }
+
+    image.data = new unsigned char[total];
+    image.dataSize = total;
+    file.read((char*)image.data, total);
+    return true;
+}
+
+void freeCompressedImage(CompressedImage& image)
+{
+    delete[] image.data;
+    image.data = NULL;
+    image.dataSize = 0;
+}
+
+// ********************************************** COOKER **********************************************
+
+static uint16_t packColor565(const unsigned char* color)
+{
+    return (uint16_t)(((color[0] >> 3) << 11) | ((color[1] >> 2) << 5) | (color[2] >> 3));
+}
+
+static void unpackColor565(uint16_t packed, int* color)
+{
+    int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+    color[0] = (r << 3) | (r >> 2);
+    color[1] = (g << 2) | (g >> 4);
+    color[2] = (b << 3) | (b >> 2);
+}
+
+// BC1 blok boje: "inset bounding box" - min/max po kanalima, dijagonala se bira po znaku kovarijanse
+static void encodeColorBlock(const unsigned char* block, unsigned char* out)
+{
+    int minColor[3] = { 255, 255, 255 }, maxColor[3] = { 0, 0, 0 };
+    int mean[3] = { 0, 0, 0 };
+    for (int i = 0; i < 16; ++i) {
+        for (int c = 0; c < 3; ++c) {
+            int value = block[i * 4 + c];
+            minColor[c] = value < minColor[c] ? value : minColor[c];
+            maxColor[c] = value > maxColor[c] ? value : maxColor[c];
+            mean[c] += value;
+        }
+    }
+
+    int covRG = 0, covRB = 0;
+    for (int i = 0; i < 16; ++i) {
+        int r = block[i * 4] * 16 - mean[0];
+        covRG += r * (block[i * 4 + 1] * 16 - mean[1]);
+        covRB += r * (block[i * 4 + 2] * 16 - mean[2]);
+    }
+
+    for (int c = 0; c < 3; ++c) {
+        int inset = (maxColor[c] - minColor[c]) >> 4;
+        minColor[c] += inset;
+        maxColor[c] -= inset;
+    }
+    if (covRG < 0) { int t = minColor[1]; minColor[1] = maxColor[1]; maxColor[1] = t; }
+    if (covRB < 0) { int t = minColor[2]; minColor[2] = maxColor[2]; maxColor[2] = t; }
+
+    unsigned char endpoint0[3] = { (unsigned char)maxColor[0], (unsigned char)maxColor[1], (unsigned char)maxColor[2] };
+    unsigned char endpoint1[3] = { (unsigned char)minColor[0], (unsigned char)minColor[1], (unsigned char)minColor[2] };
+    uint16_t color0 = packColor565(endpoint0);
+    uint16_t color1 = packColor565(endpoint1);
+    if (color0 < color1) {
+        uint16_t t = color0; color0 = color1; color1 = t;
+    }
+
+    // color0 > color1 -> 4-bojni mod
+    int palette[4][3];
+    unpackColor565(color0, palette[0]);
+    unpackColor565(color1, palette[1]);
+    for (int c = 0; c < 3; ++c) {
+        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+
+    uint32_t indices = 0;
+    if (color0 != color1) {
+        for (int i = 0; i < 16; ++i) {
+            int best = 0, bestDistance = 1 << 30;
+            for (int p = 0; p < 4; ++p) {
+                int dr = block[i * 4] - palette[p][0];
+                int dg = block[i * 4 + 1] - palette[p][1];
+                int db = block[i * 4 + 2] - palette[p][2];
+                int distance = dr * dr + dg * dg + db * db;
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    best = p;
+                }
+            }
+            indices |= (uint32_t)best << (2 * i);
+        }
+    }
+
+    out[0] = color0 & 0xFF; out[1] = color0 >> 8;
+    out[2] = color1 & 0xFF; out[3] = color1 >> 8;
+    out[4] = indices & 0xFF; out[5] = (indices >> 8) & 0xFF;
+    out[6] = (indices >> 16) & 0xFF; out[7] = indices >> 24;
+}
+
+// BC3 alfa blok: 8 interpolisanih vrednosti izmedju min i max alfe, 3 bita po pikselu
+static void encodeAlphaBlock(const unsigned char* block, unsigned char* out)
+{
+    int minAlpha = 255, maxAlpha = 0;
+    for (int i = 0; i < 16; ++i) {
+        int alpha = block[i * 4 + 3];
+        minAlpha = alpha < minAlpha ? alpha : minAlpha;
+        maxAlpha = alpha > maxAlpha ? alpha : maxAlpha;
+    }
+
+    int palette[8];
+    palette[0] = maxAlpha;
+    palette[1] = minAlpha;
+    for (int p = 1; p < 7; ++p) {
+        palette[p + 1] = ((7 - p) * maxAlpha + p * minAlpha) / 7;
+    }
+
+    uint64_t indices = 0;
+    if (maxAlpha != minAlpha) {
+        for (int i = 0; i < 16; ++i) {
+            int best = 0, bestDistance = 1 << 30;
+            for (int p = 0; p < 8; ++p) {
+                int distance = abs(block[i * 4 + 3] - palette[p]);
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    best = p;
+                }
+            }
+            indices |= (uint64_t)best << (3 * i);
+        }
+    }
+
+    out[0] = (unsigned char)maxAlpha;
+    out[1] = (unsigned char)minAlpha;
+    for (int b = 0; b < 6; ++b) {
+        out[2 + b] = (unsigned char)((indices >> (8 * b)) & 0xFF);
+    }
+}
+
+void compressLevel(const unsigned char* rgba, int width, int height, BlockFormat format, unsigned char* out)
+{
+    unsigned char block[64];
+    for (int by = 0; by < height; by += 4) {
+        for (int bx = 0; bx < width; bx += 4) {
+            // Ivicni blokovi manji od 4x4 ponavljaju poslednji red/kolonu
+            for (int y = 0; y < 4; ++y) {
+                for (int x = 0; x < 4; ++x) {
+                    int sx = bx + x < width ? bx + x : width - 1;
+                    int sy = by + y < height ? by + y : height - 1;
+                    memcpy(block + (y * 4 + x) * 4, rgba + ((size_t)sy * width + sx) * 4, 4);
+                }
+            }
+
+            if (format == BlockFormat::BC3) {
+                encodeAlphaBlock(block, out);
+                out += 8;
+            }
+            encodeColorBlock(block, out);
+            out += 8;
+        }
+    }
+}
+
+void downsampleImage(const unsigned char* src, int width, int height, vector<unsigned char>& dst, int& dstWidth, int& dstHeight)
+{
+    dstWidth = width > 1 ? width / 2 : 1;
+    dstHeight = height > 1 ? height / 2 : 1;
+    dst.resize((size_t)dstWidth * dstHeight * 4);
+
+    for (int y = 0; y < dstHeight; ++y) {
+        int y0 = y * 2, y1 = y * 2 + 1 < height ? y * 2 + 1 : height - 1;
+        for (int x = 0; x < dstWidth; ++x) {
+            int x0 = x * 2, x1 = x * 2 + 1 < width ? x * 2 + 1 : width - 1;
+            for (int c = 0; c < 4; ++c) {
+                int sum = src[((size_t)y0 * width + x0) * 4 + c] + src[((size_t)y0 * width + x1) * 4 + c]
+                        + src[((size_t)y1 * width + x0) * 4 + c] + src[((size_t)y1 * width + x1) * 4 + c];
+                dst[((size_t)y * dstWidth + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+            }
+        }
+    }
+}
+
+bool writeDDS(const char* ddsPath, BlockFormat format, int width, int height, int levels, const unsigned char* data, size_t dataSize)
+{
+    DDSHeader header;
+    memset(&header, 0, sizeof(header));
+    header.size = sizeof(DDSHeader);
+    header.flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE;
+    header.height = height;
+    header.width = width;
+    header.pitchOrLinearSize = (uint32_t)getBlockLevelSize(format, width, height);
+    header.mipMapCount = levels;
+    header.pixelFormat.size = sizeof(DDSPixelFormat);
+    header.pixelFormat.flags = DDPF_FOURCC;
+    header.pixelFormat.fourCC = format == BlockFormat::BC1 ? DDS_FOURCC_DXT1 : DDS_FOURCC_DXT5;
+    header.caps = DDSCAPS_TEXTURE | DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+
+    ofstream file(ddsPath, ios::binary);
+    if (!file.is_open()) {
+        cout << "Greska pri upisu fajla \"" << ddsPath << "\"!" << endl;
+        return false;
+    }
+    file.write((const char*)&DDS_MAGIC, sizeof(DDS_MAGIC));
+    file.write((const char*)&header, sizeof(header));
+    file.write((const char*)data, dataSize);
+    return file.good();
+}
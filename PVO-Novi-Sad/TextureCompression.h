@@ -0,0 +1,41 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <vector>
+
+// Blok-kompresovane teksture (BC1/BC3/BC7) u DDS kontejneru.
+// Runtime cita .dds i salje blokove na GPU, a enkodovanje radi "cooker" (PVO.exe --cook, TextureAtlas::cook)
+// koji slojeve atlasa upisuje kao .dds; bez njih TextureAtlas isto tako kompresuje slojeve pri ucitavanju.
+enum class BlockFormat {
+    BC1,    // RGB, 4 bita po pikselu
+    BC3,    // RGBA, 8 bita po pikselu
+    BC7     // RGBA visokog kvaliteta - samo ucitavanje, cooker ga ne pravi
+};
+
+struct CompressedImage {
+    BlockFormat format;
+    int width;
+    int height;
+    std::vector<size_t> levelOffsets;
+    std::vector<size_t> levelSizes;
+    unsigned char* data;    // new[] - oslobadja se sa freeCompressedImage
+    size_t dataSize;
+};
+
+GLenum getBlockFormatGL(BlockFormat format);
+bool isBlockFormatSupported(BlockFormat format);
+size_t getBlockLevelSize(BlockFormat format, int width, int height);
+
+bool loadDDS(const char* filePath, CompressedImage& image);
+void freeCompressedImage(CompressedImage& image);
+
+// Jedan nivo RGBA slike u BC1/BC3 blokove (out ima getBlockLevelSize bajtova); cooker i TextureAtlas
+void compressLevel(const unsigned char* rgba, int width, int height, BlockFormat format, unsigned char* out);
+
+// RGBA slika -> upola manja (2x2 box filter), koristi se za lance mipmapa u cooker-u
+void downsampleImage(const unsigned char* src, int width, int height, std::vector<unsigned char>& dst, int& dstWidth, int& dstHeight);
+
+// Cooker: blokovi svih nivoa jedan za drugim (kao sto ih loadDDS vraca) -> .dds fajl
+bool writeDDS(const char* ddsPath, BlockFormat format, int width, int height, int levels, const unsigned char* data, size_t dataSize);
@@ -0,0 +1,251 @@
+#include "TextureStreamer.h"
+#include "AssetLoader.h"
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+static const size_t STAGING_ALIGNMENT = 16;
+
+static size_t alignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+TextureStreamer::TextureStreamer(AssetLoader& loader, size_t stagingBytes)
+    : loader(loader), pbo(0), mapped(NULL), capacity(stagingBytes), persistent(false),
+      activeWriters(0), stopping(false)
+{
+    if (!GLEW_ARB_buffer_storage) {
+        return; // Bez trajnog mapiranja PBO ne donosi nista - slojevi idu direktno iz memorije
+    }
+
+    glGenBuffers(1, &pbo);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glBufferStorage(GL_PIXEL_UNPACK_BUFFER, capacity, NULL, flags);
+    mapped = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, capacity, flags);
+    persistent = mapped != NULL;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (!persistent) {
+        glDeleteBuffers(1, &pbo);
+        pbo = 0;
+    }
+}
+
+TextureStreamer::~TextureStreamer()
+{
+    // GL objekti se brisu u release(), dok kontekst jos postoji
+}
+
+void TextureStreamer::release()
+{
+    {
+        // Radne niti koje cekaju mesto u prstenu odustaju, a one koje vec pisu u PBO zavrsavaju pre unmap-a
+        unique_lock<mutex> lock(regionMutex);
+        stopping = true;
+        spaceAvailable.notify_all();
+        spaceAvailable.wait(lock, [this] { return activeWriters == 0; });
+
+        for (Region& region : regions) {
+            if (region.fence != 0) {
+                glDeleteSync(region.fence);
+            }
+        }
+        regions.clear();
+    }
+
+    if (pbo != 0) {
+        if (persistent) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            mapped = NULL;
+        }
+        glDeleteBuffers(1, &pbo);
+        pbo = 0;
+    }
+}
+
+bool TextureStreamer::tryReserve(size_t size, size_t& offset)
+{
+    // Poziva se pod regionMutex. Prsten: regioni su poredjani po redosledu rezervacije,
+    // oslobadja se uvek najstariji (front).
+    size = alignUp(size, STAGING_ALIGNMENT);
+    if (size > capacity) {
+        return false;
+    }
+
+    if (regions.empty()) {
+        offset = 0;
+    }
+    else {
+        size_t tail = regions.front().offset;
+        size_t head = regions.back().offset + regions.back().size;
+
+        if (regions.back().offset >= tail) {
+            // Zauzet deo je [tail, head) -> slobodno je [head, capacity) i [0, tail)
+            if (head + size <= capacity) {
+                offset = head;
+            }
+            else if (size <= tail) {
+                offset = 0;
+            }
+            else {
+                return false;
+            }
+        }
+        else {
+            // Prsten je presao preko kraja -> slobodno je samo [head, tail)
+            if (head + size <= tail) {
+                offset = head;
+            }
+            else {
+                return false;
+            }
+        }
+    }
+
+    Region region;
+    region.offset = offset;
+    region.size = size;
+    region.fence = 0;
+    regions.push_back(region);
+    return true;
+}
+
+bool TextureStreamer::reserve(size_t size, size_t& offset)
+{
+    unique_lock<mutex> lock(regionMutex);
+    if (alignUp(size, STAGING_ALIGNMENT) > capacity) {
+        return false;
+    }
+
+    spaceAvailable.wait(lock, [&] { return stopping || tryReserve(size, offset); });
+    if (stopping) {
+        return false;
+    }
+
+    activeWriters++;
+    return true;
+}
+
+void TextureStreamer::requestLayer(const char* ddsPath, const GLuint& texture, int layer, function<void(bool)> onUploaded)
+{
+    string path = ddsPath;
+    const GLuint* target = &texture;
+
+    loader.submit([this, path, target, layer, onUploaded] {
+        CompressedImage image;
+        if (!loadDDS(path.c_str(), image)) {
+            cout << "Sloj teksture nije ucitan: " << path << endl;
+            loader.queueUpload([onUploaded] { onUploaded(false); });
+            return;
+        }
+
+        size_t offset = 0;
+        if (persistent && reserve(image.dataSize, offset)) {
+            // Trajno mapiran PBO -> kopija ide direktno sa radne niti
+            memcpy(mapped + offset, image.data, image.dataSize);
+            freeCompressedImage(image);
+            {
+                lock_guard<mutex> lock(regionMutex);
+                activeWriters--;
+            }
+            spaceAvailable.notify_all();
+
+            loader.queueUpload([=] {
+                onUploaded(uploadLayer(*target, layer, image, true, offset));
+            });
+            return;
+        }
+
+        // Bez trajno mapiranog PBO-a (ili je sloj veci od prstena) -> obican upload iz memorije na render
+        // niti; AssetLoader::processUploads ih rasporedjuje po frejmovima kao i ostale upload-e
+        loader.queueUpload([=]() mutable {
+            bool uploaded = uploadLayer(*target, layer, image, false, 0);
+            freeCompressedImage(image);
+            onUploaded(uploaded);
+        });
+    });
+}
+
+bool TextureStreamer::uploadLayer(GLuint texture, int layer, const CompressedImage& image, bool fromStaging, size_t offset)
+{
+    GLint width = 0, height = 0, layers = 0, internalFormat = 0, maxLevel = 0;
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D_ARRAY, 0, GL_TEXTURE_WIDTH, &width);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D_ARRAY, 0, GL_TEXTURE_HEIGHT, &height);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D_ARRAY, 0, GL_TEXTURE_DEPTH, &layers);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D_ARRAY, 0, GL_TEXTURE_INTERNAL_FORMAT, &internalFormat);
+    glGetTexParameteriv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, &maxLevel);
+
+    int levels = maxLevel + 1;
+    bool matches = (GLenum)internalFormat == getBlockFormatGL(image.format) && image.width == width && image.height == height
+        && layer >= 0 && layer < layers && (int)image.levelSizes.size() >= levels;
+    if (matches) {
+        // Podaci se citaju iz PBO-a (pomeraj kao adresa) ili direktno iz memorije; racuna se celim brojem,
+        // jer aritmetika nad NULL pokazivacem nije definisana
+        uintptr_t source = fromStaging ? (uintptr_t)offset : (uintptr_t)image.data;
+        if (fromStaging) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+        }
+
+        int levelWidth = image.width, levelHeight = image.height;
+        for (int level = 0; level < levels; ++level) {
+            const void* levelData = (const void*)(source + image.levelOffsets[level]);
+            glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, levelWidth, levelHeight, 1, internalFormat, (GLsizei)image.levelSizes[level], levelData);
+            levelWidth = levelWidth > 1 ? levelWidth / 2 : 1;
+            levelHeight = levelHeight > 1 ? levelHeight / 2 : 1;
+        }
+
+        if (fromStaging) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+    }
+    else {
+        cout << "Sloj teksture ne odgovara nizu (format, velicina ili broj mipmapa)" << endl;
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    if (fromStaging) {
+        releaseStaging(offset);
+    }
+    return matches;
+}
+
+void TextureStreamer::releaseStaging(size_t offset)
+{
+    // Deo prstena se oslobadja tek kada GPU procita podatke iz PBO-a
+    GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    lock_guard<mutex> lock(regionMutex);
+    for (Region& region : regions) {
+        if (region.offset == offset && region.fence == 0) {
+            region.fence = fence;
+            break;
+        }
+    }
+}
+
+void TextureStreamer::update()
+{
+    bool freed = false;
+    {
+        lock_guard<mutex> lock(regionMutex);
+        while (!regions.empty() && regions.front().fence != 0) {
+            GLenum status = glClientWaitSync(regions.front().fence, 0, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+                break;
+            }
+            glDeleteSync(regions.front().fence);
+            regions.pop_front();
+            freed = true;
+        }
+    }
+
+    if (freed) {
+        spaceAvailable.notify_all();
+    }
+}
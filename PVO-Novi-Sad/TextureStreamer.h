@@ -0,0 +1,66 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+
+#include "TextureCompression.h"
+
+class AssetLoader;
+
+// Strimovanje kuvanih (.dds) slojeva u vec napravljen GL_TEXTURE_2D_ARRAY kroz pixel buffer object (PBO).
+// Fajlovi se citaju na radnim nitima AssetLoader-a. Sa ARB_buffer_storage PBO je trajno mapiran prsten
+// (ring) u koji radna nit kopira blokove, pa je upload iz PBO-a na render niti asinhron, a fence posle
+// svakog upload-a govori kada se taj deo prstena moze ponovo koristiti.
+// Bez trajnog mapiranja (ili za sloj veci od prstena) PBO se ne koristi: upload ide direktno iz memorije
+// i sinhron je, ali jedan po upload poslu, pa ga budzet AssetLoader::processUploads deli po frejmovima.
+// Koristi ga TextureAtlas za slojeve napravljene sa --cook.
+class TextureStreamer
+{
+public:
+    TextureStreamer(AssetLoader& loader, size_t stagingBytes = 16 * 1024 * 1024);
+    ~TextureStreamer();
+
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    // Sloj layer niza texture (skladiste i GL_TEXTURE_MAX_LEVEL vec postavljeni) puni se iz ddsPath; format i
+    // velicina fajla moraju odgovarati nizu. onUploaded(uspeh) se poziva na render niti, i kada fajl ne valja.
+    void requestLayer(const char* ddsPath, const GLuint& texture, int layer, std::function<void(bool)> onUploaded);
+
+    // Render nit, jednom po frejmu: vraca u prsten delove ciji je upload zavrsen
+    void update();
+
+    // Mora se pozvati dok GL kontekst jos postoji
+    void release();
+
+    bool isPersistent() const { return persistent; }
+
+private:
+    struct Region {
+        size_t offset;
+        size_t size;
+        GLsync fence;
+    };
+
+    bool tryReserve(size_t size, size_t& offset);
+    bool reserve(size_t size, size_t& offset);
+    bool uploadLayer(GLuint texture, int layer, const CompressedImage& image, bool fromStaging, size_t offset);
+    void releaseStaging(size_t offset);
+
+    AssetLoader& loader;
+    GLuint pbo;
+    unsigned char* mapped;
+    size_t capacity;
+    bool persistent;
+
+    std::deque<Region> regions;
+    std::mutex regionMutex;
+    std::condition_variable spaceAvailable;
+    int activeWriters;
+    bool stopping;
+};
@@ -0,0 +1,372 @@
+#include "TileMap.h"
+#include "AssetLoader.h"
+#include "TextureCompression.h"
+#include "stb_image.h"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+using namespace std;
+
+// Najvise plocica koje se istovremeno ucitavaju - ostale cekaju sledece frejmove
+static const int MAX_TILES_IN_FLIGHT = 8;
+
+// Oko kamere se na svakom nivou traze plocice do ove udaljenosti (u velicinama plocice tog nivoa)
+static const float REQUEST_RADIUS = 1.5f;
+
+static string getTilePath(const string& directory, int level, int x, int y)
+{
+    stringstream ss;
+    ss << directory << "/L" << level << "_" << x << "_" << y << ".tga";
+    return ss.str();
+}
+
+TileMap::TileMap(AssetLoader& loader, int cacheLayers)
+    : loader(loader), opened(false), tileSize(0), levelCount(0), cacheLayers(cacheLayers), inFlight(0),
+      residentCount(0), frame(0), tableDirty(false), cacheTexture(0), tableTexture(0)
+{
+}
+
+bool TileMap::open(const char* tileDirectory)
+{
+    directory = tileDirectory;
+    ifstream descriptor(directory + "/tiles.txt");
+    if (!descriptor.is_open() || !(descriptor >> tileSize >> levelCount) || tileSize <= 0 || levelCount <= 0) {
+        return false;
+    }
+    if (levelCount > 13) {
+        cout << "Previse nivoa plocica u " << directory << endl;
+        return false;
+    }
+
+    // Kes plocica: bez mipmapa, nivo detalja bira shader preko tabele
+    glGenTextures(1, &cacheTexture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, cacheTexture);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, tileSize, tileSize, cacheLayers, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    // Tabela indirekcije: RG16UI, jedan mip nivo po nivou plocica
+    glGenTextures(1, &tableTexture);
+    glBindTexture(GL_TEXTURE_2D, tableTexture);
+    table.resize(levelCount);
+    for (int level = 0; level < levelCount; ++level) {
+        int pages = pagesAt(level);
+        table[level].assign((size_t)pages * pages * 2, 0);
+        glTexImage2D(GL_TEXTURE_2D, level, GL_RG16UI, pages, pages, 0, GL_RG_INTEGER, GL_UNSIGNED_SHORT, NULL);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    layerOwners.assign(cacheLayers, 0xFFFFFFFFu);
+    opened = true;
+
+    // Najgrublji nivo je uvek u kesu da bi svaka plocica imala predka
+    requestTile(levelCount - 1, 0, 0, true);
+    return true;
+}
+
+void TileMap::requestTile(int level, int x, int y, bool pinned)
+{
+    uint32_t key = tileKey(level, x, y);
+    unordered_map<uint32_t, Tile>::iterator it = tiles.find(key);
+    if (it != tiles.end()) {
+        it->second.lastUsed = frame;
+        return;
+    }
+    if (inFlight >= MAX_TILES_IN_FLIGHT && !pinned) {
+        return;
+    }
+
+    Tile tile;
+    tile.layer = -1;
+    tile.lastUsed = frame;
+    tile.pinned = pinned;
+    tiles[key] = tile;
+    inFlight++;
+
+    // Radna nit samo dekodira - ne sme da dira TileMap jer se on moze unistiti pre kraja posla
+    string path = getTilePath(directory, level, x, y);
+    AssetLoader* assetLoader = &loader;
+    int expectedSize = tileSize;
+    loader.submit([this, assetLoader, path, key, expectedSize] {
+        int width, height, channels;
+        unsigned char* pixels = stbi_load(path.c_str(), &width, &height, &channels, 4);
+        if (pixels != NULL && (width != expectedSize || height != expectedSize)) {
+            cout << "Plocica pogresne velicine: " << path << endl;
+            stbi_image_free(pixels);
+            pixels = NULL;
+        }
+        else if (pixels == NULL) {
+            cout << "Plocica nije ucitana: " << path << endl;
+        }
+
+        assetLoader->queueUpload([this, key, pixels] {
+            uploadTile(key, pixels);
+        });
+    });
+}
+
+int TileMap::allocateLayer()
+{
+    for (int layer = 0; layer < cacheLayers; ++layer) {
+        if (layerOwners[layer] == 0xFFFFFFFFu) {
+            return layer;
+        }
+    }
+
+    // Kes je pun -> izbacujemo najduze nekoriscenu plocicu koja nije zakucana
+    int victimLayer = -1;
+    uint64_t oldest = frame + 1;
+    for (int layer = 0; layer < cacheLayers; ++layer) {
+        const Tile& tile = tiles[layerOwners[layer]];
+        if (!tile.pinned && tile.lastUsed < oldest) {
+            oldest = tile.lastUsed;
+            victimLayer = layer;
+        }
+    }
+
+    if (victimLayer >= 0) {
+        tiles.erase(layerOwners[victimLayer]);
+        layerOwners[victimLayer] = 0xFFFFFFFFu;
+        residentCount--;
+        tableDirty = true;
+    }
+    return victimLayer;
+}
+
+void TileMap::uploadTile(uint32_t key, unsigned char* pixels)
+{
+    inFlight--;
+    unordered_map<uint32_t, Tile>::iterator it = tiles.find(key);
+    if (pixels == NULL || !opened || it == tiles.end()) {
+        // Neuspelo ucitavanje ostaje u mapi (layer = -1) da se ne bi trazilo svaki frejm
+        stbi_image_free(pixels);
+        return;
+    }
+
+    int layer = allocateLayer();
+    if (layer < 0) {
+        tiles.erase(it);
+        stbi_image_free(pixels);
+        return;
+    }
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, cacheTexture);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, tileSize, tileSize, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    stbi_image_free(pixels);
+
+    it = tiles.find(key);
+    it->second.layer = layer;
+    layerOwners[layer] = key;
+    residentCount++;
+    tableDirty = true;
+}
+
+void TileMap::rebuildTable()
+{
+    // Od najgrubljeg ka najfinijem nivou: plocica koja nije u kesu nasledjuje zapis svog roditelja
+    for (int level = levelCount - 1; level >= 0; --level) {
+        int pages = pagesAt(level);
+        for (int y = 0; y < pages; ++y) {
+            for (int x = 0; x < pages; ++x) {
+                uint16_t* entry = &table[level][((size_t)y * pages + x) * 2];
+                unordered_map<uint32_t, Tile>::const_iterator it = tiles.find(tileKey(level, x, y));
+
+                if (it != tiles.end() && it->second.layer >= 0) {
+                    entry[0] = (uint16_t)it->second.layer;
+                    entry[1] = (uint16_t)level;
+                }
+                else if (level < levelCount - 1) {
+                    const uint16_t* parent = &table[level + 1][((size_t)(y / 2) * (pages / 2) + x / 2) * 2];
+                    entry[0] = parent[0];
+                    entry[1] = parent[1];
+                }
+                else {
+                    entry[0] = 0;
+                    entry[1] = (uint16_t)level;
+                }
+            }
+        }
+    }
+
+    glBindTexture(GL_TEXTURE_2D, tableTexture);
+    for (int level = 0; level < levelCount; ++level) {
+        int pages = pagesAt(level);
+        glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, pages, pages, GL_RG_INTEGER, GL_UNSIGNED_SHORT, table[level].data());
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    tableDirty = false;
+}
+
+void TileMap::update(const glm::vec2& cameraUV, float cameraHeight)
+{
+    if (!opened) {
+        return;
+    }
+    frame++;
+
+    // Od grubljih ka finijim nivoima (grublji su rezerva dok fini ne stignu).
+    // Na nivou l trazimo plocice u krugu od REQUEST_RADIUS plocica tog nivoa oko tacke ispod kamere,
+    // a nivo je dovoljno fin samo ako je kamera dovoljno blizu - visina kamere se racuna kao udaljenost.
+    for (int level = levelCount - 1; level >= 0; --level) {
+        int pages = pagesAt(level);
+        float pageSize = 1.0f / pages;
+        float radius = REQUEST_RADIUS * pageSize;
+        if (cameraHeight > radius * 2.0f && level < levelCount - 1) {
+            continue;
+        }
+
+        int minX = (int)floor((cameraUV.x - radius) * pages), maxX = (int)floor((cameraUV.x + radius) * pages);
+        int minY = (int)floor((cameraUV.y - radius) * pages), maxY = (int)floor((cameraUV.y + radius) * pages);
+        for (int y = minY < 0 ? 0 : minY; y <= maxY && y < pages; ++y) {
+            for (int x = minX < 0 ? 0 : minX; x <= maxX && x < pages; ++x) {
+                requestTile(level, x, y, level == levelCount - 1);
+            }
+        }
+    }
+
+    if (tableDirty) {
+        rebuildTable();
+    }
+}
+
+void TileMap::bind(unsigned int program, int cacheUnit, int tableUnit) const
+{
+    glActiveTexture(GL_TEXTURE0 + cacheUnit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, cacheTexture);
+    glActiveTexture(GL_TEXTURE0 + tableUnit);
+    glBindTexture(GL_TEXTURE_2D, tableTexture);
+    glActiveTexture(GL_TEXTURE0);
+
+    glUniform1i(glGetUniformLocation(program, "uTileCache"), cacheUnit);
+    glUniform1i(glGetUniformLocation(program, "uTileTable"), tableUnit);
+    glUniform1i(glGetUniformLocation(program, "uTileLevels"), levelCount);
+    glUniform1f(glGetUniformLocation(program, "uVirtualSize"), (float)(tileSize * pagesAt(0)));
+}
+
+void TileMap::release()
+{
+    opened = false;
+    glDeleteTextures(1, &cacheTexture);
+    glDeleteTextures(1, &tableTexture);
+    cacheTexture = 0;
+    tableTexture = 0;
+    tiles.clear();
+}
+
+// ********************************************** COOKER **********************************************
+
+static bool writeTGA(const string& path, const unsigned char* rgba, int width, int height)
+{
+    ofstream file(path, ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    // Nekompresovan truecolor, 32 bita, pocetak u gornjem levom uglu (bit 5 deskriptora)
+    unsigned char header[18] = { 0 };
+    header[2] = 2;
+    header[12] = width & 0xFF; header[13] = (width >> 8) & 0xFF;
+    header[14] = height & 0xFF; header[15] = (height >> 8) & 0xFF;
+    header[16] = 32;
+    header[17] = 0x28;
+    file.write((const char*)header, sizeof(header));
+
+    vector<unsigned char> bgra((size_t)width * height * 4);
+    for (size_t i = 0; i < (size_t)width * height; ++i) {
+        bgra[i * 4 + 0] = rgba[i * 4 + 2];
+        bgra[i * 4 + 1] = rgba[i * 4 + 1];
+        bgra[i * 4 + 2] = rgba[i * 4 + 0];
+        bgra[i * 4 + 3] = rgba[i * 4 + 3];
+    }
+    file.write((const char*)bgra.data(), bgra.size());
+    return true;
+}
+
+bool cookTiles(const char* imagePath, const char* directory, int tileSize)
+{
+    int width, height, channels;
+    unsigned char* pixels = stbi_load(imagePath, &width, &height, &channels, 4);
+    if (pixels == NULL) {
+        cout << "Textura nije ucitana! Putanja texture: " << imagePath << endl;
+        return false;
+    }
+
+    // Virtuelna tekstura je kvadrat sa 2^n plocica po strani, slika se bilinearno skalira na tu velicinu
+    int pages = 1;
+    while (pages * tileSize < (width > height ? width : height)) {
+        pages *= 2;
+    }
+    int levelCount = (int)round(log2((double)pages)) + 1;
+    int size = pages * tileSize;
+
+    vector<unsigned char> level((size_t)size * size * 4);
+    for (int y = 0; y < size; ++y) {
+        float sy = ((y + 0.5f) * height) / size - 0.5f;
+        int y0 = sy < 0 ? 0 : (int)sy, y1 = y0 + 1 < height ? y0 + 1 : height - 1;
+        float fy = sy < 0 ? 0.0f : sy - y0;
+        for (int x = 0; x < size; ++x) {
+            float sx = ((x + 0.5f) * width) / size - 0.5f;
+            int x0 = sx < 0 ? 0 : (int)sx, x1 = x0 + 1 < width ? x0 + 1 : width - 1;
+            float fx = sx < 0 ? 0.0f : sx - x0;
+            for (int c = 0; c < 4; ++c) {
+                float top = pixels[((size_t)y0 * width + x0) * 4 + c] * (1 - fx) + pixels[((size_t)y0 * width + x1) * 4 + c] * fx;
+                float bottom = pixels[((size_t)y1 * width + x0) * 4 + c] * (1 - fx) + pixels[((size_t)y1 * width + x1) * 4 + c] * fx;
+                level[((size_t)y * size + x) * 4 + c] = (unsigned char)(top * (1 - fy) + bottom * fy + 0.5f);
+            }
+        }
+    }
+    stbi_image_free(pixels);
+
+#ifdef _WIN32
+    _mkdir(directory);
+#else
+    mkdir(directory, 0755);
+#endif
+
+    vector<unsigned char> tile((size_t)tileSize * tileSize * 4);
+    vector<unsigned char> nextLevel;
+    int levelSize = size;
+    for (int l = 0; l < levelCount; ++l) {
+        int levelPages = levelSize / tileSize;
+        for (int ty = 0; ty < levelPages; ++ty) {
+            for (int tx = 0; tx < levelPages; ++tx) {
+                for (int row = 0; row < tileSize; ++row) {
+                    memcpy(&tile[(size_t)row * tileSize * 4], &level[(((size_t)ty * tileSize + row) * levelSize + (size_t)tx * tileSize) * 4], (size_t)tileSize * 4);
+                }
+                if (!writeTGA(getTilePath(directory, l, tx, ty), tile.data(), tileSize, tileSize)) {
+                    cout << "Greska pri upisu plocice u \"" << directory << "\"!" << endl;
+                    return false;
+                }
+            }
+        }
+
+        int nextWidth, nextHeight;
+        downsampleImage(level.data(), levelSize, levelSize, nextLevel, nextWidth, nextHeight);
+        level.swap(nextLevel);
+        levelSize = nextWidth;
+    }
+
+    ofstream descriptor(string(directory) + "/tiles.txt");
+    descriptor << tileSize << " " << levelCount << endl;
+
+    cout << "Plocice: " << imagePath << " -> " << directory << " (" << pages << "x" << pages << " plocica, "
+         << levelCount << " nivoa)" << endl;
+    return true;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class AssetLoader;
+
+// Virtuelna tekstura mape podeljena na plocice (tile) u vise rezolucija.
+// Nivo 0 je najdetaljniji, poslednji nivo je jedna plocica za celu mapu i uvek je ucitan.
+// Plocice se ucitavaju na zahtev oko kamere u kes (GL_TEXTURE_2D_ARRAY, jedan sloj = jedna plocica),
+// a kada se kes napuni izbacuje se najduze nekoriscena (LRU). Tabela indirekcije (jedan teksel po plocici,
+// po nivou) govori shaderu u kom sloju je plocica, ili njen najblizi ucitani predak.
+//
+// Plocice pravi cooker: PVO.exe --cook-tiles <slika> <direktorijum> [velicina plocice]
+// Format na disku: <direktorijum>/tiles.txt ("velicinaPlocice brojNivoa") i <direktorijum>/L<nivo>_<x>_<y>.tga
+class TileMap
+{
+public:
+    TileMap(AssetLoader& loader, int cacheLayers = 64);
+
+    TileMap(const TileMap&) = delete;
+    TileMap& operator=(const TileMap&) = delete;
+
+    // Vraca false ako plocice ne postoje - tada se koristi obicna tekstura mape
+    bool open(const char* directory);
+    bool isOpen() const { return opened; }
+
+    // Render nit, jednom po frejmu. Kamera je data u UV prostoru mape (0..1), visina u istim jedinicama.
+    void update(const glm::vec2& cameraUV, float cameraHeight);
+
+    // Vezuje kes i tabelu na zadate jedinice i postavlja uniforme programa (program mora biti aktivan)
+    void bind(unsigned int program, int cacheUnit, int tableUnit) const;
+
+    void release();
+
+    int residentTiles() const { return residentCount; }
+
+private:
+    struct Tile {
+        int layer;          // -1 dok se ucitava
+        uint64_t lastUsed;  // broj frejma poslednjeg koriscenja (za LRU)
+        bool pinned;
+    };
+
+    static uint32_t tileKey(int level, int x, int y) { return ((uint32_t)level << 24) | ((uint32_t)y << 12) | (uint32_t)x; }
+    int pagesAt(int level) const { return 1 << (levelCount - 1 - level); }
+
+    void requestTile(int level, int x, int y, bool pinned);
+    void uploadTile(uint32_t key, unsigned char* pixels);
+    int allocateLayer();
+    void rebuildTable();
+
+    AssetLoader& loader;
+    std::string directory;
+    bool opened;
+    int tileSize;
+    int levelCount;
+    int cacheLayers;
+    int inFlight;
+    int residentCount;
+    uint64_t frame;
+    bool tableDirty;
+
+    GLuint cacheTexture;
+    GLuint tableTexture;
+
+    std::unordered_map<uint32_t, Tile> tiles;
+    std::vector<uint32_t> layerOwners;      // kljuc plocice u svakom sloju kesa
+    std::vector<std::vector<uint16_t>> table;   // po nivou: (sloj, nivo) za svaku plocicu
+};
+
+// Cooker: slika -> piramida plocica za TileMap
+bool cookTiles(const char* imagePath, const char* directory, int tileSize);
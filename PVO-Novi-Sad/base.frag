@@ -4,7 +4,15 @@ struct Material {
     vec3 kA;
     vec3 kD;
     vec3 kS;
+    vec3 kE;
     float shine;
+    float opacity;
+    float textureLayer;    // sloj u TextureAtlas-u, -1 bez teksture
+    vec4 textureRect;      // (u0, v0, sirina, visina) slike u sloju
+    float textureScale;    // 0: UV mreze, > 0: triplanarno u prostoru sveta
+    float detailScale;
+    float detailStrength;
+    float detailDistance;
 };
 
 struct Light {
@@ -19,33 +27,136 @@ struct Light {
 
 in vec3 chFragPos;
 in vec3 chNor;
+in vec2 chTex;
+flat in vec4 chDrawColor;    // boja (rgb) i uAlpha (a) crtanja
 
-out vec4 outCol;
-
-uniform vec3 color;
-uniform float uAlpha;
-uniform sampler2D uTex;
+layout(location = 0) out vec4 outCol;
+layout(location = 1) out vec4 outReveal;
 
 uniform Light uReflector;
 
-uniform Material uMaterial;
+flat in int chMaterial;       // indeks materijala crtanja
+
+// Tabela materijala (MaterialTable u Renderer-u): 6 texela po materijalu - kA + shine, kD + d, kS + sloj, kE, pravougaonik, povrsina
+uniform samplerBuffer uMaterials;
+
+Material fetchMaterial(int id)
+{
+    int base = id * 6;
+    vec4 ambientShine = texelFetch(uMaterials, base);
+    vec4 diffuseOpacity = texelFetch(uMaterials, base + 1);
+    Material material;
+    material.kA = ambientShine.rgb;
+    material.shine = ambientShine.a;
+    material.kD = diffuseOpacity.rgb;
+    material.opacity = diffuseOpacity.a;
+    vec4 specularLayer = texelFetch(uMaterials, base + 2);
+    material.kS = specularLayer.rgb;
+    material.textureLayer = specularLayer.a;
+    material.kE = texelFetch(uMaterials, base + 3).rgb;
+    material.textureRect = texelFetch(uMaterials, base + 4);
+    vec4 surface = texelFetch(uMaterials, base + 5);
+    material.textureScale = surface.x;
+    material.detailScale = surface.y;
+    material.detailStrength = surface.z;
+    material.detailDistance = surface.w;
+    return material;
+}
+
 uniform vec3 uViewPos;
+uniform bool uOit;
+
+// Atlas tekstura scene (TextureAtlas) na jedinici 0; koriste ga samo materijali sa slojem (npr. planina)
+uniform sampler2DArray uAtlas;
+
+// Detalj se posle ovoliko nivoa pomaka potpuno gasi (atlas ima 5 nivoa)
+const float MAX_DETAIL_BIAS = 4.0;
+
+// Slika materijala sa ponavljanjem unutar pravougaonika; izvodi su u prostoru uv, pa fract() ne menja mipmapu
+vec4 sampleAtlas(Material material, vec2 uv, vec2 gradX, vec2 gradY)
+{
+    vec2 atlasUV = material.textureRect.xy + fract(uv) * material.textureRect.zw;
+    return textureGrad(uAtlas, vec3(atlasUV, material.textureLayer), gradX * material.textureRect.zw, gradY * material.textureRect.zw);
+}
+
+float luminance(vec3 color)
+{
+    return dot(color, vec3(0.299, 0.587, 0.114));
+}
+
+// Boja povrsine u istom prolazu: UV koordinate mreze ili triplanarno (tri projekcije u prostoru sveta sa
+// tezinama po normali). Detalj je ista slika detailScale puta gusca koja menja samo kontrast (deli se
+// srednjom vrednoscu okoline, 4 nivoa grublje); sa udaljenoscu mu mipmapa dobija pomak i detalj se gasi.
+vec3 surfaceColor(Material material, vec3 normal)
+{
+    if (material.textureLayer < 0.0) {
+        return vec3(1.0);
+    }
+
+    // Eksplicitni izvodi (textureGrad) rade i u grananju
+    vec3 position = chFragPos * material.textureScale;
+    vec3 positionX = dFdx(position);
+    vec3 positionY = dFdy(position);
+    vec2 uv = chTex;
+    vec2 gradX = dFdx(chTex);
+    vec2 gradY = dFdy(chTex);
+    vec3 color;
+    if (material.textureScale > 0.0) {
+        vec3 weights = pow(abs(normal), vec3(4.0));
+        weights /= weights.x + weights.y + weights.z;
+        color = weights.x * sampleAtlas(material, position.zy, positionX.zy, positionY.zy).rgb
+              + weights.y * sampleAtlas(material, position.xz, positionX.xz, positionY.xz).rgb
+              + weights.z * sampleAtlas(material, position.xy, positionX.xy, positionY.xy).rgb;
+
+        // Detalj samo iz preovladjujuce projekcije
+        if (weights.x >= weights.y && weights.x >= weights.z) {
+            uv = position.zy; gradX = positionX.zy; gradY = positionY.zy;
+        }
+        else if (weights.y >= weights.z) {
+            uv = position.xz; gradX = positionX.xz; gradY = positionY.xz;
+        }
+        else {
+            uv = position.xy; gradX = positionX.xy; gradY = positionY.xy;
+        }
+    }
+    else {
+        color = sampleAtlas(material, uv, gradX, gradY).rgb;
+    }
+
+    if (material.detailScale > 0.0) {
+        float bias = min(length(uViewPos - chFragPos) / max(material.detailDistance, 0.001), MAX_DETAIL_BIAS);
+        float gradScale = material.detailScale * exp2(bias);
+        vec2 detailUV = uv * material.detailScale;
+        float detail = luminance(sampleAtlas(material, detailUV, gradX * gradScale, gradY * gradScale).rgb);
+        float mean = luminance(sampleAtlas(material, detailUV, gradX * gradScale * 16.0, gradY * gradScale * 16.0).rgb);
+        float strength = material.detailStrength * (1.0 - bias / MAX_DETAIL_BIAS);
+        color *= mix(1.0, detail / max(mean, 0.05), strength);
+    }
+    return color;
+}
+
+// Tezina za weighted blended OIT: blizi i neprovidniji fragmenti imaju veci uticaj
+float oitWeight(float alpha, float distance)
+{
+    return alpha * clamp(10.0 / (0.00001 + pow(distance / 5.0, 2.0) + pow(distance / 200.0, 6.0)), 0.01, 3000.0);
+}
 
 void main()
 {
-    vec3 resA = vec3(0.1);
+    Material material = fetchMaterial(chMaterial);
+    vec3 resA = vec3(0.1) * material.kA;    // Ka 1.0 (Blender .mtl i podrazumevani materijal) daje raniji ambijent 0.1
 
     vec3 normal = normalize(chNor);
     
     vec3 lightDirection = normalize(vec3(0.0, 1.8, 0.0)); // Mesecina
     
     float nD = max(dot(normal, lightDirection), 0.0);
-    vec3 resD = vec3(0.5) * (nD * uMaterial.kD);
+    vec3 resD = vec3(0.5) * (nD * material.kD);
 
     vec3 viewDirection = normalize(uViewPos - chFragPos);
     vec3 reflectionDirection = reflect(-lightDirection, normal);
-    float s = pow(max(dot(viewDirection, reflectionDirection), 0.0), uMaterial.shine);
-    vec3 resS = vec3(0.2) * (s * uMaterial.kS);
+    float s = pow(max(dot(viewDirection, reflectionDirection), 0.0), material.shine);
+    vec3 resS = vec3(0.2) * (s * material.kS);
 
     vec3 finalColor = resD + resS;
 
@@ -54,11 +165,11 @@ void main()
         float spotCosine = dot(-lightDir, normalize(uReflector.dir));
         float spotFactor =  step(uReflector.cutoff, spotCosine);
         float nDReflector = max(dot(normal, lightDir), 0.0);
-        vec3 resDReflector = spotFactor * uReflector.kD * (nDReflector * uMaterial.kD);
+        vec3 resDReflector = spotFactor * uReflector.kD * (nDReflector * material.kD);
         vec3 viewDir = normalize(uViewPos - chFragPos);
         vec3 reflectDir = reflect(-lightDir, normal);
-        float specular = pow(max(dot(viewDir, reflectDir), 0.0), uMaterial.shine);
-        vec3 resSReflector = spotFactor * uReflector.kS * (specular * uMaterial.kS);
+        float specular = pow(max(dot(viewDir, reflectDir), 0.0), material.shine);
+        vec3 resSReflector = spotFactor * uReflector.kS * (specular * material.kS);
 
         vec3 finalColorReflector = resDReflector + resSReflector;
     //
@@ -66,5 +177,14 @@ void main()
 //        outCol = vec4(1.0f, 0.0f, 0.0f, 1.0f);
 //        return;
 //    }
-    outCol = vec4(color * (resA + finalColor + finalColorReflector), 1.0 - uAlpha);
+    vec3 albedo = surfaceColor(material, normal);
+    vec3 litColor = chDrawColor.rgb * albedo * (resA + finalColor + finalColorReflector) + material.kE;
+    float alpha = (1.0 - chDrawColor.a) * material.opacity;
+    if (uOit) {
+        float weight = oitWeight(alpha, length(uViewPos - chFragPos));
+        outCol = vec4(litColor * weight, 0.0);
+        outReveal = vec4(weight, 0.0, 0.0, alpha);
+        return;
+    }
+    outCol = vec4(litColor, alpha);
 }
@@ -1,22 +1,37 @@
 #version 330 core
 
 layout(location = 0) in vec3 inPos;
-layout(location = 1) in vec3 inNor;
-
-uniform vec3 uTranslation;
+layout(location = 1) in vec2 inTex;
+layout(location = 2) in vec3 inNor;        // raspored arene temena: pozicija, UV, normala
+layout(location = 7) in float inDrawId;    // baseInstance multi-draw poziva (inace 0)
 
 out vec3 chNor;
+out vec2 chTex;
 out vec3 chFragPos;
+flat out vec4 chDrawColor;
+flat out int chMaterial;
 
-uniform mat4 uM;
+// Podaci crtanja iz InstanceRing-a (Renderer): 6 texela po crtanju - model matrica, boja + uAlpha, pomeraj + materijal
+uniform samplerBuffer uDrawData;
+uniform int uDrawId;
 uniform mat4 uP;
 uniform mat4 uV;
 
+// Dubina mora da se poklopi sa depth.vert (dubinski pre-pass)
+invariant gl_Position;
+
 void main()
 {
 	
 	//chTex = vec2((inPos.x + 1.0) * 0.5, (inPos.z + 1.0) * 0.5);
-	chFragPos = vec3(uM * vec4(inPos + vec3(uTranslation.x, uTranslation.y, uTranslation.z), 1.0));
+	int drawBase = (uDrawId + int(inDrawId)) * 6;
+	mat4 uM = mat4(texelFetch(uDrawData, drawBase), texelFetch(uDrawData, drawBase + 1), texelFetch(uDrawData, drawBase + 2), texelFetch(uDrawData, drawBase + 3));
+	vec4 translationMaterial = texelFetch(uDrawData, drawBase + 5);
+	vec2 uTranslation = translationMaterial.xy;
+	chMaterial = int(translationMaterial.z);
+	chDrawColor = texelFetch(uDrawData, drawBase + 4);
+	chFragPos = vec3(uM * vec4(inPos + vec3(uTranslation.x, uTranslation.y, 0.0), 1.0));
 	chNor = mat3(transpose(inverse(uM))) * inNor;
+	chTex = inTex;
 	gl_Position = uP * uV * vec4(chFragPos,1.0); 
 }
\ No newline at end of file
@@ -0,0 +1,13 @@
+#version 330 core
+
+in vec2 chTex;
+
+out vec4 outCol;
+
+uniform sampler2D uClouds;
+
+void main()
+{
+    // Boja je vec pomnozena alfom (blend: GL_ONE, GL_ONE_MINUS_SRC_ALPHA)
+    outCol = texture(uClouds, chTex);
+}
\ No newline at end of file
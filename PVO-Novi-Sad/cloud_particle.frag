@@ -0,0 +1,51 @@
+#version 330 core
+
+in vec2 chCorner;
+in vec3 chShade;        // svetlina, neprovidnost, seme
+in float chViewDepth;
+
+out vec4 outCol;
+
+uniform sampler2D uSceneDepth;
+uniform vec2 uTargetSize;
+uniform float uNear;
+uniform float uFar;
+
+const float SOFTNESS = 0.05;    // rastojanje (u jedinicama sveta) na kome cestica nestaje pri preseku sa scenom
+
+float hash(vec2 p)
+{
+    return fract(sin(dot(p, vec2(127.1, 311.7))) * 43758.5453);
+}
+
+float noise(vec2 p)
+{
+    vec2 i = floor(p);
+    vec2 f = fract(p);
+    vec2 u = f * f * (3.0 - 2.0 * f);
+    return mix(mix(hash(i), hash(i + vec2(1.0, 0.0)), u.x), mix(hash(i + vec2(0.0, 1.0)), hash(i + vec2(1.0, 1.0)), u.x), u.y);
+}
+
+void main()
+{
+    float r = length(chCorner);
+    if (r > 1.0) {
+        discard;
+    }
+
+    // Mekana ivica i malo suma da cestice ne izgledaju kao krugovi
+    float density = (1.0 - smoothstep(0.3, 1.0, r)) * (0.7 + 0.3 * noise(chCorner * 3.0 + chShade.z));
+
+    // Meka cestica: nestaje kako se priblizava povrsini scene iza sebe
+    vec2 screenUV = gl_FragCoord.xy / uTargetSize;
+    float depth = texture(uSceneDepth, screenUV).r * 2.0 - 1.0;
+    float sceneDepth = 2.0 * uNear * uFar / (uFar + uNear - depth * (uFar - uNear));
+    density *= clamp((sceneDepth - chViewDepth) / SOFTNESS, 0.0, 1.0);
+
+    // Laznu normalu daje polozaj na disku - gornja strana je osvetljena mesecinom
+    float lit = 0.5 + 0.5 * chCorner.y;
+    vec3 color = vec3(0.7) * (0.12 + 0.3 * chShade.x * lit);
+
+    float alpha = density * chShade.y;
+    outCol = vec4(color * alpha, alpha);
+}
\ No newline at end of file
@@ -0,0 +1,23 @@
+#version 330 core
+
+layout(location = 0) in vec2 inCorner;     // -1..1
+layout(location = 1) in vec4 inCenterSize;
+layout(location = 2) in vec4 inShade;
+
+out vec2 chCorner;
+out vec3 chShade;
+out float chViewDepth;
+
+uniform mat4 uV;
+uniform mat4 uP;
+
+void main()
+{
+    // Pravougaonik se siri u prostoru kamere, pa je uvek okrenut ka njoj
+    vec4 viewCenter = uV * vec4(inCenterSize.xyz, 1.0);
+    vec4 viewPos = viewCenter + vec4(inCorner * inCenterSize.w, 0.0, 0.0);
+    chCorner = inCorner;
+    chShade = inShade.xyz;
+    chViewDepth = -viewPos.z;
+    gl_Position = uP * viewPos;
+}
\ No newline at end of file
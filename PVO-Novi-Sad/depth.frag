@@ -0,0 +1,6 @@
+#version 330 core
+
+void main()
+{
+    // Samo dubina (boja je iskljucena sa glColorMask)
+}
\ No newline at end of file
@@ -0,0 +1,22 @@
+#version 330 core
+
+layout(location = 0) in vec3 inPos;
+layout(location = 7) in float inDrawId;    // baseInstance multi-draw poziva (inace 0)
+
+// Podaci crtanja iz InstanceRing-a (Renderer): 6 texela po crtanju - model matrica, boja + uAlpha, pomeraj
+uniform samplerBuffer uDrawData;
+uniform int uDrawId;
+uniform mat4 uP;
+uniform mat4 uV;
+
+// Isti izraz kao u base.vert i texture.vert, da bi dubina u glavnom prolazu bila bit-identicna
+invariant gl_Position;
+
+void main()
+{
+	int drawBase = (uDrawId + int(inDrawId)) * 6;
+	mat4 uM = mat4(texelFetch(uDrawData, drawBase), texelFetch(uDrawData, drawBase + 1), texelFetch(uDrawData, drawBase + 2), texelFetch(uDrawData, drawBase + 3));
+	vec2 uTranslation = texelFetch(uDrawData, drawBase + 5).xy;
+	vec3 fragPos = vec3(uM * vec4(inPos + vec3(uTranslation.x, uTranslation.y, 0.0), 1.0));
+	gl_Position = uP * uV * vec4(fragPos, 1.0);
+}
\ No newline at end of file
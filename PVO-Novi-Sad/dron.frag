@@ -2,9 +2,9 @@
 
 in vec3 chCol;
 out vec4 outCol;
-uniform vec3 color;
+flat in vec4 chDrawColor;    // boja crtanja (dron.vert)
 
 void main()
 {
-    outCol = vec4(chCol.rgb + color, 1.0);
+    outCol = vec4(chCol.rgb + chDrawColor.rgb, 1.0);
 }
\ No newline at end of file
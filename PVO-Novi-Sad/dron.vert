@@ -1,13 +1,21 @@
 #version 330 core
 
 layout (location = 0) in vec3 aPosition;
+layout (location = 7) in float inDrawId;    // baseInstance multi-draw poziva (inace 0)
 
-uniform vec2 uTranslation;
-uniform mat4 uM;
+// Podaci crtanja iz InstanceRing-a (Renderer): 6 texela po crtanju - model matrica, boja + uAlpha, pomeraj
+uniform samplerBuffer uDrawData;
+uniform int uDrawId;
 uniform mat4 uP;
 uniform mat4 uV;
 
+flat out vec4 chDrawColor;
+
 void main()
 {
+    int drawBase = (uDrawId + int(inDrawId)) * 6;
+    mat4 uM = mat4(texelFetch(uDrawData, drawBase), texelFetch(uDrawData, drawBase + 1), texelFetch(uDrawData, drawBase + 2), texelFetch(uDrawData, drawBase + 3));
+    vec2 uTranslation = texelFetch(uDrawData, drawBase + 5).xy;
+    chDrawColor = texelFetch(uDrawData, drawBase + 4);
     gl_Position = uP * uV * uM * vec4(aPosition.x + uTranslation.x, aPosition.y + 0.2, aPosition.z + uTranslation.y, 1.0); // Stavila sam da se na y doda 0.2 zbog niskoletnih meta
 }
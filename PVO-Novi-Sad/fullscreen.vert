@@ -0,0 +1,11 @@
+#version 330 core
+
+out vec2 chTex;
+
+void main()
+{
+    // Jedan trougao preko celog ekrana, bez bafera temena
+    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    chTex = position;
+    gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#version 330 core
+
+// Odsecanje i izbor LOD-a jedne instance (GpuCuller, transform feedback putanja za GL 3.3).
+// Isti test kao u gpu_cull.comp; gpu_cull.geom propusta samo instance liste uList.
+layout(location = 0) in vec4 inInstance;    // pomeraj u svetu (xyz) i razmera (w)
+
+flat out int vList;     // -1 = odsecena, uLodCount = impostor
+out vec4 vOutput;       // instanca za listu (impostor dobija centar i poluprecnik u svetu)
+
+uniform vec4 uPlanes[6];
+uniform vec4 uBounds;           // centar (xyz) i poluprecnik (w) granica modela
+uniform vec3 uViewPos;
+uniform float uProjectionScale;
+uniform int uLodCount;
+uniform int uThresholdCount;
+uniform float uLodRadius[4];    // granice nivoa u pikselima (MeshLod.cpp)
+uniform float uImpostorRadius;  // 0 = impostor jos nije spreman
+
+void main()
+{
+    gl_Position = vec4(0.0);
+    vList = -1;
+    vOutput = inInstance;
+
+    vec3 center = uBounds.xyz * inInstance.w + inInstance.xyz;
+    float radius = uBounds.w * inInstance.w;
+    for (int i = 0; i < 6; ++i) {
+        if (dot(uPlanes[i].xyz, center) + uPlanes[i].w < -radius) {
+            return;
+        }
+    }
+
+    float screenRadius = radius * uProjectionScale / max(length(center - uViewPos), 0.0001);
+    if (screenRadius < uImpostorRadius) {
+        vList = uLodCount;
+        vOutput = vec4(center, radius);
+        return;
+    }
+    int lod = 0;
+    while (lod < uThresholdCount && lod < uLodCount - 1 && screenRadius < uLodRadius[lod]) {
+        lod++;
+    }
+    vList = lod;
+}
@@ -0,0 +1,94 @@
+#version 330 core
+
+struct Material {
+    vec3 kA;
+    vec3 kD;
+    vec3 kS;
+    vec3 kE;
+    float shine;
+    float opacity;
+    float textureLayer;    // sloj u TextureAtlas-u, -1 bez teksture
+    vec4 textureRect;      // (u0, v0, sirina, visina) slike u sloju
+    float textureScale;    // 0: UV mreze, > 0: triplanarno u prostoru sveta
+    float detailScale;
+    float detailStrength;
+    float detailDistance;
+};
+
+in vec2 chTex;
+in vec3 chFragPos;
+
+layout(location = 0) out vec4 outCol;
+layout(location = 1) out vec4 outReveal;
+
+uniform sampler2D uAtlas;
+uniform vec3 color;
+uniform float uAlpha;
+
+uniform int uMaterialId;
+
+// Tabela materijala (MaterialTable u Renderer-u): 6 texela po materijalu - kA + shine, kD + d, kS + sloj, kE, pravougaonik, povrsina
+uniform samplerBuffer uMaterials;
+
+Material fetchMaterial(int id)
+{
+    int base = id * 6;
+    vec4 ambientShine = texelFetch(uMaterials, base);
+    vec4 diffuseOpacity = texelFetch(uMaterials, base + 1);
+    Material material;
+    material.kA = ambientShine.rgb;
+    material.shine = ambientShine.a;
+    material.kD = diffuseOpacity.rgb;
+    material.opacity = diffuseOpacity.a;
+    vec4 specularLayer = texelFetch(uMaterials, base + 2);
+    material.kS = specularLayer.rgb;
+    material.textureLayer = specularLayer.a;
+    material.kE = texelFetch(uMaterials, base + 3).rgb;
+    material.textureRect = texelFetch(uMaterials, base + 4);
+    vec4 surface = texelFetch(uMaterials, base + 5);
+    material.textureScale = surface.x;
+    material.detailScale = surface.y;
+    material.detailStrength = surface.z;
+    material.detailDistance = surface.w;
+    return material;
+}
+
+uniform vec3 uViewPos;
+uniform bool uOit;
+
+// Ista tezina kao u base.frag
+float oitWeight(float alpha, float distance)
+{
+    return alpha * clamp(10.0 / (0.00001 + pow(distance / 5.0, 2.0) + pow(distance / 200.0, 6.0)), 0.01, 3000.0);
+}
+
+void main()
+{
+    Material material = fetchMaterial(uMaterialId);
+    vec4 texel = texture(uAtlas, chTex);
+    if (texel.a < 0.5) {
+        discard;
+    }
+
+    // Isto osvetljenje mesecine kao base.frag (reflektor je uzak snop i na daljini se izostavlja)
+    vec3 normal = normalize(texel.rgb * 2.0 - 1.0);
+    vec3 lightDirection = normalize(vec3(0.0, 1.8, 0.0));
+    float nD = max(dot(normal, lightDirection), 0.0);
+    vec3 resD = vec3(0.5) * (nD * material.kD);
+
+    vec3 viewDirection = normalize(uViewPos - chFragPos);
+    vec3 reflectionDirection = reflect(-lightDirection, normal);
+    float s = pow(max(dot(viewDirection, reflectionDirection), 0.0), material.shine);
+    vec3 resS = vec3(0.2) * (s * material.kS);
+    vec3 resA = vec3(0.1) * material.kA;
+
+    vec3 litColor = color * (resA + resD + resS) + material.kE;
+    float alpha = (1.0 - uAlpha) * material.opacity;
+    if (uOit) {
+        float weight = oitWeight(alpha, length(uViewPos - chFragPos));
+        outCol = vec4(litColor * weight, 0.0);
+        outReveal = vec4(weight, 0.0, 0.0, alpha);
+        return;
+    }
+    outCol = vec4(litColor, alpha);
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#version 330 core
+
+layout(location = 0) in vec2 inCorner;     // ugao pravougaonika, -1..1
+layout(location = 1) in vec4 inInstance;   // centar modela u svetu (xyz) i poluprecnik (w)
+
+out vec2 chTex;
+out vec3 chFragPos;
+
+uniform mat4 uV;
+uniform mat4 uP;
+uniform vec3 uViewPos;
+
+uniform int uYawCount;
+uniform int uPitchCount;
+uniform float uMinPitch;
+uniform float uMaxPitch;
+
+const float PI = 3.14159265;
+
+void main()
+{
+    vec3 center = inInstance.xyz;
+    float radius = inInstance.w;
+
+    // Celija atlasa snimljena iz pravca najblizeg pravcu kamere
+    vec3 toCamera = normalize(uViewPos - center);
+    float yaw = atan(toCamera.z, toCamera.x);
+    float pitch = asin(clamp(toCamera.y, -1.0, 1.0));
+    int yawCell = int(floor(yaw / (2.0 * PI) * float(uYawCount) + 0.5));
+    yawCell = (yawCell % uYawCount + uYawCount) % uYawCount;
+    float pitchStep = (uMaxPitch - uMinPitch) / float(uPitchCount - 1);
+    int pitchCell = clamp(int(floor((pitch - uMinPitch) / pitchStep + 0.5)), 0, uPitchCount - 1);
+
+    // Ista baza kao kamera pri snimanju (lookAt sa gornjim vektorom +Y)
+    vec3 forward = -toCamera;
+    vec3 right = normalize(cross(forward, vec3(0.0, 1.0, 0.0)));
+    vec3 up = cross(right, forward);
+
+    chFragPos = center + (right * inCorner.x + up * inCorner.y) * radius;
+    chTex = (vec2(yawCell, pitchCell) + inCorner * 0.5 + 0.5) / vec2(uYawCount, uPitchCount);
+    gl_Position = uP * uV * vec4(chFragPos, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,11 @@
+#version 330 core
+
+in vec3 chNor;
+
+out vec4 outCol;
+
+void main()
+{
+    // U atlas se upisuje normala (0..1) i pokrivenost u alfa kanalu - osvetljenje se racuna pri crtanju
+    outCol = vec4(normalize(chNor) * 0.5 + 0.5, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,14 @@
+#version 330 core
+
+layout(location = 0) in vec3 inPos;
+layout(location = 2) in vec3 inNor;
+
+out vec3 chNor;
+
+uniform mat4 uViewProjection;
+
+void main()
+{
+    chNor = inNor;
+    gl_Position = uViewProjection * vec4(inPos, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#version 330 core
+
+// Mreza modela za instance iz GpuCuller-a (zbijena lista jednog nivoa); isti raspored atributa kao base.vert
+layout(location = 0) in vec3 inPos;
+layout(location = 1) in vec2 inTex;
+layout(location = 2) in vec3 inNor;
+layout(location = 8) in vec4 inInstance;    // pomeraj u svetu (xyz) i razmera (w)
+
+out vec3 chNor;
+out vec2 chTex;
+out vec3 chFragPos;
+flat out vec4 chDrawColor;
+flat out int chMaterial;
+
+uniform mat4 uP;
+uniform mat4 uV;
+uniform vec3 color;
+uniform float uAlpha;
+uniform int uMaterialId;    // svi nivoi modela dele jedan materijal
+
+// Isti program sa depth.frag crta pre-pass, pa dubina mora biti bit-identicna
+invariant gl_Position;
+
+void main()
+{
+	chDrawColor = vec4(color, uAlpha);
+	chMaterial = uMaterialId;
+	chFragPos = inPos * inInstance.w + inInstance.xyz;
+	chNor = inNor;      // razmera je uniformna, a base.frag normalizuje
+	chTex = inTex;
+	gl_Position = uP * uV * vec4(chFragPos, 1.0);
+}
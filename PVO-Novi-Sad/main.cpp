@@ -1,5 +1,5 @@
-// Autor: Lara Petkovi RA 185/2020
-// Opis: Protiv-vazduna odbrana Novog Sada 
+// Autor: Lara Petković RA 185/2020
+// Opis: Protiv-vazdušna odbrana Novog Sada 
 
 #define _CRT_SECURE_NO_WARNINGS
 #define STB_IMAGE_IMPLEMENTATION
@@ -12,6 +12,7 @@
 #define CAMERA_X_LOC 0.0f   //0.0f
 #define CAMERA_Y_LOC 0.4f   //0.4f
 #define CAMERA_Z_LOC -0.65f  //-1.0f -0.65
+#define DRAW_DISTANCE 6.0f  // Objekti dalji od kamere se ne crtaju
 
 #include "stb_image.h"
 
@@ -28,9 +29,32 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <vector>
-#include <assimp/Importer.hpp>
-#include <assimp/scene.h>
-#include <assimp/postprocess.h>
+#include <memory>
+#include <algorithm>
+#include <cassert>
+
+#include "Arena.h"
+#include "AssetLoader.h"
+#include "CloudLayer.h"
+#include "DepthPrepass.h"
+#include "FrameGraph.h"
+#include "Frustum.h"
+#include "GpuCuller.h"
+#include "HeapCheck.h"
+#include "Impostor.h"
+#include "MeshLod.h"
+#include "MeshRegistry.h"
+#include "ModelLoader.h"
+#include "OcclusionCuller.h"
+#include "OitPass.h"
+#include "Profiler.h"
+#include "Renderer.h"
+#include "RenderThread.h"
+#include "SoftwareRenderer.h"
+#include "Terrain.h"
+#include "TextureAtlas.h"
+#include "TextureStreamer.h"
+#include "TileMap.h"
 
 // Za koptere
 #include <ctime>
@@ -40,17 +64,11 @@
 using namespace glm;
 using namespace std;
 
-struct ModelData {
-    vector<vec3> vertices;
-    vector<vec2> textureCoords;
-    vector<vec3> normals;
-};
 
 
 
 void setXZCircle(float  circle[96], float r, float xPomeraj, float zPomeraj);
 void setXYCircle(float  circle[96], float r, float xPomeraj, float zPomeraj);
-static unsigned loadImageToTexture(const char* filePath);
 void moveDrone(GLFWwindow* window, float& droneX, float& droneY, float droneSpeed, unsigned int wWidth, unsigned int wHeight);
 void generateLowHelicopterPositions(int number);
 void moveLowHelicoptersTowardsCityCenter(float cityCenterX, float cityCenterY, float speed);
@@ -59,16 +77,21 @@ void moveHelicoptersTowardsCityCenter(float cityCenterX, float cityCenterY, floa
 bool checkCollision(float object1X, float object1Y, float object1Radius, float object2X, float object2Y, float object2Radius);
 bool isDroneOutsideScreen(float droneX, float droneY);
 
-void renderClouds(unsigned int baseShader, unsigned int cloud1VAO, bool& hasTexture, int& colorLoc, unsigned int modelLocBase, ModelData& cloud1);
-void renderMountain(unsigned int baseShader, unsigned int mountainVAO, unsigned int mapTexture, glm::mat4& model, unsigned int modelLocBase, ModelData& mountain);
-void renderBase(unsigned int baseShader, unsigned int baseVAO, int& colorLoc, unsigned int modelLocBase, ModelData& base);
+bool isObjectVisible(const Frustum& frustum, const MeshAsset& modelData, const glm::mat4& model, CullingStats& stats);
+bool isObjectOccluded(const OcclusionCuller& occlusion, const MeshAsset& modelData, const glm::mat4& model, CullingStats& stats);
+int selectModelLod(const MeshAsset& modelData, const glm::mat4& model, int& currentLod, bool hasImpostor);
+void renderImpostors(unsigned int impostorShader, Impostor& impostor, const ArenaArray<vec4>& instances, int material, float alpha);
+void renderGpuCulled(unsigned int instancedShader, unsigned int impostorShader, GpuCuller& culler, Impostor& impostor, GLuint vertexBuffer, int material);
+void setOitOutput(unsigned int shader, bool enabled);
+
+void renderClouds(CommandBuffer& commands, ProgramHandle baseProgram, MeshHandle cloudMesh, const MeshAsset& cloud1, const Frustum& frustum, const OcclusionCuller& occlusion, CullingStats& culling, int cloudLods[2], Impostor& impostor);
+void renderMountain(CommandBuffer& commands, ProgramHandle baseProgram, MeshHandle mountainMesh, const glm::mat4& model, const MeshAsset& mountain, TextureHandle atlas, int material);
+void renderBase(CommandBuffer& commands, ProgramHandle baseProgram, MeshHandle baseMesh, const MeshAsset& base, const Frustum& frustum, CullingStats& culling);
 
 unsigned int compileShader(GLenum type, const char* source);
 unsigned int createShader(const char* vsSource, const char* fsSource);
-ModelData loadModel(const char* filePath);
-void processMesh(aiMesh* mesh, const aiScene* scene, ModelData& modelData);
-void processNode(aiNode* node, const aiScene* scene, ModelData& modelData);
-void setupModelVAO(unsigned int& VAO, unsigned int& VBO, const ModelData& modelData);
+bool runSoftwareRenderer(int frames, const char* outputPath);
+void drawSoftwareModel(SoftwareRenderer& renderer, const ModelData& model, const vector<vec3>& positions, const vector<vec3>& normals, const mat4& transform, const vec3& fallbackColor, float opacity, bool cullBackFaces);
 
 
 struct Location {
@@ -92,13 +115,60 @@ bool wasSpacePressed = false;
 bool coptersOnScreen = true;
 int numberOfCollied = 0;
 bool isMapHidden = false;
+bool useCloudLayer = true;     // false = stari oblaci od Cloud.obj mreze
 Location lowHelicopterPositions[LOW_HELICOPTER_NUM];
 Location3D helicopterPositions[HELICOPTER_NUM];
 auto startTime = chrono::high_resolution_clock::now();
+// Slike atlasa scene, istim redom za --cook i za igru (mapa, ime i prezime, planina)
+const vector<string> atlasImages = { "res/novi-sad.png", "res/name-surname.png", "res/mountain/mountain_texture.png" };
+const char* atlasDirectory = "res/atlas";
+float projectionScale = 1.0f;   // visina prozora / (2 * tan(fov / 2)) - velicina objekta na ekranu za LOD
 
 
-int main(void)
+int main(int argc, char** argv)
 {
+    // PVO.exe --cook -> atlas tekstura se slaze i kompresuje (BC3) u res/atlas i program izlazi
+    if (argc > 1 && string(argv[1]) == "--cook")
+    {
+        return TextureAtlas::cook(atlasImages, atlasDirectory) ? 0 : 4;
+    }
+
+    // PVO.exe --cook-tiles <slika> <direktorijum> [velicina plocice] -> piramida plocica za TileMap
+    if (argc > 3 && string(argv[1]) == "--cook-tiles")
+    {
+        long tileSize = 256;
+        if (argc > 4) {
+            char* end = NULL;
+            tileSize = strtol(argv[4], &end, 10);
+            // Nula, negativna ili nenumericka velicina bi zavrtela petlju nivoa u cookTiles
+            if (end == argv[4] || *end != '\0' || tileSize <= 0 || tileSize > 4096 || (tileSize & (tileSize - 1)) != 0) {
+                cout << "Upotreba: PVO.exe --cook-tiles <slika> <direktorijum> [velicina plocice: stepen dvojke, 1-4096]\n";
+                return 2;
+            }
+        }
+        return cookTiles(argv[2], argv[3], (int)tileSize) ? 0 : 4;
+    }
+
+    // PVO.exe --software [broj frejmova] [slika.ppm] -> scena se crta na CPU (bez prozora i GPU-a),
+    // ispisuje se vreme frejma i cuva snimak poslednjeg frejma
+    if (argc > 1 && string(argv[1]) == "--software")
+    {
+        int frames = argc > 2 ? atoi(argv[2]) : 60;
+        const char* outputPath = argc > 3 ? argv[3] : "screenshot.ppm";
+        return runSoftwareRenderer(frames, outputPath) ? 0 : 4;
+    }
+
+    // PVO.exe --benchmark-obj [model.obj] [broj ucitavanja] -> ObjParser naspram Assimp-a (vreme i temena)
+    if (argc > 1 && string(argv[1]) == "--benchmark-obj")
+    {
+        int runs = argc > 3 ? atoi(argv[3]) : 10;
+        benchmarkObjLoading(argc > 2 ? argv[2] : "res/clouds/Cloud.obj", runs);
+        return 0;
+    }
+
+    // PVO.exe --single-thread -> GL pozivi se izvrsavaju na glavnoj niti, bez posebne render niti
+    bool useRenderThread = !(argc > 1 && string(argv[1]) == "--single-thread");
+
     float reflectorRadius = 3.0f;
     float reflectorSpeed = 0.0001f;
     float reflectorAngle = 0.5f;
@@ -149,7 +219,33 @@ int main(void)
     unsigned int baseShader = createShader("base.vert", "base.frag");
     unsigned int dronShader = createShader("dron.vert", "dron.frag");
     unsigned int nameSurnameShader = createShader("name_surname.vert", "name_surname.frag");
-    int colorLoc = glGetUniformLocation(textureShader, "color");
+    unsigned int impostorShader = createShader("impostor.vert", "impostor.frag");
+    unsigned int impostorBakeShader = createShader("impostor_bake.vert", "impostor_bake.frag");
+    unsigned int cloudParticleShader = createShader("cloud_particle.vert", "cloud_particle.frag");
+    unsigned int cloudCompositeShader = createShader("fullscreen.vert", "cloud_composite.frag");
+    unsigned int oitCompositeShader = createShader("fullscreen.vert", "oit_composite.frag");
+    unsigned int depthShader = createShader("depth.vert", "depth.frag");
+    unsigned int overdrawShader = createShader("fullscreen.vert", "overdraw.frag");
+    unsigned int instancedShader = createShader("instanced.vert", "base.frag");
+    unsigned int instancedDepthShader = createShader("instanced.vert", "depth.frag");
+
+    // Renderer je jedino mesto sa GL pozivima za crtanje - igra snima komande nad ruckama u graf prolaza
+    Renderer renderer;
+    renderer.init();
+    ProgramHandle textureProgram = renderer.registerProgram(textureShader);
+    ProgramHandle baseProgram = renderer.registerProgram(baseShader);
+    ProgramHandle dronProgram = renderer.registerProgram(dronShader);
+    ProgramHandle nameSurnameProgram = renderer.registerProgram(nameSurnameShader);
+    ProgramHandle impostorProgram = renderer.registerProgram(impostorShader);
+    ProgramHandle depthProgram = renderer.registerProgram(depthShader);
+    ProgramHandle instancedProgram = renderer.registerProgram(instancedShader);
+    ProgramHandle instancedDepthProgram = renderer.registerProgram(instancedDepthShader);
+    // Programe ostalih modula Renderer samo brise na kraju
+    renderer.registerProgram(impostorBakeShader);
+    renderer.registerProgram(cloudParticleShader);
+    renderer.registerProgram(cloudCompositeShader);
+    renderer.registerProgram(oitCompositeShader);
+    renderer.registerProgram(overdrawShader);
 
     float vertices[] = {
    // X     Y      Z       S    T  
@@ -162,295 +258,257 @@ int main(void)
     };
 
     float nameSurnameVertices[] = {
-        // X     Y         S    T  
-         -1.0,  0.85,     0.0, 1.0,     
-         -0.4,  0.85,     1.0, 1.0,
-         -0.4,   1.0,     1.0, 0.0, 
-
-         -1.0,  0.85,     0.0, 1.0, 
-         -0.4,   1.0,     1.0, 0.0,
-         -1.0,   1.0,     0.0, 0.0
+        // X     Y         S    T     (T je okrenut jer se redovi slike vise ne okrecu pri ucitavanju)
+         -1.0,  0.85,     0.0, 0.0,     
+         -0.4,  0.85,     1.0, 0.0,
+         -0.4,   1.0,     1.0, 1.0, 
+
+         -1.0,  0.85,     0.0, 0.0, 
+         -0.4,   1.0,     1.0, 1.0,
+         -1.0,   1.0,     0.0, 1.0
     };
 
     // ********************************************** MODELI **********************************************
     // 
-    // Planina --------------------------------------------------------------
-    ModelData mountain = loadModel("res/mountain/Mountain.obj");
-    unsigned int mountainVAO, mountainVBO;
-    setupModelVAO(mountainVAO, mountainVBO, mountain);
-
-    // Dron -----------------------------------------------------------------
-    ModelData drone = loadModel("res/drone/Drone.obj");
-    unsigned int droneVAO, droneVBO;
-    setupModelVAO(droneVAO, droneVBO, drone);
-
-    // Oblak ----------------------------------------------------------------
-    ModelData cloud = loadModel("res/clouds/Cloud.obj");
-    unsigned int cloudVAO, cloudVBO;
-    setupModelVAO(cloudVAO, cloudVBO, cloud);
-
-    // Baza -----------------------------------------------------------------
-    ModelData base = loadModel("res/base/Base.obj");
-    unsigned int baseVAO, baseVBO;
-    setupModelVAO(baseVAO, baseVBO, base);
-
-
-    // Helikopter -----------------------------------------------------------
-    ModelData helicopter = loadModel("res/helicopter/Helicopter.obj");
-    unsigned int helicopterVAO, helicopterVBO;
-    setupModelVAO(helicopterVAO, helicopterVBO, helicopter);
+    // Modeli se ucitavaju asinhrono: parsiranje (ObjParser, Assimp samo za ono sto on odbije) ide na radnim
+    // nitima, a temena idu u arenu na render niti kroz assetLoader.processUploads(). Dok model ne stigne, isLoaded() je false i ne crta se;
+    // posle upload-a registar cuva samo broj temena, granice i nivoe detalja.
+    MeshHandle mountainMesh = renderer.createMesh();
+    MeshHandle droneMesh = renderer.createMesh();
+    MeshHandle cloudMesh = renderer.createMesh();
+    MeshHandle baseMesh = renderer.createMesh();
+    MeshHandle helicopterMesh = renderer.createMesh();
+    MeshRegistry meshRegistry;
+    // Boje vaze samo za modele bez .mtl materijala
+    MeshRegistry::Id cloudId = meshRegistry.add("oblak", cloudMesh, vec3(0.7f, 0.7f, 0.7f));
+    MeshRegistry::Id mountainId = meshRegistry.add("planina", mountainMesh, vec3(0.82f, 0.67f, 0.46f));
+    MeshRegistry::Id droneId = meshRegistry.add("dron", droneMesh, vec3(0.0f / 255.0f, 200.0f / 255.0f, 35.0f / 255.0f));
+    MeshRegistry::Id baseId = meshRegistry.add("baza", baseMesh, vec3(0.0f, 1.0f, 0.0f));
+    MeshRegistry::Id helicopterId = meshRegistry.add("helikopter", helicopterMesh, vec3(0.0f, 1.0f, 1.0f));
+    const MeshAsset& cloud = meshRegistry.asset(cloudId);
+    const MeshAsset& mountain = meshRegistry.asset(mountainId);
+    const MeshAsset& drone = meshRegistry.asset(droneId);
+    const MeshAsset& base = meshRegistry.asset(baseId);
+    const MeshAsset& helicopter = meshRegistry.asset(helicopterId);
+
+    AssetLoader assetLoader;
+
+    // Sve teksture scene su u jednom atlasu (slojevi 2D niza), a svaka ima svoj materijal sa slojem i
+    // pravougaonikom, pa mapa, ime i planina ne menjaju vezanu teksturu. Do ucitavanja vazi 1x1 placeholder,
+    // a slojevi napravljeni sa --cook stizu kroz PBO streamer.
+    TextureStreamer textureStreamer(assetLoader);
+    TextureAtlas textureAtlas(assetLoader, renderer, textureStreamer);
+    TextureHandle atlasHandle = renderer.registerTexture(textureAtlas.texture(), GL_TEXTURE_2D_ARRAY);
+    ModelMaterial mapSurface;
+    mapSurface.name = "mapa";
+    ModelMaterial nameSurnameSurface;
+    nameSurnameSurface.name = "ime i prezime";
+    // Planina: boja iz Mountain.mtl (Kd 0.8, bez odsjaja), tekstura triplanarno na svaku cetvrtinu jedinice
+    // sveta, a detalj je 8 puta gusci i gasi se do oko 4 jedinice od kamere
+    ModelMaterial mountainSurface;
+    mountainSurface.name = "planina";
+    mountainSurface.diffuse = vec3(0.8f);
+    mountainSurface.specular = vec3(0.0f);
+    mountainSurface.textureScale = 4.0f;
+    mountainSurface.detailScale = 8.0f;
+    mountainSurface.detailStrength = 0.5f;
+    mountainSurface.detailDistance = 1.0f;
+    int mapMaterial = renderer.addMaterials(&mapSurface, 1);
+    int nameSurnameMaterial = renderer.addMaterials(&nameSurnameSurface, 1);
+    int mountainSurfaceMaterial = renderer.addMaterials(&mountainSurface, 1);
+    textureAtlas.add(atlasImages[0].c_str(), mapMaterial);
+    textureAtlas.add(atlasImages[1].c_str(), nameSurnameMaterial);
+    textureAtlas.add(atlasImages[2].c_str(), mountainSurfaceMaterial);
+
+    // Oblak je najtezi model -> prvi ide u red
+    meshRegistry.loadAsync(cloudId, assetLoader, renderer, "res/clouds/Cloud.obj", true);
+    meshRegistry.loadAsync(mountainId, assetLoader, renderer, "res/mountain/Mountain.obj");
+    meshRegistry.loadAsync(droneId, assetLoader, renderer, "res/drone/Drone.obj", true);
+    meshRegistry.loadAsync(baseId, assetLoader, renderer, "res/base/Base.obj");
+    meshRegistry.loadAsync(helicopterId, assetLoader, renderer, "res/helicopter/Helicopter.obj", true);
+    textureAtlas.build(atlasDirectory);
+
+    // Mapa iz plocica (ako je napravljena sa --cook-tiles), inace se koristi slika mape iz atlasa
+    TileMap tileMap(assetLoader);
+    tileMap.open("res/tiles");
+
+    // Teren iz mape visina (ako postoji) zamenjuje ravan mape i Mountain.obj
+    Terrain terrain;
+    terrain.loadAsync(assetLoader, "res/terrain/heightmap.png", 2.0f, 0.3f, -0.01f);
+    MeshHandle terrainMesh = renderer.registerMesh(terrain.vertexArray());
 
     // *****************************************************************************************************
 
-    glUseProgram(0);
-
-
-    unsigned int stride = (3 + 2 + 3) * sizeof(float);
-    unsigned int nameSurnameStride = (2 + 2) * sizeof(float);
 
     // Tekstura imena i prezimena ------------------------------------------------------------
-    unsigned nameSurnameTexture = loadImageToTexture("res/name-surname.png");
-
-    unsigned int nameSurnameVAO;
-    unsigned int nameSurnameVBO;
-
-    glGenVertexArrays(1, &nameSurnameVAO);
-    glGenBuffers(1, &nameSurnameVBO);
-
-    glBindVertexArray(nameSurnameVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, nameSurnameVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(nameSurnameVertices), nameSurnameVertices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, nameSurnameStride, (void*)0);
-    glEnableVertexAttribArray(0);
-
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, nameSurnameStride, (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-
-    glBindTexture(GL_TEXTURE_2D, nameSurnameTexture);
-    glGenerateMipmap(GL_TEXTURE_2D);
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    // VAO i VBO teksture -------------------------------------------------------------   
-    unsigned int VAO[2];
-    glGenVertexArrays(2, VAO);
-    unsigned int VBO[2];
-    glGenBuffers(2, VBO);
-
-    glGenVertexArrays(1, &VAO[0]);
-    glBindVertexArray(VAO[0]);
-    glGenBuffers(1, &VBO[0]);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, (void*)(5 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-
-    // Renderovanje teksture -----------------------------------------------------------
-    unsigned mapTexture = loadImageToTexture("res/novi-sad.png");
-
-    glBindTexture(GL_TEXTURE_2D, mapTexture);
-    glGenerateMipmap(GL_TEXTURE_2D);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glBindTexture(GL_TEXTURE_2D, 0);
-    unsigned uTexLoc = glGetUniformLocation(textureShader, "uTex");
-    glUniform1i(uTexLoc, 0);
+    const VertexAttribute nameSurnameLayout[] = {
+        { 0, 2, 4 * sizeof(float), 0 },
+        { 1, 2, 4 * sizeof(float), 2 * sizeof(float) }
+    };
+    MeshHandle nameSurnameMesh = renderer.createMesh(nameSurnameVertices, sizeof(nameSurnameVertices), nameSurnameLayout, 2, 6);
+
+    // Mapa: pozicija, koordinate teksture, normala --------------------------------------
+    const VertexAttribute mapLayout[] = {
+        { 0, 3, 8 * sizeof(float), 0 },
+        { 1, 2, 8 * sizeof(float), 3 * sizeof(float) },
+        { 2, 3, 8 * sizeof(float), 5 * sizeof(float) }
+    };
+    MeshHandle mapMesh = renderer.createMesh(vertices, sizeof(vertices), mapLayout, 3, 5);
 
+    // Krugovi (centar grada, dron, LED, preostali dronovi) imaju samo poziciju
+    const VertexAttribute circleLayout[] = { { 0, 3, 3 * sizeof(float), 0 } };
+    const int circleVertexCount = CRES + 2;
 
     // Opis centra Novog Sada ----------------------------------------------------------
     float cityCenterCircle[CRES * 3 + 6];
     setXZCircle(cityCenterCircle, 0.017, 0.42, 0.08);
+    MeshHandle cityCenterMesh = renderer.createMesh(cityCenterCircle, sizeof(cityCenterCircle), circleLayout, 1, circleVertexCount);
 
-    // VAO i VBO centra Novog Sada
-    glGenVertexArrays(1, &VAO[1]);
-    glGenBuffers(1, &VBO[1]);
-    glBindVertexArray(VAO[1]);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO[1]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cityCenterCircle), cityCenterCircle, GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-
-
-    // Opis drona ----------------------------------------------------------------------
+    // Opis drona (isti krug crtaju i niskoletne mete) -----------------------------------
     float blueCircle[CRES * 3 + 6];
     setXZCircle(blueCircle, 0.03, 0.0, 0.0);
-
-    // VAO i VBO drona
-    unsigned int VAOBlue, VBOBlue;
-    glGenVertexArrays(1, &VAOBlue);
-    glGenBuffers(1, &VBOBlue);
-    glBindVertexArray(VAOBlue);
-    glBindBuffer(GL_ARRAY_BUFFER, VBOBlue);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(blueCircle), blueCircle, GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    MeshHandle droneCircleMesh = renderer.createMesh(blueCircle, sizeof(blueCircle), circleLayout, 1, circleVertexCount);
 
     // LED sijalica pozadina -> indikator da li je letelica u vazduhu -------------------
     float LEDBackgroundCircle[CRES * 3 + 6];
     setXYCircle(LEDBackgroundCircle, 0.045, -0.70, 0.85);
-
-    // VAO i VBO LED-a
-    unsigned int VAOLEDBackground, VBOLEDBackground;
-    glGenVertexArrays(1, &VAOLEDBackground);
-    glGenBuffers(1, &VBOLEDBackground);
-    glBindVertexArray(VAOLEDBackground);
-    glBindBuffer(GL_ARRAY_BUFFER, VBOLEDBackground);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(LEDBackgroundCircle), LEDBackgroundCircle, GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    MeshHandle ledBackgroundMesh = renderer.createMesh(LEDBackgroundCircle, sizeof(LEDBackgroundCircle), circleLayout, 1, circleVertexCount);
 
     // LED sijalica -> indikator da li je letelica u vazduhu -----------------------------
     float LEDCircle[CRES * 3 + 6];
     setXYCircle(LEDCircle, 0.02, -0.70, 0.85);
-
-    // VAO i VBO LED-a
-    unsigned int VAOLED, VBOLED;
-    glGenVertexArrays(1, &VAOLED);
-    glGenBuffers(1, &VBOLED);
-    glBindVertexArray(VAOLED);
-    glBindBuffer(GL_ARRAY_BUFFER, VBOLED);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(LEDCircle), LEDCircle, GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    MeshHandle ledMesh = renderer.createMesh(LEDCircle, sizeof(LEDCircle), circleLayout, 1, circleVertexCount);
 
 
     int dronesLeft = DRONES_LEFT;
 
-    // VAO i VBO preostalih dronova -----------------------------------------------------
-    unsigned int VAOdronLeft[DRONES_LEFT];
-    unsigned int VBOdronLeft[DRONES_LEFT];
+    // Preostali dronovi -----------------------------------------------------------------
+    MeshHandle dronLeftMeshes[DRONES_LEFT];
     float dronLeftCircle[CRES * 3 + 6];
     for (int i = 0; i < dronesLeft; ++i) {
-
         setXYCircle(dronLeftCircle, 0.02, 0.7 + 0.04 * i, -0.8);
-
-        glGenVertexArrays(1, &VAOdronLeft[i]);
-        glGenBuffers(1, &VBOdronLeft[i]);
-        glBindVertexArray(VAOdronLeft[i]);
-        glBindBuffer(GL_ARRAY_BUFFER, VBOdronLeft[i]);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(dronLeftCircle), dronLeftCircle, GL_STATIC_DRAW);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
+        dronLeftMeshes[i] = renderer.createMesh(dronLeftCircle, sizeof(dronLeftCircle), circleLayout, 1, circleVertexCount);
     }
 
 
-    // VAO i VBO svetla ------------------------------------------------------------------
-    unsigned int lightVAO, lightVBO;
-    glGenVertexArrays(1, &lightVAO);
-    glGenBuffers(1, &lightVBO);
-    glBindVertexArray(lightVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, lightVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
-    glEnableVertexAttribArray(0);
-    glBindVertexArray(0);
-
-
     mat4 model = mat4(1.0f); //Matrica transformacija - mat4(1.0f) generise jedinicnu matricu
-    unsigned int modelLocTex = glGetUniformLocation(textureShader, "uM");
-    unsigned int modelLocDron = glGetUniformLocation(dronShader, "uM");
-    unsigned int modelLocBase = glGetUniformLocation(baseShader, "uM");
-
 
     mat4 view; //Matrica pogleda (kamere)
     view = lookAt(vec3(CAMERA_X_LOC, CAMERA_Y_LOC, CAMERA_Z_LOC), vec3(0.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f));
-    unsigned int viewLocTex = glGetUniformLocation(textureShader, "uV");
-    unsigned int viewLocDron = glGetUniformLocation(dronShader, "uV");
-    unsigned int viewLocBase = glGetUniformLocation(baseShader, "uV");
-
 
     mat4 projection = perspective(radians(90.0f), (float)wWidth / (float)wHeight, 0.1f, 100.0f); //Matrica perspektivne projekcije (FOV, Aspect Ratio, prednja ravan, zadnja ravan)
-    unsigned int projectionLocTex = glGetUniformLocation(textureShader, "uP");
-    unsigned int projectionLocDron = glGetUniformLocation(dronShader, "uP");
-    unsigned int projectionLocBase = glGetUniformLocation(baseShader, "uP");
-
-    unsigned int viewPosLoc = glGetUniformLocation(baseShader, "uViewPos");
-
-    unsigned int lightPosLoc = glGetUniformLocation(baseShader, "uReflector.pos");
-    unsigned int lightALoc = glGetUniformLocation(baseShader, "uReflector.kA");
-    unsigned int lightDLoc = glGetUniformLocation(baseShader, "uReflector.kD");
-    unsigned int lightSLoc = glGetUniformLocation(baseShader, "uReflector.kS");
-    unsigned int lightCutoffLoc = glGetUniformLocation(baseShader, "uReflector.cutoff");
-    unsigned int lightDirLoc = glGetUniformLocation(baseShader, "uReflector.dir");
-
-    unsigned int materialShineLoc = glGetUniformLocation(baseShader, "uMaterial.shine");
-    unsigned int materialALoc = glGetUniformLocation(baseShader, "uMaterial.kA");
-    unsigned int materialDLoc = glGetUniformLocation(baseShader, "uMaterial.kD");
-    unsigned int materialSLoc = glGetUniformLocation(baseShader, "uMaterial.kS");
-    
-    unsigned int viewPosLocTex = glGetUniformLocation(textureShader, "uViewPos");
-
-    unsigned int materialShineLocTex = glGetUniformLocation(textureShader, "uMaterial.shine");
-    unsigned int materialALocTex = glGetUniformLocation(textureShader, "uMaterial.kA");
-    unsigned int materialDLocTex = glGetUniformLocation(textureShader, "uMaterial.kD");
-    unsigned int materialSLocTex = glGetUniformLocation(textureShader, "uMaterial.kS");
-
-
-
-    glUseProgram(baseShader);
-
-    glUniformMatrix4fv(modelLocBase, 1, GL_FALSE, value_ptr(model));
-    glUniformMatrix4fv(viewLocBase, 1, GL_FALSE, value_ptr(view));
-    glUniformMatrix4fv(projectionLocBase, 1, GL_FALSE, value_ptr(projection));
-
-    glUniform3f(viewPosLoc, CAMERA_X_LOC, CAMERA_Y_LOC, CAMERA_Z_LOC); // Isto kao i pozicija kamere
-
-    // Bela svetlost
-    glUniform3f(lightPosLoc, -0.35, -3.0f, 0.028);
-    glUniform3f(lightALoc, 0.2, 0.2, 0.2);
-    glUniform3f(lightDLoc, 4.0, 4.0, 4.0);
-    glUniform3f(lightSLoc, 4.0, 4.0, 4.0);
-    glUniform1f(lightCutoffLoc, cos(radians(1.0f)));
-    glUniform3f(lightDirLoc, 0.0, 1.0, 0.0);
-
-    // Svojstva materijala
-    glUniform1f(materialShineLoc, 132.0);      // Uglancanost (manja vrednost za slabiji sjaj)
-    glUniform3f(materialALoc, 0.2, 0.2, 0.2);  // Ambijentalna refleksija materijala
-    glUniform3f(materialDLoc, 0.5, 0.5, 0.5);  // Difuzna refleksija materijala
-    glUniform3f(materialSLoc, 0.7, 0.7, 0.7);  // Spekularna refleksija materijala
-    
-    glUseProgram(textureShader);
-    glUniform3f(viewPosLocTex, CAMERA_X_LOC, CAMERA_Y_LOC, CAMERA_Z_LOC); // Isto kao i pozicija kamere
-
-    // Svojstva materijala teksture
-    glUniform1f(materialShineLocTex, 132.0);      // Uglancanost
-    glUniform3f(materialALocTex, 0.2, 0.2, 0.2);  // Ambijentalna refleksija materijala
-    glUniform3f(materialDLocTex, 0.5, 0.5, 0.5);  // Difuzna refleksija materijala
-    glUniform3f(materialSLocTex, 0.7, 0.7, 0.7);  // Spekularna refleksija materijala
-    glUseProgram(baseShader);
+    projectionScale = wHeight / (2.0f * tan(radians(90.0f) * 0.5f));
+
+    // Kamera se ne pomera, pa se pogled i projekcija postavljaju jednom; materijali su u tabeli Renderer-a
+    ProgramHandle litPrograms[] = { baseProgram, textureProgram, impostorProgram, instancedProgram };
+    for (ProgramHandle program : litPrograms) {
+        renderer.setUniform(program, "uV", view);
+        renderer.setUniform(program, "uP", projection);
+        renderer.setUniform(program, "uViewPos", vec3(CAMERA_X_LOC, CAMERA_Y_LOC, CAMERA_Z_LOC)); // Isto kao i pozicija kamere
+    }
+    renderer.setUniform(dronProgram, "uV", view);
+    renderer.setUniform(dronProgram, "uP", projection);
+    renderer.setUniform(instancedDepthProgram, "uV", view);
+    renderer.setUniform(instancedDepthProgram, "uP", projection);
+
+    // Bela svetlost (isti base.frag i za instance iz GpuCuller-a); atlas je na jedinici 0, kao za texture.frag
+    for (ProgramHandle program : { baseProgram, instancedProgram }) {
+        renderer.setUniform(program, "uReflector.pos", vec3(-0.35f, -3.0f, 0.028f));
+        renderer.setUniform(program, "uReflector.kA", vec3(0.2f));
+        renderer.setUniform(program, "uReflector.kD", vec3(4.0f));
+        renderer.setUniform(program, "uReflector.kS", vec3(4.0f));
+        renderer.setUniform(program, "uReflector.cutoff", cos(radians(1.0f)));
+        renderer.setUniform(program, "uReflector.dir", vec3(0.0f, 1.0f, 0.0f));
+        renderer.setUniform(program, "uAtlas", 0);
+    }
+
+    // Sampleri razlicitih tipova ne smeju deliti jedinicu teksture, cak i kad se virtuelna tekstura ne koristi
+    renderer.setUniform(textureProgram, "uAtlas", 0);
+    renderer.setUniform(textureProgram, "uTileCache", 1);
+    renderer.setUniform(textureProgram, "uTileTable", 2);
+    renderer.setUniform(nameSurnameProgram, "uAtlas", 0);
+    renderer.setUniform(nameSurnameProgram, "uMaterialId", nameSurnameMaterial);
 
     bool wasXpressed = false;
 
-    glEnable(GL_CULL_FACE);
-    glEnable(GL_DEPTH_TEST);
-    glCullFace(GL_BACK);
+    // Statistika frejma i odsecanja se prikazuje u naslovu prozora
+    Profiler profiler;
+
+    // Trenutni LOD svake instance (za histerezu pri izboru nivoa)
+    int cloudLods[2] = { 0, 0 };
+    int droneLod = 0;
+    int helicopterLods[HELICOPTER_NUM] = { 0 };
+
+    // Sloj oblaka od cestica (kvalitet se menja tasterima 4/5/6)
+    CloudLayer cloudLayer;
+    int framebufferWidth, framebufferHeight;
+    glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+    cloudLayer.init(cloudParticleShader, cloudCompositeShader, framebufferWidth, framebufferHeight, CloudLayer::QUALITY_MEDIUM);
+
+    // Providni objekti (baza, oblaci) se crtaju u jednom nesortiranom OIT prolazu
+    OitPass oitPass;
+    oitPass.init(oitCompositeShader, framebufferWidth, framebufferHeight);
+
+    // Opcioni dubinski pre-pass za neprovidne mreze (7/8) i prikaz preklapanja fragmenata (9/0)
+    DepthPrepass depthPrepass;
+    depthPrepass.init(depthShader, overdrawShader);
+
+    // Hi-Z odsecanje helikoptera i oblaka iza terena/planine
+    OcclusionCuller occlusionCuller;
+    occlusionCuller.init(depthShader);
+
+    // Daleki oblaci i helikopteri se crtaju kao impostori (atlas se snima kad model stigne)
+    Impostor cloudImpostor;
+    Impostor helicopterImpostor;
+
+    // Odsecanje i LOD helikoptera na GPU-u (G/H ukljucuje/iskljucuje; CPU putanja ostaje za poredjenje)
+    GpuCuller helicopterCuller;
+    if (GpuCuller::isComputeSupported()) {
+        helicopterCuller.init(0, 0, compileShader(GL_COMPUTE_SHADER, "gpu_cull.comp"), HELICOPTER_NUM);
+    }
+    else {
+        helicopterCuller.init(compileShader(GL_VERTEX_SHADER, "gpu_cull.vert"), compileShader(GL_GEOMETRY_SHADER, "gpu_cull.geom"), 0, HELICOPTER_NUM);
+    }
+    bool gpuCulling = true;
+
+    // Podesavanja koja menja igra, a primenjuju se na render niti (u sinhronom poslu frejma)
+    CloudLayer::Quality cloudQuality = CloudLayer::QUALITY_MEDIUM;
+    bool prepassEnabled = false;
+    bool overdrawView = false;
+
+    // Brojaci koje puni render nit (iz prethodnog frejma)
+    int shadedFragments = 0;
+    int cloudParticles = 0;
+    int drawCalls = 0;
+    int submittedDraws = 0;
+    int stateChanges = 0;
+    int gpuCulledVisible = -1;     // samo transform feedback putanja zna broj (compute ga ne cita nazad)
+    int uploadArenaKb = 0;
+
+    // Provera heap-a (PVO_HEAP_CHECK): frejmovi od poslednje promene stanja i dosadasnji maksimumi frejma
+    const int heapCheckWarmup = 120;
+    int steadyFrames = 0;
+    int lastSettings = -1;
+    int maxFrameDraws = 0;
+    int maxFrameInstances = 0;
+    size_t maxArenaUsed = 0;
+
+    // Render nit crta frejm N dok ova nit simulira i snima frejm N+1; od ovde GL pozive radi samo ona
+    RenderThread renderThread;
+    renderThread.init(window, renderer);
+    if (useRenderThread) {
+        renderThread.start();
+    }
 
     while (!glfwWindowShouldClose(window))
     {
-        glEnable(GL_DEPTH_TEST);
+        profiler.beginFrame();
+        size_t frameAllocationStart = HeapCheck::threadAllocations();
 
+        // Odsecanje objekata van pogleda (granice modela se racunaju u loadModel)
+        Frustum viewFrustum;
+        viewFrustum.extract(projection * view);
+        CullingStats objectCulling = { 0, 0, 0, 0 };
         if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         {
             glfwSetWindowShouldClose(window, GL_TRUE);
@@ -466,93 +524,76 @@ int main(void)
             isMapHidden = false;
         }
 
-        if ((glfwGetKey(window, GLFW_KEY_X) == GLFW_PRESS && !wasXpressed && dronesLeft > 0) || isDroneOutsideScreen(droneX, droneZ) || droneY < 0.0f) {
-            wasXpressed = true;
-            if (!isSpacePressed) {
-                wasSpacePressed = !wasSpacePressed;
-            }
-            isSpacePressed = true;
-            droneX = 0.0f;
-            droneY = 0.0f;
-            droneZ = -0.45f;
-            dronesLeft--;
-        }
-        else if (glfwGetKey(window, GLFW_KEY_X) == GLFW_RELEASE) {
-            wasXpressed = false;
+        if (glfwGetKey(window, GLFW_KEY_3) == GLFW_PRESS)
+        {
+            useCloudLayer = false;
         }
 
+        if (glfwGetKey(window, GLFW_KEY_4) == GLFW_PRESS)
+        {
+            useCloudLayer = true;
+            cloudQuality = CloudLayer::QUALITY_LOW;
+        }
 
-        glClearColor(0.1, 0.1, 0.10023082, 1.0);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-
-        model = mat4(1.0);
-        glUniformMatrix4fv(modelLocBase, 1, GL_FALSE, value_ptr(model));
-
-        glUseProgram(textureShader);
-        model[0] *= -1;
-        glUniformMatrix4fv(modelLocTex, 1, GL_FALSE, value_ptr(model)); // (Adresa matrice, broj matrica koje saljemo, da li treba da se transponuju, pokazivac do matrica)
-        glUniformMatrix4fv(viewLocTex, 1, GL_FALSE, value_ptr(view));
-        glUniformMatrix4fv(projectionLocTex, 1, GL_FALSE, value_ptr(projection));
-        glBindVertexArray(VAO[0]);
+        if (glfwGetKey(window, GLFW_KEY_5) == GLFW_PRESS)
+        {
+            useCloudLayer = true;
+            cloudQuality = CloudLayer::QUALITY_MEDIUM;
+        }
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, mapTexture);
+        if (glfwGetKey(window, GLFW_KEY_6) == GLFW_PRESS)
+        {
+            useCloudLayer = true;
+            cloudQuality = CloudLayer::QUALITY_HIGH;
+        }
 
-        if (!isMapHidden)
+        if (glfwGetKey(window, GLFW_KEY_7) == GLFW_PRESS)
         {
-            glDrawArrays(GL_TRIANGLE_STRIP, 0, 5);
+            prepassEnabled = true;
         }
-        glBindTexture(GL_TEXTURE_2D, 0);
 
-        // Renderovanje baze ------------------------------------------------------------------------------------
-        renderBase(baseShader, baseVAO, colorLoc, modelLocBase, base);
+        if (glfwGetKey(window, GLFW_KEY_8) == GLFW_PRESS)
+        {
+            prepassEnabled = false;
+        }
 
-        // Renderovanje preostalih dronova    0, 1, -1 ----------------------------------------------------------
-        glCullFace(GL_FRONT);
+        if (glfwGetKey(window, GLFW_KEY_9) == GLFW_PRESS)
+        {
+            overdrawView = true;
+        }
 
-        for (int i = 0; i < dronesLeft; ++i) {
-            glBindVertexArray(VAOdronLeft[i]);
-            mat4 model = mat4(1.0f);
-            model = translate(model, vec3(-0.95f, 0.96f, 0.4f));
-            model = rotate(model, 0.77f, vec3(1.0f, 0.0f, 0.0f));
-            model = scale(model, vec3(0.8f, 0.8f, 0.8f));
-            glUniformMatrix4fv(modelLocBase, 1, GL_FALSE, value_ptr(model));
-            glUniform3f(colorLoc, 0.0f, 1.0f, 0.0f);
-            glDrawArrays(GL_TRIANGLE_FAN, 0, sizeof(dronLeftCircle) / (3 * sizeof(float)));
+        if (glfwGetKey(window, GLFW_KEY_0) == GLFW_PRESS)
+        {
+            overdrawView = false;
         }
-        glCullFace(GL_BACK);
 
-        // Renderovanje pozadine LED sijalice -------------------------------------------------------------------
-        glUseProgram(baseShader);
-        glBindVertexArray(VAOLEDBackground);
+        if (glfwGetKey(window, GLFW_KEY_G) == GLFW_PRESS)
+        {
+            gpuCulling = true;
+        }
 
-        glUniformMatrix4fv(modelLocBase, 1, GL_FALSE, value_ptr(model)); // (Adresa matrice, broj matrica koje saljemo, da li treba da se transponuju, pokazivac do matrica)
-        glUniformMatrix4fv(viewLocBase, 1, GL_FALSE, value_ptr(view));
-        glUniformMatrix4fv(projectionLocBase, 1, GL_FALSE, value_ptr(projection));
-        
-        colorLoc = glGetUniformLocation(baseShader, "color");
-        glUniform3f(colorLoc, 0.3, 0.2, 0.2);
-        glDrawArrays(GL_TRIANGLE_FAN, 0, sizeof(LEDBackgroundCircle) / (3 * sizeof(float)));
+        if (glfwGetKey(window, GLFW_KEY_H) == GLFW_PRESS)
+        {
+            gpuCulling = false;
+        }
 
-        // Renderovanje LED sijalice -> upaljena ako postoji letelica u vazduhu
-        glBindVertexArray(VAOLED);
-        colorLoc = glGetUniformLocation(baseShader, "color");
-        if (coptersOnScreen) {
-            glUniform3f(colorLoc, 1.0, 0.0, 0.0); // Crvena boja LED sijalice kada ima helikoptera
+        if ((glfwGetKey(window, GLFW_KEY_X) == GLFW_PRESS && !wasXpressed && dronesLeft > 0) || isDroneOutsideScreen(droneX, droneZ) || droneY < 0.0f) {
+            wasXpressed = true;
+            if (!isSpacePressed) {
+                wasSpacePressed = !wasSpacePressed;
+            }
+            isSpacePressed = true;
+            droneX = 0.0f;
+            droneY = 0.0f;
+            droneZ = -0.45f;
+            dronesLeft--;
         }
-        else {
-            glUniform3f(colorLoc, 0.0, 1.0, 0.0); // Zelena boja LED sijalice kada nema helikoptera
+        else if (glfwGetKey(window, GLFW_KEY_X) == GLFW_RELEASE) {
+            wasXpressed = false;
         }
-        glDrawArrays(GL_TRIANGLE_FAN, 0, sizeof(LEDCircle) / (3 * sizeof(float)));
-
-
-        // Renderovanje centra Novog Sada ------------------------------------------------------------------------
-        glBindVertexArray(VAO[1]);
-        glUniform3f(colorLoc, 0.0, 0.0, 0.0);
-        glDrawArrays(GL_TRIANGLE_FAN, 0, sizeof(cityCenterCircle) / (3 * sizeof(float)));
 
 
+        // Kretanje drona (pre crtanja, da bi pre-pass i glavni prolaz videli isti polozaj)
         if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS) {
             if (!isSpacePressed) {
                 wasSpacePressed = !wasSpacePressed;
@@ -570,8 +611,6 @@ int main(void)
         {
             moveDrone(window, droneX, droneZ, droneSpeed, wWidth, wHeight);
 
-            // Renderovanje 2D drona
-            
             if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
             {
                 droneY += droneSpeed;
@@ -582,42 +621,248 @@ int main(void)
                 droneY -= droneSpeed;
                 droneCircleRadius -= droneSpeed;
             }
+        }
 
-            glUseProgram(baseShader);
-            mat4 modelKrug = translate(model, vec3(droneX, 0.1f, droneZ));
-            modelKrug = scale(modelKrug, vec3(droneCircleRadius));
-            glUniformMatrix4fv(modelLocBase, 1, GL_FALSE, value_ptr(modelKrug));
-            glBindVertexArray(VAOBlue);
-            colorLoc = glGetUniformLocation(baseShader, "color");
-            glUniform3f(colorLoc, 0.0, 0.0, 1.0);
-            glBufferData(GL_ARRAY_BUFFER, sizeof(blueCircle), blueCircle, GL_STATIC_DRAW); // Update the VBO with the new circle data
-            glDrawArrays(GL_TRIANGLE_FAN, 0, sizeof(blueCircle) / (3 * sizeof(float)));
 
-            // Renderovanje 3D drona
-            glBindVertexArray(droneVAO);
-            mat4 model3D = mat4(1.0f);
-            model3D = translate(model3D, vec3(-droneX, droneY, droneZ));
-            model3D = scale(model3D, vec3(0.15f));
-            glUniform3f(colorLoc, 0.0 / 255.0, 200.0 / 255.0, 35.0 / 255.0);
-            glUniformMatrix4fv(modelLocBase, 1, GL_FALSE, value_ptr(model3D));
-            glDrawArrays(GL_TRIANGLES, 0, drone.vertices.size());
-            glUniformMatrix4fv(modelLocBase, 1, GL_FALSE, value_ptr(glm::mat4(1.0f)));
-            glBindVertexArray(0);
+        // Mapa je ogledalno okrenuta po X osi
+        model = mat4(1.0);
+        model[0] *= -1;
+
+        // Odsecanje i LOD terena rade se u prostoru modela mape (X osa je okrenuta)
+        Frustum terrainFrustum;
+        terrainFrustum.extract(projection * view * model);
+        terrain.update(terrainFrustum, vec3(-CAMERA_X_LOC, CAMERA_Y_LOC, CAMERA_Z_LOC), projectionScale);
+
+        mat4 mountainModel = translate(scale(model, vec3(0.1)), vec3(0.0, 0.0, -12.8));
+
+        // Neprovidne mreze ovog frejma - vidljivost i LOD se biraju jednom, za pre-pass i za glavni prolaz
+        bool mountainVisible = !terrain.isLoaded() && mountain.isLoaded() && isObjectVisible(viewFrustum, mountain, mountainModel, objectCulling);
+
+        mat4 model3D = mat4(1.0f);
+        model3D = translate(model3D, vec3(-droneX, droneY, droneZ));
+        model3D = scale(model3D, vec3(0.15f));
+        int droneLodIndex = -1;
+        if (wasSpacePressed && dronesLeft > 0 && drone.isLoaded() && isObjectVisible(viewFrustum, drone, model3D, objectCulling)) {
+            droneLodIndex = selectModelLod(drone, model3D, droneLod, false);
         }
 
+        // Graf prolaza ovog frejma (render nit ga izvrsava tek posle predaje). Privremeni podaci frejma
+        // (kuke, callback-ovi, instance) idu u njegovu arenu umesto na heap.
+        FrameGraph& frameGraph = renderThread.recordGraph();
+        frameGraph.reset();
+        LinearArena& frameArena = frameGraph.frameArena();
+
+        // Na GPU putanji CPU samo predaje ciljne pozicije (odsecanje, LOD i impostor bira gpu_cull)
+        bool helicoptersOnGpu = gpuCulling && helicopterCuller.isReady();
+        ArenaArray<vec4> helicopterTargets;
+        if (helicoptersOnGpu) {
+            helicopterTargets.data = frameArena.allocateArray<vec4>(HELICOPTER_NUM);
+        }
+        mat4 helicopterModels[HELICOPTER_NUM];
+        int helicopterLodIndices[HELICOPTER_NUM];
+        for (int i = 0; i < HELICOPTER_NUM; ++i) {
+            helicopterLodIndices[i] = -1;
+            if (!helicopter.isLoaded()) {
+                continue;
+            }
+            if (helicoptersOnGpu) {
+                // Isto kao scale(0.01) * translate(pozicija): teme * 0.01 + pozicija * 0.01
+                helicopterTargets.data[helicopterTargets.count++] = vec4(vec3(helicopterPositions[i].x, helicopterPositions[i].y, helicopterPositions[i].z) * 0.01f, 0.01f);
+                continue;
+            }
+            mat4 modelH = mat4(1.0f);
+            modelH = scale(modelH, vec3(0.01));
+            modelH = translate(modelH, vec3(helicopterPositions[i].x, helicopterPositions[i].y, helicopterPositions[i].z));
+            helicopterModels[i] = modelH;
+            if (!isObjectVisible(viewFrustum, helicopter, modelH, objectCulling) || isObjectOccluded(occlusionCuller, helicopter, modelH, objectCulling)) {
+                continue;
+            }
+            helicopterLodIndices[i] = selectModelLod(helicopter, modelH, helicopterLods[i], helicopterImpostor.isBuilt());
+            if (helicopterLodIndices[i] < 0) {
+                helicopterImpostor.addInstance(modelH);
+            }
+        }
 
         // Proteklo vreme od pocetka programa
         auto currentTime = chrono::high_resolution_clock::now();
         float elapsedTime = chrono::duration_cast<chrono::milliseconds>(currentTime - startTime).count() / 1000.0f;
 
+        // Pomeranje reflektora u krug - - - - - - - - - - - - - - - - - - - - - - - - -
+        reflectorAngle += reflectorSpeed * elapsedTime;
+        float reflectorX = 0.1f * reflectorRadius * cos(reflectorAngle);
+        float reflectorZ = 0.1f * reflectorRadius * sin(reflectorAngle);
+
+        // Resursi i prolazi grafa ---------------------------------------------------------------------------
+        FrameGraph::Resource screen = frameGraph.importResource("ekran");
+        FrameGraph::Resource depth = frameGraph.importResource("dubina");
+        FrameGraph::Resource hiZ = frameGraph.importResource("hi-z");
+
+        // Zaklanjaci za Hi-Z odsecanje (rezultat stize frejm-dva kasnije)
+        FrameGraph::Pass& occluderPass = frameGraph.addPass("zaklanjaci", {}, { hiZ });
+        occluderPass.onBegin([&occlusionCuller, view, projection]() { return occlusionCuller.beginOccluders(view, projection); });
+        occluderPass.onEnd([&occlusionCuller]() { occlusionCuller.endOccluders(); });
+        if (!isMapHidden) {
+            DrawCommand terrainOccluder(depthProgram, terrainMesh, GL_TRIANGLES, 0, 0);
+            terrainOccluder.model = model;
+            terrainOccluder.frontFaceCW = true;
+            terrain.submit(occluderPass.commands, terrainOccluder);
+        }
+        if (!terrain.isLoaded() && mountain.isLoaded()) {
+            DrawCommand mountainOccluder(depthProgram, mountainMesh, GL_TRIANGLES, 0, mountain.vertexCount);
+            mountainOccluder.model = mountainModel;
+            mountainOccluder.cull = CULL_NONE;
+            occluderPass.commands.draw(mountainOccluder);
+        }
+
+        FrameGraph::Pass& clearPass = frameGraph.addPass("brisanje", {}, { screen, depth });
+        clearPass.commands.clear(vec4(0.1f, 0.1f, 0.10023082f, 1.0f), GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+        // GPU odsecanje helikoptera - liste koriste pre-pass i neprovidni prolaz
+        FrameGraph::Resource helicopterLists = frameGraph.createResource("liste helikoptera");
+        FrameGraph::Pass& gpuCullPass = frameGraph.addPass("gpu odsecanje", {}, { helicopterLists });
+        if (helicoptersOnGpu) {
+            bool useImpostor = helicopterImpostor.isBuilt();
+            float lodScale = projectionScale;
+            gpuCullPass.commands.callback([&helicopterCuller, viewFrustum, useImpostor, lodScale, helicopterTargets]() {
+                helicopterCuller.cull(helicopterTargets.data, helicopterTargets.count, viewFrustum, vec3(CAMERA_X_LOC, CAMERA_Y_LOC, CAMERA_Z_LOC), lodScale, useImpostor);
+            });
+        }
+
+        // Dubinski pre-pass ------------------------------------------------------------------------------------
+        FrameGraph::Pass& prepass = frameGraph.addPass("pre-pass", { depth, helicopterLists }, { depth });
+        prepass.onBegin([&depthPrepass, view, projection]() { return depthPrepass.begin(view, projection); });
+        prepass.onEnd([&depthPrepass]() { depthPrepass.end(); });
+        prepass.sortDraws = true;
+        if (prepassEnabled) {
+            CommandBuffer& depthCommands = prepass.commands;
+            if (!isMapHidden && terrain.isLoaded()) {
+                DrawCommand terrainDepth(depthProgram, terrainMesh, GL_TRIANGLES, 0, 0);
+                terrainDepth.model = model;
+                terrainDepth.frontFaceCW = true;
+                terrain.submit(depthCommands, terrainDepth);
+            }
+            else if (!isMapHidden) {
+                DrawCommand mapDepth(depthProgram, mapMesh, GL_TRIANGLE_STRIP, 0, 5);
+                mapDepth.model = model;
+                depthCommands.draw(mapDepth);
+            }
+            if (mountainVisible) {
+                DrawCommand mountainDepth(depthProgram, mountainMesh, GL_TRIANGLES, 0, mountain.vertexCount);
+                mountainDepth.model = mountainModel;
+                mountainDepth.cull = CULL_NONE;
+                depthCommands.draw(mountainDepth);
+            }
+            if (droneLodIndex >= 0) {
+                DrawCommand droneDepth(depthProgram, droneMesh, GL_TRIANGLES, drone.lods[droneLodIndex].first, drone.lods[droneLodIndex].count);
+                droneDepth.model = model3D;
+                depthCommands.draw(droneDepth);
+            }
+            for (int i = 0; i < HELICOPTER_NUM; ++i) {
+                if (helicopterLodIndices[i] >= 0) {
+                    const MeshLod& lod = helicopter.lods[helicopterLodIndices[i]];
+                    DrawCommand helicopterDepth(depthProgram, helicopterMesh, GL_TRIANGLES, lod.first, lod.count);
+                    helicopterDepth.model = helicopterModels[i];
+                    depthCommands.draw(helicopterDepth);
+                }
+            }
+            if (helicoptersOnGpu) {
+                depthCommands.callback([&helicopterCuller, &renderer, instancedDepthShader, helicopterMesh]() {
+                    glUseProgram(instancedDepthShader);
+                    helicopterCuller.drawMeshes(renderer.meshVertexBuffer(helicopterMesh));
+                });
+            }
+        }
+
+        // Neprovidni objekti (sa pre-pass-om se senci samo vidljiv fragment) ---------------------------------
+        FrameGraph::Pass& opaquePass = frameGraph.addPass("neprovidno", { depth, helicopterLists }, { screen, depth });
+        opaquePass.onBegin([&depthPrepass]() { depthPrepass.beginShading(); return true; });
+        opaquePass.onEnd([&depthPrepass]() { depthPrepass.endShading(); });
+        opaquePass.sortDraws = true;
+        CommandBuffer& opaque = opaquePass.commands;
+
+        opaque.setUniform(baseProgram, "uReflector.pos", vec3(reflectorX, -3.0f, reflectorZ));
+        opaque.setUniform(textureProgram, "useVirtualTexture", tileMap.isOpen());
+        if (tileMap.isOpen()) {
+            opaque.callback([&tileMap, textureShader]() { tileMap.bind(textureShader, 1, 2); });
+        }
+
+        DrawCommand mapDraw(textureProgram, mapMesh, GL_TRIANGLE_STRIP, 0, 5);
+        mapDraw.model = model;
+        mapDraw.texture = atlasHandle;
+        mapDraw.material = mapMaterial;
+        if (!isMapHidden && terrain.isLoaded())
+        {
+            // Ogledalna matrica modela okrece i redosled temena
+            mapDraw.mesh = terrainMesh;
+            mapDraw.frontFaceCW = true;
+            terrain.submit(opaque, mapDraw);
+        }
+        else if (!isMapHidden)
+        {
+            opaque.draw(mapDraw);
+        }
+
+        // Renderovanje preostalih dronova    0, 1, -1 ----------------------------------------------------------
+        mat4 dronLeftModel = mat4(1.0f);
+        dronLeftModel = translate(dronLeftModel, vec3(-0.95f, 0.96f, 0.4f));
+        dronLeftModel = rotate(dronLeftModel, 0.77f, vec3(1.0f, 0.0f, 0.0f));
+        dronLeftModel = scale(dronLeftModel, vec3(0.8f, 0.8f, 0.8f));
+        for (int i = 0; i < dronesLeft; ++i) {
+            DrawCommand dronLeftDraw(baseProgram, dronLeftMeshes[i], GL_TRIANGLE_FAN, 0, circleVertexCount);
+            dronLeftDraw.model = dronLeftModel;
+            dronLeftDraw.color = vec3(0.0f, 1.0f, 0.0f);
+            dronLeftDraw.cull = CULL_FRONT;
+            opaque.draw(dronLeftDraw);
+        }
+
+        // Renderovanje pozadine LED sijalice -------------------------------------------------------------------
+        DrawCommand circleDraw(baseProgram, ledBackgroundMesh, GL_TRIANGLE_FAN, 0, circleVertexCount);
+        circleDraw.model = model;
+        circleDraw.color = vec3(0.3f, 0.2f, 0.2f);
+        opaque.draw(circleDraw);
+
+        // Renderovanje LED sijalice -> upaljena ako postoji letelica u vazduhu
+        circleDraw.mesh = ledMesh;
+        if (coptersOnScreen) {
+            circleDraw.color = vec3(1.0f, 0.0f, 0.0f); // Crvena boja LED sijalice kada ima helikoptera
+        }
+        else {
+            circleDraw.color = vec3(0.0f, 1.0f, 0.0f); // Zelena boja LED sijalice kada nema helikoptera
+        }
+        opaque.draw(circleDraw);
+
+        // Renderovanje centra Novog Sada ------------------------------------------------------------------------
+        circleDraw.mesh = cityCenterMesh;
+        circleDraw.color = vec3(0.0f, 0.0f, 0.0f);
+        opaque.draw(circleDraw);
+
+
+        if (wasSpacePressed && dronesLeft > 0)
+        {
+            // Renderovanje 2D drona
+            mat4 modelKrug = translate(model, vec3(droneX, 0.1f, droneZ));
+            modelKrug = scale(modelKrug, vec3(droneCircleRadius));
+            DrawCommand droneCircleDraw(baseProgram, droneCircleMesh, GL_TRIANGLE_FAN, 0, circleVertexCount);
+            droneCircleDraw.model = modelKrug;
+            droneCircleDraw.color = vec3(0.0f, 0.0f, 1.0f);
+            opaque.draw(droneCircleDraw);
+
+            // Renderovanje 3D drona
+            if (droneLodIndex >= 0) {
+                DrawCommand droneDraw(baseProgram, droneMesh, GL_TRIANGLES, 0, 0);
+                droneDraw.model = model3D;
+                drawMeshAsset(opaque, droneDraw, drone, droneLodIndex);
+            }
+        }
+
 
         // Renderovanje niskoletnih meta -------------------------------------------------------------------------
         for (int i = 0; i < LOW_HELICOPTER_NUM; i++) {
-            //// Izraunamo vektor od helikoptera do centra
+            //// Izračunamo vektor od helikoptera do centra
             //float dirX = 0.42 - helicopterPositions[i].x;
             //float dirY = 0.08 - helicopterPositions[i].y;
 
-            //// Izraunamo razdaljinu od koptera do centra - Pitagora
+            //// Izračunamo razdaljinu od koptera do centra - Pitagora
             //float distance = sqrt(dirX * dirX + dirY * dirY);
 
             //// Normalizujemo vektor
@@ -627,7 +872,7 @@ int main(void)
             //// Prilagodimo brzinu pulsiranja na osnovu udaljenosti od centra - osnovna brzina je 5.0f
             //float pulseSpeed = 5.0f + 10.0f * (1.0f - distance);
 
-            //// Izraunamo faktor pulsiranja na osnovu vremena i udaljenosti
+            //// Izračunamo faktor pulsiranja na osnovu vremena i udaljenosti
             //float pulseFactor = 0.5f + 0.5f * sin(elapsedTime * pulseSpeed);
             //float redIntensity = 1.0;
             //float greenIntensity = 1.0 - pulseFactor;
@@ -637,17 +882,11 @@ int main(void)
             float greenIntensity = 0.3;
             float blueIntensity = 0.2001;
 
-            glUseProgram(dronShader);
-            glUniformMatrix4fv(modelLocDron, 1, GL_FALSE, value_ptr(model)); //(Adresa matrice, broj matrica koje saljemo, da li treba da se transponuju, pokazivac do matrica)
-            glUniformMatrix4fv(viewLocDron, 1, GL_FALSE, value_ptr(view));
-            glUniformMatrix4fv(projectionLocDron, 1, GL_FALSE, value_ptr(projection));
-            glBindVertexArray(VAOBlue);
-            GLint translationLoc = glGetUniformLocation(dronShader, "uTranslation");
-            glUniform2f(translationLoc, lowHelicopterPositions[i].x, lowHelicopterPositions[i].y);
-            colorLoc = glGetUniformLocation(dronShader, "color");
-            glUniform3f(colorLoc, redIntensity, greenIntensity, blueIntensity);
-            glDrawArrays(GL_TRIANGLE_FAN, 0, sizeof(blueCircle) / (3 * sizeof(float)));
-            glBindVertexArray(0);
+            DrawCommand lowHelicopterDraw(dronProgram, droneCircleMesh, GL_TRIANGLE_FAN, 0, circleVertexCount);
+            lowHelicopterDraw.model = model;
+            lowHelicopterDraw.translation = vec2(lowHelicopterPositions[i].x, lowHelicopterPositions[i].y);
+            lowHelicopterDraw.color = vec3(redIntensity, greenIntensity, blueIntensity);
+            opaque.draw(lowHelicopterDraw);
 
             if (checkCollision(droneX, droneZ, 0.03, lowHelicopterPositions[i].x, lowHelicopterPositions[i].y, 0.03)) {
                 droneX = 0.0f; // Resetovanje pozicije drona
@@ -667,171 +906,336 @@ int main(void)
         moveLowHelicoptersTowardsCityCenter(0.42, 0.08, helicopterSpeed / 3);
 
         // Renderovanje planine ------------------------------------------------------------------------------
-        renderMountain(baseShader, mountainVAO, mapTexture, model, modelLocBase, mountain);
-
-        // Renderovanje seta oblaka --------------------------------------------------------------------------
-        bool hasTexture2 = false;
-        renderClouds(baseShader, cloudVAO, hasTexture2, colorLoc, modelLocBase, cloud);
+        if (mountainVisible) {
+            renderMountain(opaque, baseProgram, mountainMesh, mountainModel, mountain, atlasHandle, mountainSurfaceMaterial);
+        }
 
         // Renderovanje helikoptera --------------------------------------------------------------------------
-        glUseProgram(baseShader);
-
         for (int i = 0; i < HELICOPTER_NUM; ++i) {
-            glBindVertexArray(helicopterVAO);
-
-            mat4 modelH = mat4(1.0f);
-            modelH = scale(modelH, vec3(0.01));
-            modelH = translate(modelH, vec3(helicopterPositions[i].x, helicopterPositions[i].y, helicopterPositions[i].z));
+            int lodIndex = helicopterLodIndices[i];
+            if (lodIndex < 0) {
+                continue; // Odsecen ili crtan kao impostor
+            }
+            DrawCommand helicopterDraw(baseProgram, helicopterMesh, GL_TRIANGLES, 0, 0);
+            helicopterDraw.model = helicopterModels[i];
+            drawMeshAsset(opaque, helicopterDraw, helicopter, lodIndex);
+        }
+        int helicopterImpostorCount = helicopterImpostor.instanceCount();
+        int helicopterMaterial = helicopter.lodMaterial;
+        opaque.callback([&helicopterImpostor, impostorShader, helicopterMaterial, instances = helicopterImpostor.takeInstances(frameArena)]() {
+            renderImpostors(impostorShader, helicopterImpostor, instances, helicopterMaterial, 0.0f);
+        });
+        if (helicoptersOnGpu) {
+            opaque.callback([&helicopterCuller, &helicopterImpostor, &renderer, instancedShader, impostorShader, helicopterMesh, helicopterMaterial]() {
+                renderGpuCulled(instancedShader, impostorShader, helicopterCuller, helicopterImpostor, renderer.meshVertexBuffer(helicopterMesh), helicopterMaterial);
+            });
+        }
 
-            glUniformMatrix4fv(modelLocBase, 1, GL_FALSE, value_ptr(modelH));
-            glUniform3f(colorLoc, 0.0, 1.0, 1.0);
-            glDrawArrays(GL_TRIANGLES, 0, helicopter.vertices.size());
+        // Providni objekti posle svih neprovidnih, bilo kojim redosledom ---------------------------------------
+        FrameGraph::Pass& translucentPass = frameGraph.addPass("providno", { depth }, { screen });
+        translucentPass.onBegin([&oitPass, baseShader, impostorShader]() {
+            oitPass.begin();
+            setOitOutput(baseShader, oitPass.isActive());
+            setOitOutput(impostorShader, oitPass.isActive());
+            return true;
+        });
+        translucentPass.onEnd([&oitPass, baseShader, impostorShader]() {
+            setOitOutput(baseShader, false);
+            setOitOutput(impostorShader, false);
+            oitPass.end();
+        });
+
+        // Renderovanje baze
+        renderBase(translucentPass.commands, baseProgram, baseMesh, base, viewFrustum, objectCulling);
+
+        // Renderovanje seta oblaka (samo bez sloja cestica)
+        int cloudImpostorCount = 0;
+        if (!useCloudLayer) {
+            renderClouds(translucentPass.commands, baseProgram, cloudMesh, cloud, viewFrustum, occlusionCuller, objectCulling, cloudLods, cloudImpostor);
+            cloudImpostorCount = cloudImpostor.instanceCount();
+            int cloudMaterial = cloud.lodMaterial;
+            translucentPass.commands.callback([&cloudImpostor, impostorShader, cloudMaterial, instances = cloudImpostor.takeInstances(frameArena)]() {
+                renderImpostors(impostorShader, cloudImpostor, instances, cloudMaterial, 0.5f);
+            });
+        }
+        profiler.setCounter("impostori", helicopterImpostorCount + cloudImpostorCount);
+
+        // Sloj oblaka ide posle svih neprovidnih objekata jer koristi njihovu dubinu
+        if (useCloudLayer) {
+            FrameGraph::Pass& cloudPass = frameGraph.addPass("sloj oblaka", { depth }, { screen });
+            cloudPass.commands.callback([&cloudLayer, view, projection]() {
+                cloudLayer.render(view, projection, vec3(CAMERA_X_LOC, CAMERA_Y_LOC, CAMERA_Z_LOC), 0.1f, 100.0f);
+            });
+        }
+        profiler.setCounter("cestice oblaka", useCloudLayer ? cloudParticles : 0);
 
-            glBindVertexArray(0);
+        // Toplotna mapa preklapanja neprovidnih objekata (preko svega osim imena)
+        if (overdrawView) {
+            FrameGraph::Pass& overdrawPass = frameGraph.addPass("preklapanje", {}, { screen });
+            overdrawPass.commands.callback([&depthPrepass]() { depthPrepass.drawOverdraw(); });
         }
 
         moveHelicoptersTowardsCityCenter(-0.38 * 100, 1.0, 0.08 * 100, helicopterSpeed * 100);
 
         // Renderovanje imena i prezimena ---------------------------------------------
-        glDisable(GL_DEPTH_TEST);
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        glUseProgram(nameSurnameShader);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, nameSurnameTexture);
-        glBindVertexArray(nameSurnameVAO);
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-        glBindVertexArray(0);
-        glBindTexture(GL_TEXTURE_2D, 0);
-        glUseProgram(baseShader);
-        glDisable(GL_BLEND);
-        glEnable(GL_DEPTH_TEST);
-
-        // Pomeranje reflektora u krug - - - - - - - - - - - - - - - - - - - - - - - - -
-        reflectorAngle += reflectorSpeed * elapsedTime;
-        float reflectorX = 0.1f * reflectorRadius * cos(reflectorAngle);
-        float reflectorZ = 0.1f * reflectorRadius * sin(reflectorAngle);
+        FrameGraph::Pass& nameSurnamePass = frameGraph.addPass("ime i prezime", {}, { screen });
+        nameSurnamePass.depthTest = false;
+        nameSurnamePass.blend = true;
+        DrawCommand nameSurnameDraw(nameSurnameProgram, nameSurnameMesh, GL_TRIANGLES, 0, 6);
+        nameSurnameDraw.texture = atlasHandle;
+        nameSurnamePass.commands.draw(nameSurnameDraw);
+
+        // GL posao izmedju frejmova - render nit ga radi u submit(), dok ova nit ceka, pa sme da menja stanje igre
+        renderThread.sync([&]() {
+            // Upload modela i tekstura koji su u medjuvremenu ucitani (ogranicen budzet da frejm ne bi zastao)
+            assetLoader.processUploads(4.0);
+            textureStreamer.update();
+            if (!cloudImpostor.isBuilt() && cloud.isLoaded()) {
+                cloudImpostor.build(impostorBakeShader, renderer.meshVAO(cloudMesh), renderer.meshFirstVertex(cloudMesh) + cloud.lods[0].first, cloud.lods[0].count, cloud.bounds);
+            }
+            if (!helicopterCuller.hasModel() && renderer.isMeshReady(helicopterMesh)) {
+                helicopterCuller.setModel(helicopter.bounds, helicopter.lods, renderer.meshFirstVertex(helicopterMesh));
+            }
+            if (!helicopterImpostor.isBuilt() && helicopter.isLoaded()) {
+                helicopterImpostor.build(impostorBakeShader, renderer.meshVAO(helicopterMesh), renderer.meshFirstVertex(helicopterMesh) + helicopter.lods[0].first, helicopter.lods[0].count, helicopter.bounds);
+            }
 
-        glUseProgram(baseShader);
-        glUniform3f(lightPosLoc, reflectorX, -3.0f, reflectorZ);
+            // Kamera u UV prostoru mape (model mape ogledalno okrece X osu, a T koordinata ide od +Z ka -Z)
+            tileMap.update(vec2((-CAMERA_X_LOC + 1.0f) * 0.5f, 1.0f - (CAMERA_Z_LOC + 1.0f) * 0.5f), (CAMERA_Y_LOC + 0.01f) * 0.5f);
+
+            // Hi-Z piramida za odsecanje u sledecem frejmu
+            occlusionCuller.update();
+
+            cloudLayer.setQuality(cloudQuality);
+            depthPrepass.setEnabled(prepassEnabled);
+            depthPrepass.setOverdrawView(overdrawView);
+
+            shadedFragments = depthPrepass.shadedFragments();
+            cloudParticles = cloudLayer.particleCount();
+            drawCalls = renderer.drawCalls();
+            submittedDraws = renderer.submittedDraws();
+            stateChanges = renderer.stateChanges();
+            gpuCulledVisible = helicopterCuller.visibleCount();
+            uploadArenaKb = (int)(assetLoader.uploadArena().highWater() / 1024);
+        });
+
+        // Snimanje frejma (simulacija, odsecanje, graf) u stabilnom stanju ne sme da ide na opsti heap.
+        // Stabilno je kad je sve ucitano, podesavanja se ne menjaju i nista u frejmu ne prelazi dosadasnji
+        // maksimum (tada nizovi i arena legitimno rastu) vec heapCheckWarmup frejmova.
+        if (HeapCheck::isEnabled()) {
+            int frameAllocations = (int)(HeapCheck::threadAllocations() - frameAllocationStart);
+            int settings = (isMapHidden ? 1 : 0) | (useCloudLayer ? 2 : 0) | ((int)cloudQuality << 2) | (prepassEnabled ? 16 : 0) |
+                (overdrawView ? 32 : 0) | (helicoptersOnGpu ? 64 : 0) | (wasSpacePressed ? 128 : 0) |
+                (helicopterImpostor.isBuilt() ? 256 : 0) | (cloudImpostor.isBuilt() ? 512 : 0) | (dronesLeft << 10);
+            int frameDraws = frameGraph.recordedDraws();
+            int frameInstances = helicopterImpostorCount + cloudImpostorCount;
+            bool grew = frameDraws > maxFrameDraws || frameInstances > maxFrameInstances || frameArena.used() > maxArenaUsed;
+            maxFrameDraws = std::max(maxFrameDraws, frameDraws);
+            maxFrameInstances = std::max(maxFrameInstances, frameInstances);
+            maxArenaUsed = std::max(maxArenaUsed, frameArena.used());
+            steadyFrames = (!assetLoader.isIdle() || settings != lastSettings || grew) ? 0 : steadyFrames + 1;
+            lastSettings = settings;
+            if (steadyFrames > heapCheckWarmup && frameAllocations > 0) {
+                cout << "HeapCheck: snimanje frejma je alociralo " << frameAllocations << " puta ("
+                     << HeapCheck::threadAllocatedBytes() << " B ukupno na ovoj niti)\n";
+                assert(frameAllocations == 0);
+            }
+            profiler.setCounter("heap alokacije", frameAllocations);
+        }
+        profiler.setCounter("arena frejma kB", (int)(frameArena.highWater() / 1024));
+        profiler.setCounter("arena ucitavanja kB", uploadArenaKb);
+
+        renderThread.submit();
+
+        profiler.setCounter("render nit us", (int)(renderThread.renderMilliseconds() * 1000.0));
+        profiler.setCounter("fragmenti", shadedFragments);
+        profiler.setCounter("pozivi crtanja", drawCalls);
+        profiler.setCounter("crtanja", submittedDraws);
+        profiler.setCounter("promene stanja", stateChanges);
+        if (gpuCulling && gpuCulledVisible >= 0) {
+            profiler.setCounter("gpu instance", gpuCulledVisible);
+        }
+        profiler.setCounter("objekti testirano", objectCulling.tested);
+        profiler.setCounter("vidljivo", objectCulling.visible);
+        profiler.setCounter("odseceno", objectCulling.culled);
+        profiler.setCounter("zaklonjeno", objectCulling.occluded);
+        profiler.setCounter("teren vidljivo", terrain.visibleChunks());
+        profiler.setCounter("teren odseceno", terrain.culledChunks());
+        meshRegistry.report(profiler);
 
-        glfwSwapBuffers(window);
         glfwPollEvents();
-    }
 
-    glDeleteTextures(1, &mapTexture);
-    glDeleteTextures(1, &nameSurnameTexture);
-    glDeleteBuffers(1, &nameSurnameVBO);
-    glDeleteVertexArrays(1, &nameSurnameVAO);
-    glDeleteBuffers(2, VBO);
-    glDeleteVertexArrays(2, VAO);
-    glDeleteBuffers(1, &VBOBlue);
-    glDeleteVertexArrays(1, &VAOBlue);
-    glDeleteBuffers(1, &VBOLED);
-    glDeleteVertexArrays(1, &VAOLED);
-    glDeleteBuffers(1, &VBOLEDBackground);
-    glDeleteVertexArrays(1, &VAOLEDBackground);
-    glDeleteBuffers(1, &mountainVBO);
-    glDeleteVertexArrays(1, &mountainVAO);
-    glDeleteBuffers(1, &droneVBO);
-    glDeleteVertexArrays(1, &droneVAO);
-    glDeleteBuffers(1, &cloudVBO);
-    glDeleteVertexArrays(1, &cloudVAO);
-    glDeleteBuffers(1, &baseVBO);
-    glDeleteVertexArrays(1, &baseVAO);
-    glDeleteBuffers(1, &helicopterVBO);
-    glDeleteVertexArrays(1, &helicopterVAO);
-
-    glDeleteProgram(textureShader);
-    glDeleteProgram(baseShader);
-
-    for (int i = 0; i < DRONES_LEFT; i++) {
-        glDeleteVertexArrays(1, &VAOdronLeft[i]);
-        glDeleteBuffers(1, &VBOdronLeft[i]);
+        if (profiler.endFrame()) {
+            glfwSetWindowTitle(window, (string(wTitle) + " | " + profiler.report()).c_str());
+        }
     }
 
+    // Kontekst se vraca ovoj niti za brisanje resursa
+    renderThread.stop();
+
+    textureStreamer.release();
+    tileMap.release();
+    terrain.release();
+    cloudImpostor.release();
+    cloudLayer.release();
+    oitPass.release();
+    depthPrepass.release();
+    occlusionCuller.release();
+    helicopterImpostor.release();
+    helicopterCuller.release();
+    renderer.release();     // mreze, teksture i programi
+
     glfwTerminate();
     return 0;
 }
 
 
-void renderBase(unsigned int baseShader, unsigned int baseVAO, int& colorLoc, unsigned int modelLocBase, ModelData& base)
+void renderBase(CommandBuffer& commands, ProgramHandle baseProgram, MeshHandle baseMesh, const MeshAsset& base, const Frustum& frustum, CullingStats& culling)
 {
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glUseProgram(baseShader);
-    glBindVertexArray(baseVAO);
+    if (!base.isLoaded()) {
+        return; // Model se jos ucitava
+    }
 
-    colorLoc = glGetUniformLocation(baseShader, "color");
-    glUniform3f(colorLoc, 0.0, 1.0, 0.0);
     mat4 modelB = mat4(1.0f);
     modelB = scale(modelB, vec3(1.0));
     modelB = translate(modelB, vec3(0.0, 0.0, -0.45));
-    glUniformMatrix4fv(modelLocBase, 1, GL_FALSE, value_ptr(modelB));
-    glDrawArrays(GL_TRIANGLES, 0, base.vertices.size());
-    glBindVertexArray(0);
-    glDisable(GL_BLEND);
+    if (!isObjectVisible(frustum, base, modelB, culling)) {
+        return;
+    }
+
+    // Blending postavlja OIT prolaz
+    DrawCommand baseDraw(baseProgram, baseMesh, GL_TRIANGLES, 0, 0);
+    baseDraw.model = modelB;
+    drawMeshAsset(commands, baseDraw, base, 0);
 }
 
-void renderMountain(unsigned int baseShader, unsigned int mountainVAO, unsigned int mapTexture, glm::mat4& model, unsigned int modelLocBase, ModelData& mountain)
+void renderMountain(CommandBuffer& commands, ProgramHandle baseProgram, MeshHandle mountainMesh, const glm::mat4& model, const MeshAsset& mountain, TextureHandle atlas, int material)
 {
-    glUseProgram(baseShader);
-    glBindVertexArray(mountainVAO);
-
-    // Uniforme teksture planine
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, mapTexture);
-    glUniform1i(glGetUniformLocation(baseShader, "uTex"), 0);
-
-    GLint colorLoc = glGetUniformLocation(baseShader, "color");
-    glUniform3f(colorLoc, 0.82, 0.67, 0.46);
-
-    model = scale(model, vec3(0.1));
-    model = translate(model, vec3(0.0, 0.0, -12.8));
-
-    bool hasTexture = false;
-    glUniform1i(glGetUniformLocation(baseShader, "useTexture"), hasTexture);
-    glUniformMatrix4fv(modelLocBase, 1, GL_FALSE, value_ptr(model));
-    glDisable(GL_CULL_FACE);
-    glDrawArrays(GL_TRIANGLES, 0, mountain.vertices.size());
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glBindVertexArray(0);
-    glEnable(GL_CULL_FACE);
+    // Planina nije zatvorena mreza, pa se vide obe strane. Ceo model je jedno crtanje sa materijalom povrsine
+    // (triplanarna tekstura i detalj iz atlasa u base.frag), umesto opsega iz .mtl fajla.
+    DrawCommand mountainDraw(baseProgram, mountainMesh, GL_TRIANGLES, 0, mountain.lods[0].count);
+    mountainDraw.model = model;
+    mountainDraw.cull = CULL_NONE;
+    mountainDraw.texture = atlas;
+    mountainDraw.material = material;
+    commands.draw(mountainDraw);
 }
 
-void renderClouds(unsigned int baseShader, unsigned int cloud1VAO, bool& hasTexture, int& colorLoc, unsigned int modelLocBase, ModelData& cloud1)
+void renderClouds(CommandBuffer& commands, ProgramHandle baseProgram, MeshHandle cloudMesh, const MeshAsset& cloud1, const Frustum& frustum, const OcclusionCuller& occlusion, CullingStats& culling, int cloudLods[2], Impostor& impostor)
 {
-    // Renderovanje 1. seta oblaka ------------------------------------------------------------------------------
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glUseProgram(baseShader);
-    glBindVertexArray(cloud1VAO);
-
-    glUniform1i(glGetUniformLocation(baseShader, "useTexture"), hasTexture);
-    colorLoc = glGetUniformLocation(baseShader, "color");
-    glUniform3f(colorLoc, 0.7, 0.7, 0.7);
-    GLuint alphaLoc = glGetUniformLocation(baseShader, "uAlpha");
-    glUniform1f(alphaLoc, 0.5);
+    if (!cloud1.isLoaded()) {
+        return; // Model se jos ucitava
+    }
+
+    // Renderovanje 1. seta oblaka (blending postavlja OIT prolaz) ---------------------------------------------
+    DrawCommand cloudDraw(baseProgram, cloudMesh, GL_TRIANGLES, 0, 0);
+    cloudDraw.alpha = 0.5f;
+    cloudDraw.cull = CULL_NONE;
+
     mat4 model1 = mat4(1.0f);
     model1 = scale(model1, vec3(0.1));
     model1 = translate(model1, vec3(-2.0, 6.0, 1.0));
-    glUniformMatrix4fv(modelLocBase, 1, GL_FALSE, value_ptr(model1));
-
-    glDisable(GL_CULL_FACE);
-    glDrawArrays(GL_TRIANGLES, 0, cloud1.vertices.size());
+    if (isObjectVisible(frustum, cloud1, model1, culling) && !isObjectOccluded(occlusion, cloud1, model1, culling)) {
+        int lodIndex = selectModelLod(cloud1, model1, cloudLods[0], impostor.isBuilt());
+        if (lodIndex < 0) {
+            impostor.addInstance(model1);
+        }
+        else {
+            cloudDraw.model = model1;
+            drawMeshAsset(commands, cloudDraw, cloud1, lodIndex);
+        }
+    }
 
     // Renderovanje 2. oblaka ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
-    glUniform1f(alphaLoc, 0.5);
     mat4 model3 = mat4(1.0f);
     model3 = scale(model3, vec3(0.1));
     model3 = translate(model3, vec3(6.0, 7.8, 10.0));
-    glUniformMatrix4fv(modelLocBase, 1, GL_FALSE, value_ptr(model3));
-    glDrawArrays(GL_TRIANGLES, 0, cloud1.vertices.size());
+    if (isObjectVisible(frustum, cloud1, model3, culling) && !isObjectOccluded(occlusion, cloud1, model3, culling)) {
+        int lodIndex = selectModelLod(cloud1, model3, cloudLods[1], impostor.isBuilt());
+        if (lodIndex < 0) {
+            impostor.addInstance(model3);
+        }
+        else {
+            cloudDraw.model = model3;
+            drawMeshAsset(commands, cloudDraw, cloud1, lodIndex);
+        }
+    }
+}
+
+// Objekat je vidljiv ako je u piramidi pogleda i blizi od DRAW_DISTANCE
+bool isObjectVisible(const Frustum& frustum, const MeshAsset& modelData, const glm::mat4& model, CullingStats& stats)
+{
+    stats.tested++;
+    Bounds worldBounds = transformBounds(modelData.bounds, model);
+    float distance = length(worldBounds.center - vec3(CAMERA_X_LOC, CAMERA_Y_LOC, CAMERA_Z_LOC)) - worldBounds.radius;
+    if (distance > DRAW_DISTANCE || !frustum.intersectsBounds(worldBounds)) {
+        stats.culled++;
+        return false;
+    }
+    stats.visible++;
+    return true;
+}
+
+// Objekat koji je prosao odsecanje piramidom pogleda, ali je potpuno iza terena/planine
+bool isObjectOccluded(const OcclusionCuller& occlusion, const MeshAsset& modelData, const glm::mat4& model, CullingStats& stats)
+{
+    if (!occlusion.isOccluded(transformBounds(modelData.bounds, model))) {
+        return false;
+    }
+    stats.visible--;
+    stats.occluded++;
+    return true;
+}
+
+// Nivo detalja po poluprecniku objekta na ekranu, -1 znaci da se crta impostor
+int selectModelLod(const MeshAsset& modelData, const glm::mat4& model, int& currentLod, bool hasImpostor)
+{
+    Bounds worldBounds = transformBounds(modelData.bounds, model);
+    float distance = std::max(length(worldBounds.center - vec3(CAMERA_X_LOC, CAMERA_Y_LOC, CAMERA_Z_LOC)), 0.0001f);
+    float screenRadius = worldBounds.radius * projectionScale / distance;
+    if (hasImpostor && selectImpostor(screenRadius, currentLod < 0)) {
+        currentLod = -1;
+        return currentLod;
+    }
+    int lodCount = (int)modelData.lods.size();
+    currentLod = selectLod(screenRadius, currentLod < 0 ? lodCount - 1 : currentLod, lodCount);
+    return currentLod;
+}
+
+void renderImpostors(unsigned int impostorShader, Impostor& impostor, const ArenaArray<vec4>& instances, int material, float alpha)
+{
+    if (instances.empty()) {
+        return;
+    }
+    glUseProgram(impostorShader);
+    glUniform3f(glGetUniformLocation(impostorShader, "color"), 1.0f, 1.0f, 1.0f);
+    glUniform1f(glGetUniformLocation(impostorShader, "uAlpha"), alpha);
+    glUniform1i(glGetUniformLocation(impostorShader, "uMaterialId"), material);
+    impostor.draw(impostorShader, instances.data, instances.count);
+}
 
-    glBindVertexArray(0);
-    glDisable(GL_BLEND);
-    glUniform1f(alphaLoc, 0.0);
-    glEnable(GL_CULL_FACE);
+// Helikopteri iz zbijenih lista GpuCuller-a: mreze po nivoima, pa daleke instance kao impostori
+void renderGpuCulled(unsigned int instancedShader, unsigned int impostorShader, GpuCuller& culler, Impostor& impostor, GLuint vertexBuffer, int material)
+{
+    // Instance crtaju cele nivoe, pa ceo model dobija jedan materijal
+    glUseProgram(instancedShader);
+    glUniform3f(glGetUniformLocation(instancedShader, "color"), 1.0f, 1.0f, 1.0f);
+    glUniform1f(glGetUniformLocation(instancedShader, "uAlpha"), 0.0f);
+    glUniform1i(glGetUniformLocation(instancedShader, "uMaterialId"), material);
+    culler.drawMeshes(vertexBuffer);
+
+    glUseProgram(impostorShader);
+    glUniform3f(glGetUniformLocation(impostorShader, "color"), 1.0f, 1.0f, 1.0f);
+    glUniform1f(glGetUniformLocation(impostorShader, "uAlpha"), 0.0f);
+    glUniform1i(glGetUniformLocation(impostorShader, "uMaterialId"), material);
+    culler.drawImpostors(impostorShader, impostor);
+}
+
+// Providni shaderi pisu u OIT ciljeve (akumulacija + propustljivost) umesto obicne boje
+void setOitOutput(unsigned int shader, bool enabled)
+{
+    glUseProgram(shader);
+    glUniform1i(glGetUniformLocation(shader, "uOit"), enabled);
 }
 
 bool checkCollision(float object1X, float object1Y, float object1Radius, float object2X, float object2Y, float object2Radius) {
@@ -882,6 +1286,12 @@ void moveHelicoptersTowardsCityCenter(float cityCenterX, float cityCenterY, floa
 }
 
 
+// Slucajan broj oblika 0.XY (dve slucajne cifre), bez pravljenja stringova
+static float randomFraction() {
+    int tenths = rand() % 10;
+    int hundredths = rand() % 10;
+    return (tenths * 10 + hundredths) / 100.0f;
+}
 void generateLowHelicopterPositions(int number) {
     srand(static_cast<unsigned>(time(nullptr)));
 
@@ -889,31 +1299,19 @@ void generateLowHelicopterPositions(int number) {
         int strana = rand() % 4;
         if (strana == 0) {                                    // Desna stranica
             lowHelicopterPositions[i].x = 1;
-            string randomFloat = "0.";
-            randomFloat.append(to_string(rand() % 10));
-            randomFloat.append(to_string(rand() % 10));
-            lowHelicopterPositions[i].y = stof(randomFloat);
+            lowHelicopterPositions[i].y = randomFraction();
         }
         else if (strana == 1) {                               // Gornja stranica
-            string randomFloat = "0.";
-            randomFloat.append(to_string(rand() % 10));
-            randomFloat.append(to_string(rand() % 10));
-            lowHelicopterPositions[i].x = stof(randomFloat);
+            lowHelicopterPositions[i].x = randomFraction();
             lowHelicopterPositions[i].y = 1;
         }
         //else if (strana == 2) {                               // Leva stranica
         else{
             lowHelicopterPositions[i].x = -1;
-            string randomFloat = "0.";
-            randomFloat.append(to_string(rand() % 10));
-            randomFloat.append(to_string(rand() % 10));
-            lowHelicopterPositions[i].y = stof(randomFloat);
+            lowHelicopterPositions[i].y = randomFraction();
         }
-        //else {
-        //    string randomFloat = "0.";                        // Donja stranica -> Ne moze nam dron doci sa nase planine
-        //    randomFloat.append(to_string(rand() % 10));
-        //    randomFloat.append(to_string(rand() % 10));
-        //    helicopterPositions[i].x = stof(randomFloat);
+        //else {                                              // Donja stranica -> Ne moze nam dron doci sa nase planine
+        //    helicopterPositions[i].x = randomFraction();
         //    helicopterPositions[i].y = -1;
         //}
     }
@@ -1082,114 +1480,141 @@ unsigned int createShader(const char* vsSource, const char* fsSource)
 
     return program;
 }
-static unsigned loadImageToTexture(const char* filePath) {
-    int TextureWidth;
-    int TextureHeight;
-    int TextureChannels;
-    unsigned char* ImageData = stbi_load(filePath, &TextureWidth, &TextureHeight, &TextureChannels, 0);
-    if (ImageData != NULL)
-    {
-        stbi__vertical_flip(ImageData, TextureWidth, TextureHeight, TextureChannels);
-
-        GLint InternalFormat = -1;
-        switch (TextureChannels) {
-        case 1: InternalFormat = GL_RED; break;
-        case 3: InternalFormat = GL_RGB; break;
-        case 4: InternalFormat = GL_RGBA; break;
-        default: InternalFormat = GL_RGB; break;
-        }
-
-        unsigned int Texture;
-        glGenTextures(1, &Texture);
-        glBindTexture(GL_TEXTURE_2D, Texture);
-        glTexImage2D(GL_TEXTURE_2D, 0, InternalFormat, TextureWidth, TextureHeight, 0, InternalFormat, GL_UNSIGNED_BYTE, ImageData);
-        glBindTexture(GL_TEXTURE_2D, 0);
-        stbi_image_free(ImageData);
-        return Texture;
+// Kao drawMeshAsset: jedan poziv po opsegu materijala iz .mtl fajla. Model bez materijala dobija podrazumevani
+// materijal obojen bojom fallbackColor, kao u MeshRegistry::loadAsync.
+void drawSoftwareModel(SoftwareRenderer& renderer, const ModelData& model, const vector<vec3>& positions, const vector<vec3>& normals, const mat4& transform, const vec3& fallbackColor, float opacity, bool cullBackFaces)
+{
+    if (model.materials.empty()) {
+        ModelMaterial fallback;
+        fallback.ambient = fallback.ambient * fallbackColor;
+        fallback.diffuse = 0.5f * fallbackColor;
+        fallback.specular = 0.7f * fallbackColor;
+        renderer.drawBase(positions.data(), normals.data(), 0, model.lods[0].count, transform, SoftwareRenderer::fromModelMaterial(fallback), vec3(1.0f), opacity, cullBackFaces);
+        return;
     }
-    else
-    {
-        cout << "Textura nije ucitana! Putanja texture: " << filePath << endl;
-        stbi_image_free(ImageData);
-        return 0;
+    if (model.submeshes.empty()) {
+        renderer.drawBase(positions.data(), normals.data(), 0, model.lods[0].count, transform, SoftwareRenderer::fromModelMaterial(model.materials[0]), vec3(1.0f), opacity, cullBackFaces);
+        return;
     }
-}
-ModelData loadModel(const char* filePath) {
-    ModelData modelData;
-
-    Assimp::Importer importer;
-    const aiScene* scene = importer.ReadFile(filePath, aiProcess_Triangulate | aiProcess_FlipUVs);
-
-    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
-        cerr << "Error loading model: " << importer.GetErrorString() << endl;
-        return modelData;
+    for (const SubMesh& submesh : model.submeshes) {
+        SoftwareRenderer::Material material = SoftwareRenderer::fromModelMaterial(model.materials[submesh.material]);
+        renderer.drawBase(positions.data(), normals.data(), submesh.first, submesh.count, transform, material, vec3(1.0f), opacity, cullBackFaces);
     }
+}
 
-    processNode(scene->mRootNode, scene, modelData);
+// Ista scena kao glavna petlja (mapa, planina, baza, helikopteri i oblaci), iscrtana SoftwareRenderer-om.
+// Reflektor stoji na pocetnom polozaju, da bi snimci razlicitih pokretanja bili uporedivi.
+bool runSoftwareRenderer(int frames, const char* outputPath)
+{
+    generateHelicopterPositions(HELICOPTER_NUM);
 
-    return modelData;
-}
-void processMesh(aiMesh* mesh, const aiScene* scene, ModelData& modelData) {
-    for (unsigned int i = 0; i < mesh->mNumVertices; ++i) {
-        vec3 vertex;
-        vertex.x = mesh->mVertices[i].x;
-        vertex.y = mesh->mVertices[i].y;
-        vertex.z = mesh->mVertices[i].z;
-        modelData.vertices.push_back(vertex);
-
-        if (mesh->HasTextureCoords(0)) {
-            vec2 texCoord;
-            texCoord.x = mesh->mTextureCoords[0][i].x;
-            texCoord.y = mesh->mTextureCoords[0][i].y;
-            modelData.textureCoords.push_back(texCoord);
-        }
+    ModelData mountain = loadModel("res/mountain/Mountain.obj");
+    ModelData base = loadModel("res/base/Base.obj");
+    ModelData helicopter = loadModel("res/helicopter/Helicopter.obj");
+    ModelData cloud = loadModel("res/clouds/Cloud.obj");
 
-        if (mesh->HasNormals()) {
-            vec3 normal;
-            normal.x = mesh->mNormals[i].x;
-            normal.y = mesh->mNormals[i].y;
-            normal.z = mesh->mNormals[i].z;
-            modelData.normals.push_back(normal);
-        }
-        else {
-            modelData.normals.push_back(vec3(0.0f, 0.0f, 0.0f));
-        }
+    // SoftwareRenderer cita pozicije i normale iz zasebnih nizova
+    vector<vec3> mountainPositions, mountainNormals, basePositions, baseNormals;
+    vector<vec3> helicopterPositionsModel, helicopterNormals, cloudPositions, cloudNormals;
+    splitPositionsAndNormals(mountain, mountainPositions, mountainNormals);
+    splitPositionsAndNormals(base, basePositions, baseNormals);
+    splitPositionsAndNormals(helicopter, helicopterPositionsModel, helicopterNormals);
+    splitPositionsAndNormals(cloud, cloudPositions, cloudNormals);
+
+    SoftwareTexture mapTexture;
+    int channels = 0;
+    unsigned char* pixels = stbi_load("res/novi-sad.png", &mapTexture.width, &mapTexture.height, &channels, 4);
+    if (pixels != NULL) {
+        mapTexture.rgba.assign(pixels, pixels + mapTexture.width * mapTexture.height * 4);
+        stbi_image_free(pixels);
     }
-}
-void processNode(aiNode* node, const aiScene* scene, ModelData& modelData) {
-    for (unsigned int i = 0; i < node->mNumMeshes; ++i) {
-        aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-        processMesh(mesh, scene, modelData);
+    else {
+        cout << "Softverski renderer: mapa nije ucitana, crta se bez nje\n";
     }
 
-    for (unsigned int i = 0; i < node->mNumChildren; ++i) {
-        processNode(node->mChildren[i], scene, modelData);
+    // Mapa je TRIANGLE_STRIP od 5 temena (vertices u main-u) - ovde razvijena u dva trougla, UV kao u texture.vert
+    vec3 mapPositions[6] = {
+        vec3(-1.0f, -0.01f, -1.0f), vec3(1.0f, -0.01f, -1.0f), vec3(-1.0f, -0.01f, 1.0f),
+        vec3(-1.0f, -0.01f, 1.0f), vec3(1.0f, -0.01f, -1.0f), vec3(1.0f, -0.01f, 1.0f)
+    };
+    vec3 mapNormals[6];
+    vec2 mapTextureCoords[6];
+    for (int i = 0; i < 6; ++i) {
+        mapNormals[i] = vec3(0.0f, 1.0f, 0.0f);
+        mapTextureCoords[i] = vec2((mapPositions[i].x + 1.0f) * 0.5f, 1.0f - (mapPositions[i].z + 1.0f) * 0.5f);
     }
-}
-void setupModelVAO(unsigned int& VAO, unsigned int& VBO, const ModelData& modelData) {
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
 
-    size_t bufferSize = modelData.vertices.size() * sizeof(vec3) + modelData.textureCoords.size() * sizeof(vec2) + modelData.normals.size() * sizeof(vec3);
-    vector<char> bufferData(bufferSize);
-
-    memcpy(bufferData.data(), modelData.vertices.data(), modelData.vertices.size() * sizeof(vec3));
-    memcpy(bufferData.data() + modelData.vertices.size() * sizeof(vec3), modelData.textureCoords.data(), modelData.textureCoords.size() * sizeof(vec2));
-    memcpy(bufferData.data() + modelData.vertices.size() * sizeof(vec3) + modelData.textureCoords.size() * sizeof(vec2), modelData.normals.data(), modelData.normals.size() * sizeof(vec3));
+    const int width = 900;
+    const int height = 900;
+    SoftwareRenderer renderer(width, height);
+    vec3 cameraPosition(CAMERA_X_LOC, CAMERA_Y_LOC, CAMERA_Z_LOC);
+    mat4 view = lookAt(cameraPosition, vec3(0.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f));
+    mat4 projection = perspective(radians(90.0f), (float)width / (float)height, 0.1f, 100.0f);
+    renderer.setCamera(view, projection, cameraPosition);
+
+    // Mapa ima podrazumevani materijal, kao mapSurface u igri; planina boju teksture zamenjuje bojom crtanja
+    renderer.setMaterial(SoftwareRenderer::fromModelMaterial(ModelMaterial()));
+    ModelMaterial mountainSurface;
+    mountainSurface.diffuse = vec3(0.8f);
+    mountainSurface.specular = vec3(0.0f);
+    SoftwareRenderer::Material mountainMaterial = SoftwareRenderer::fromModelMaterial(mountainSurface);
+    float reflectorAngle = 0.5f;
+    SoftwareRenderer::Light reflector = {
+        vec3(0.3f * cos(reflectorAngle), -3.0f, 0.3f * sin(reflectorAngle)), vec3(0.0f, 1.0f, 0.0f), cos(radians(1.0f)),
+        vec3(0.2f), vec3(4.0f), vec3(4.0f)
+    };
+    renderer.setReflector(reflector);
+
+    mat4 mapModel = mat4(1.0f);
+    mapModel[0] *= -1;
+    mat4 mountainModel = translate(scale(mapModel, vec3(0.1)), vec3(0.0, 0.0, -12.8));
+    mat4 baseModel = translate(mat4(1.0f), vec3(0.0, 0.0, -0.45));
+    mat4 cloudModels[2] = {
+        translate(scale(mat4(1.0f), vec3(0.1)), vec3(-2.0, 6.0, 1.0)),
+        translate(scale(mat4(1.0f), vec3(0.1)), vec3(6.0, 7.8, 10.0))
+    };
 
-    glBufferData(GL_ARRAY_BUFFER, bufferSize, bufferData.data(), GL_STATIC_DRAW);
+    double totalMs = 0.0, minMs = 1e9, maxMs = 0.0;
+    for (int frame = 0; frame < frames; ++frame) {
+        auto frameStart = chrono::high_resolution_clock::now();
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(vec3), (void*)0);
-    glEnableVertexAttribArray(0);
+        renderer.clear(vec3(0.1f, 0.1f, 0.10023082f));
+        renderer.drawTextured(mapPositions, mapNormals, mapTextureCoords, 0, 6, mapModel, &mapTexture, false);
+        if (mountain.isLoaded()) {
+            renderer.drawBase(mountainPositions.data(), mountainNormals.data(), 0, mountain.vertexCount, mountainModel, mountainMaterial, vec3(0.82f, 0.67f, 0.46f), 1.0f, false);
+        }
+        if (helicopter.isLoaded()) {
+            for (int i = 0; i < HELICOPTER_NUM; ++i) {
+                mat4 modelH = translate(scale(mat4(1.0f), vec3(0.01)), vec3(helicopterPositions[i].x, helicopterPositions[i].y, helicopterPositions[i].z));
+                drawSoftwareModel(renderer, helicopter, helicopterPositionsModel, helicopterNormals, modelH, vec3(0.0f, 1.0f, 1.0f), 1.0f, true);
+            }
+        }
+        if (base.isLoaded()) {
+            drawSoftwareModel(renderer, base, basePositions, baseNormals, baseModel, vec3(0.0f, 1.0f, 0.0f), 1.0f, true);
+        }
+        if (cloud.isLoaded()) {
+            for (int i = 0; i < 2; ++i) {
+                drawSoftwareModel(renderer, cloud, cloudPositions, cloudNormals, cloudModels[i], vec3(0.7f), 0.5f, false);
+            }
+        }
+        renderer.finish();
 
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(vec2), (void*)(modelData.vertices.size() * sizeof(vec3)));
-    glEnableVertexAttribArray(1);
+        double frameMs = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - frameStart).count();
+        totalMs += frameMs;
+        minMs = std::min(minMs, frameMs);
+        maxMs = std::max(maxMs, frameMs);
 
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(vec3), (void*)(modelData.vertices.size() * sizeof(vec3) + modelData.textureCoords.size() * sizeof(vec2)));
-    glEnableVertexAttribArray(2);
+        moveHelicoptersTowardsCityCenter(-0.38 * 100, 1.0, 0.08 * 100, helicopterSpeed * 100);
+    }
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    if (frames > 0) {
+        cout << "Softverski renderer (" << renderer.threads() << " niti, " << renderer.lastTriangleCount() << " trouglova): "
+             << frames << " frejmova, prosek " << totalMs / frames << " ms, min " << minMs << " ms, max " << maxMs << " ms\n";
+    }
+    if (!renderer.writePPM(outputPath)) {
+        cout << "Softverski renderer: greska pri upisu " << outputPath << "\n";
+        return false;
+    }
+    cout << "Softverski renderer: snimak sacuvan u " << outputPath << "\n";
+    return true;
 }
\ No newline at end of file
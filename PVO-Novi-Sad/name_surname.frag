@@ -3,12 +3,20 @@
 out vec4 FragColor;
 
 in vec2 TexCoord;
-uniform sampler2D uTexture;
+
+// Slika imena je u atlasu tekstura (TextureAtlas); sloj i pravougaonik su u materijalu uMaterialId
+uniform sampler2DArray uAtlas;
+uniform samplerBuffer uMaterials;
+uniform int uMaterialId;
 
 void main() {
 
+    // Isti raspored kao fetchMaterial u base.frag: kS + sloj je texel 2, pravougaonik texel 4
+    float layer = texelFetch(uMaterials, uMaterialId * 6 + 2).a;
+    vec4 rect = texelFetch(uMaterials, uMaterialId * 6 + 4);
+
     vec4 uColor = vec4(0.0, 0.0, 0.0, 0.4);
-    vec4 texColor = texture(uTexture, TexCoord);
+    vec4 texColor = texture(uAtlas, vec3(rect.xy + clamp(TexCoord, 0.0, 1.0) * rect.zw, layer));
     vec4 finalColor = (texColor.a > 0.0) ? texColor : uColor;
     FragColor = finalColor;
 }
@@ -0,0 +1,21 @@
+#version 330 core
+
+in vec2 chTex;
+
+out vec4 outCol;
+
+uniform sampler2D uAccum;
+uniform sampler2D uReveal;
+
+void main()
+{
+    vec4 reveal = texture(uReveal, chTex);
+    // Nijedan providni objekat ne pokriva piksel
+    if (reveal.a >= 0.9999) {
+        discard;
+    }
+
+    // Ponderisani prosek boja, pokrivenost je 1 - proizvod(1 - alfa)
+    vec3 accum = texture(uAccum, chTex).rgb;
+    outCol = vec4(accum / max(reveal.r, 0.00001), 1.0 - reveal.a);
+}
\ No newline at end of file
@@ -7,33 +7,105 @@ struct Material {
     vec3 kA;
     vec3 kD;
     vec3 kS;
+    vec3 kE;
     float shine;
+    float opacity;
+    float textureLayer;    // sloj u TextureAtlas-u, -1 bez teksture
+    vec4 textureRect;      // (u0, v0, sirina, visina) slike u sloju
+    float textureScale;    // 0: UV mreze, > 0: triplanarno u prostoru sveta
+    float detailScale;
+    float detailStrength;
+    float detailDistance;
 };
 
 in vec3 chFragPos;
 in vec3 chNor;
 
-uniform sampler2D uTex;
-uniform Material uMaterial;
+flat in int chMaterial;
+
+// Tabela materijala (MaterialTable u Renderer-u): 6 texela po materijalu - kA + shine, kD + d, kS + sloj, kE, pravougaonik, povrsina
+uniform samplerBuffer uMaterials;
+
+Material fetchMaterial(int id)
+{
+    int base = id * 6;
+    vec4 ambientShine = texelFetch(uMaterials, base);
+    vec4 diffuseOpacity = texelFetch(uMaterials, base + 1);
+    Material material;
+    material.kA = ambientShine.rgb;
+    material.shine = ambientShine.a;
+    material.kD = diffuseOpacity.rgb;
+    material.opacity = diffuseOpacity.a;
+    vec4 specularLayer = texelFetch(uMaterials, base + 2);
+    material.kS = specularLayer.rgb;
+    material.textureLayer = specularLayer.a;
+    material.kE = texelFetch(uMaterials, base + 3).rgb;
+    material.textureRect = texelFetch(uMaterials, base + 4);
+    vec4 surface = texelFetch(uMaterials, base + 5);
+    material.textureScale = surface.x;
+    material.detailScale = surface.y;
+    material.detailStrength = surface.z;
+    material.detailDistance = surface.w;
+    return material;
+}
+
+// Atlas tekstura scene (TextureAtlas) na jedinici 0: slika se bira po sloju i pravougaoniku materijala
+uniform sampler2DArray uAtlas;
+
+vec4 sampleAtlas(Material material, vec2 uv)
+{
+    // Ponavljanje unutar pravougaonika; izvodi su od neprekidnih koordinata, pa fract() ne menja izbor mipmape
+    vec2 atlasUV = material.textureRect.xy + fract(uv) * material.textureRect.zw;
+    vec2 gradX = dFdx(uv) * material.textureRect.zw;
+    vec2 gradY = dFdy(uv) * material.textureRect.zw;
+    vec4 color = textureGrad(uAtlas, vec3(atlasUV, material.textureLayer), gradX, gradY);
+    return material.textureLayer < 0.0 ? vec4(1.0) : color;
+}
+
 uniform vec3 uViewPos;
 
+// Virtuelna tekstura mape (TileMap): kes plocica + tabela indirekcije po nivoima
+uniform bool useVirtualTexture;
+uniform sampler2DArray uTileCache;
+uniform usampler2D uTileTable;
+uniform int uTileLevels;
+uniform float uVirtualSize;
+
+vec4 sampleVirtualTexture(vec2 uv, float lod)
+{
+    uv = clamp(uv, vec2(0.0), vec2(0.99999));
+    int level = clamp(int(lod), 0, uTileLevels - 1);
+    int pages = 1 << (uTileLevels - 1 - level);
+
+    // x = sloj u kesu, y = nivo plocice koja je stvarno ucitana (trazena ili njen predak)
+    uvec2 entry = texelFetch(uTileTable, ivec2(uv * float(pages)), level).rg;
+    float residentPages = float(1 << (uTileLevels - 1 - int(entry.y)));
+    return texture(uTileCache, vec3(fract(uv * residentPages), float(entry.x)));
+}
+
 void main()
 {
-    vec4 texColor = texture(uTex, chTex)* vec4(1.0);
+    Material material = fetchMaterial(chMaterial);
+    // Nivo detalja se racuna van grananja (izvodi moraju biti u uniformnom toku)
+    vec2 virtualTexel = chTex * uVirtualSize;
+    float lod = log2(max(length(dFdx(virtualTexel)), length(dFdy(virtualTexel))));
+
+    vec4 atlasColor = sampleAtlas(material, chTex);
+    vec4 texColor = useVirtualTexture ? sampleVirtualTexture(chTex, lod) : atlasColor;
 
-    vec3 resA = vec3(0.1);
+    vec3 resA = vec3(0.1) * material.kA;
 
     vec3 normal = normalize(chNor);
     
     vec3 lightDirection = normalize(vec3(0.0, 1.2, 0.0)); // Mesecina
     
     float nD = max(dot(normal, lightDirection), 0.0);
-    vec3 resD = vec3(0.5) * (nD * uMaterial.kD);
+    vec3 resD = vec3(0.5) * (nD * material.kD);
 
     vec3 viewDirection = normalize(uViewPos - chFragPos);
     vec3 reflectionDirection = reflect(-lightDirection, normal);
-    float s = pow(max(dot(viewDirection, reflectionDirection), 0.0), uMaterial.shine);
-    vec3 resS = vec3(0.2) * (s * uMaterial.kS);
+    float s = pow(max(dot(viewDirection, reflectionDirection), 0.0), material.shine);
+    vec3 resS = vec3(0.2) * (s * material.kS);
 
     vec3 finalColor = resA + resD + resS;
 